@@ -6,6 +6,7 @@
 #include "anari/anari_cpp/Traits.h"
 #include "anari/backend/DeviceImpl.h"
 #include "anari/backend/LibraryImpl.h"
+#include "anari/ext/anari_batch.h"
 #include "anari/ext/anari_ext_interface.h"
 // std
 #include <cstdlib>
@@ -554,6 +555,101 @@ ANARIObject anariNewObject(
 }
 ANARI_CATCH_END(nullptr)
 
+extern "C" void anariNewObjects(ANARIDevice d,
+    ANARIDataType objectType,
+    const char *subtype,
+    uint64_t count,
+    ANARIObject *objects) ANARI_CATCH_BEGIN
+{
+  auto &device = deviceRef(d);
+
+  auto native = (ANARINewObjectsProc)device.getProcAddress("anariNewObjects");
+  if (native) {
+    native(d, objectType, subtype, count, objects);
+    return;
+  }
+
+  auto newOne = [&]() -> ANARIObject {
+    switch (objectType) {
+    case ANARI_CAMERA:
+      return device.newCamera(subtype);
+    case ANARI_FRAME:
+      return device.newFrame();
+    case ANARI_GEOMETRY:
+      return device.newGeometry(subtype);
+    case ANARI_GROUP:
+      return device.newGroup();
+    case ANARI_INSTANCE:
+      return device.newInstance(subtype);
+    case ANARI_LIGHT:
+      return device.newLight(subtype);
+    case ANARI_MATERIAL:
+      return device.newMaterial(subtype);
+    case ANARI_RENDERER:
+      return device.newRenderer(subtype);
+    case ANARI_SAMPLER:
+      return device.newSampler(subtype);
+    case ANARI_SPATIAL_FIELD:
+      return device.newSpatialField(subtype);
+    case ANARI_SURFACE:
+      return device.newSurface();
+    case ANARI_VOLUME:
+      return device.newVolume(subtype);
+    case ANARI_WORLD:
+      return device.newWorld();
+    default:
+      return nullptr;
+    }
+  };
+
+  for (uint64_t i = 0; i < count; i++)
+    objects[i] = newOne();
+}
+ANARI_CATCH_END_NORETURN()
+
+extern "C" void anariSetParameterBatch(ANARIDevice d,
+    const ANARIObject *objects,
+    uint64_t count,
+    const char *name,
+    ANARIDataType type,
+    const void *mem,
+    uint64_t byteStride) ANARI_CATCH_BEGIN
+{
+  auto &device = deviceRef(d);
+
+  auto native = (ANARISetParameterBatchProc)device.getProcAddress(
+      "anariSetParameterBatch");
+  if (native) {
+    native(d, objects, count, name, type, mem, byteStride);
+    return;
+  }
+
+  for (uint64_t i = 0; i < count; i++) {
+    const void *value = (const uint8_t *)mem + i * byteStride;
+    if (type == ANARI_STRING)
+      value = *(const char *const *)value;
+    device.setParameter(objects[i], name, type, value);
+  }
+}
+ANARI_CATCH_END_NORETURN()
+
+extern "C" void anariCommitParametersBatch(
+    ANARIDevice d, const ANARIObject *objects, uint64_t count) ANARI_CATCH_BEGIN
+{
+  auto &device = deviceRef(d);
+
+  auto native = (ANARICommitParametersBatchProc)device.getProcAddress(
+      "anariCommitParametersBatch");
+  if (native) {
+    native(d, objects, count);
+    return;
+  }
+
+  for (uint64_t i = 0; i < count; i++)
+    device.commitParameters(objects[i]);
+}
+ANARI_CATCH_END_NORETURN()
+
 extern "C" void (*anariDeviceGetProcAddress(ANARIDevice d, const char *name))(
     void)
 {
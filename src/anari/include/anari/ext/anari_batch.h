@@ -0,0 +1,67 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <anari/anari.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Batched object creation and parameter setting. These are always available
+// from the frontend: devices which do not implement them natively get the
+// equivalent sequence of single object calls.
+//
+// Devices with native support list the feature "ANARI_EXT_BATCH" in their
+// "extension" device property and return the functions below from
+// anariDeviceGetProcAddress(), under the same names and with the signatures of
+// the ANARI...Proc types. The frontend forwards to them if present.
+
+#define ANARI_EXT_BATCH_FEATURE "ANARI_EXT_BATCH"
+
+// Create 'count' objects of 'objectType' (any core object handle type other
+// than arrays) and 'subtype' (ignored for types without subtypes), writing
+// their handles to 'objects'
+ANARI_INTERFACE void anariNewObjects(ANARIDevice device,
+    ANARIDataType objectType,
+    const char *subtype,
+    uint64_t count,
+    ANARIObject *objects);
+
+// Set the parameter 'name' on each of 'objects', where the value for
+// objects[i] is read from 'mem + i * byteStride' the same way
+// anariSetParameter() reads 'mem'. A byteStride of 0 sets the same value on
+// every object. For ANARI_STRING each element is a 'const char *'.
+ANARI_INTERFACE void anariSetParameterBatch(ANARIDevice device,
+    const ANARIObject *objects,
+    uint64_t count,
+    const char *name,
+    ANARIDataType dataType,
+    const void *mem,
+    uint64_t byteStride);
+
+// Commit the parameters of each of 'objects'
+ANARI_INTERFACE void anariCommitParametersBatch(
+    ANARIDevice device, const ANARIObject *objects, uint64_t count);
+
+typedef void (*ANARINewObjectsProc)(ANARIDevice device,
+    ANARIDataType objectType,
+    const char *subtype,
+    uint64_t count,
+    ANARIObject *objects);
+
+typedef void (*ANARISetParameterBatchProc)(ANARIDevice device,
+    const ANARIObject *objects,
+    uint64_t count,
+    const char *name,
+    ANARIDataType dataType,
+    const void *mem,
+    uint64_t byteStride);
+
+typedef void (*ANARICommitParametersBatchProc)(
+    ANARIDevice device, const ANARIObject *objects, uint64_t count);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
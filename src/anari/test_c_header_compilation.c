@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "anari/anari.h"
+#include "anari/ext/anari_batch.h"
 #include "anari/frontend/anari_enums.h"
 #include "anari/frontend/anari_extension_utility.h"
 #include "anari/frontend/type_utility.h"
@@ -11,11 +11,18 @@
 #include "spatial_field/SpatialField.h"
 // std
 #include <limits>
+#include <thread>
 
 #include "anari_library_helide_queries.h"
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom allowInvalidMaterials("allowInvalidMaterials");
+static const helium::StringAtom invalidMaterialColor("invalidMaterialColor");
+static const helium::StringAtom privatizeSharedArrays("privatizeSharedArrays");
+} // namespace param
+
 // Data Arrays ////////////////////////////////////////////////////////////////
 
 void *HelideDevice::mapArray(ANARIArray a)
@@ -48,9 +55,9 @@ ANARIArray1D HelideDevice::newArray1D(const void *appMemory,
   md.numItems = numItems;
 
   if (anari::isObject(type))
-    return (ANARIArray1D) new ObjectArray(deviceState(), md);
+    return (ANARIArray1D) new (deviceState()) ObjectArray(deviceState(), md);
   else
-    return (ANARIArray1D) new Array1D(deviceState(), md);
+    return (ANARIArray1D) new (deviceState()) Array1D(deviceState(), md);
 }
 
 ANARIArray2D HelideDevice::newArray2D(const void *appMemory,
@@ -70,7 +77,7 @@ ANARIArray2D HelideDevice::newArray2D(const void *appMemory,
   md.numItems1 = numItems1;
   md.numItems2 = numItems2;
 
-  return (ANARIArray2D) new Array2D(deviceState(), md);
+  return (ANARIArray2D) new (deviceState()) Array2D(deviceState(), md);
 }
 
 ANARIArray3D HelideDevice::newArray3D(const void *appMemory,
@@ -92,7 +99,7 @@ ANARIArray3D HelideDevice::newArray3D(const void *appMemory,
   md.numItems2 = numItems2;
   md.numItems3 = numItems3;
 
-  return (ANARIArray3D) new Array3D(deviceState(), md);
+  return (ANARIArray3D) new (deviceState()) Array3D(deviceState(), md);
 }
 
 ANARICamera HelideDevice::newCamera(const char *subtype)
@@ -104,7 +111,7 @@ ANARICamera HelideDevice::newCamera(const char *subtype)
 ANARIFrame HelideDevice::newFrame()
 {
   initDevice();
-  return (ANARIFrame) new Frame(deviceState());
+  return (ANARIFrame) new (deviceState()) Frame(deviceState());
 }
 
 ANARIGeometry HelideDevice::newGeometry(const char *subtype)
@@ -116,13 +123,13 @@ ANARIGeometry HelideDevice::newGeometry(const char *subtype)
 ANARIGroup HelideDevice::newGroup()
 {
   initDevice();
-  return (ANARIGroup) new Group(deviceState());
+  return (ANARIGroup) new (deviceState()) Group(deviceState());
 }
 
 ANARIInstance HelideDevice::newInstance(const char * /*subtype*/)
 {
   initDevice();
-  return (ANARIInstance) new Instance(deviceState());
+  return (ANARIInstance) new (deviceState()) Instance(deviceState());
 }
 
 ANARILight HelideDevice::newLight(const char *subtype)
@@ -159,7 +166,7 @@ ANARISpatialField HelideDevice::newSpatialField(const char *subtype)
 ANARISurface HelideDevice::newSurface()
 {
   initDevice();
-  return (ANARISurface) new Surface(deviceState());
+  return (ANARISurface) new (deviceState()) Surface(deviceState());
 }
 
 ANARIVolume HelideDevice::newVolume(const char *subtype)
@@ -171,7 +178,7 @@ ANARIVolume HelideDevice::newVolume(const char *subtype)
 ANARIWorld HelideDevice::newWorld()
 {
   initDevice();
-  return (ANARIWorld) new World(deviceState());
+  return (ANARIWorld) new (deviceState()) World(deviceState());
 }
 
 // Query functions ////////////////////////////////////////////////////////////
@@ -265,6 +272,21 @@ void HelideDevice::initDevice()
       },
       this);
 
+  // helide objects only write their own state in finalize(), and only read
+  // objects of a lower commit priority (e.g. geometries read their arrays,
+  // which are finalized in an earlier level), so objects of the same commit
+  // priority can be finalized concurrently
+  state.commitBuffer.setNumFinalizationThreads(
+      numThreads > 0 ? numThreads : std::thread::hardware_concurrency());
+
+  // helide objects only read their parameters in commitParameters(), so
+  // parameter writes can be staged until the next flush
+  state.commitBuffer.setParameterStaging(true);
+
+  // Objects are only created after the device is initialized, so they can all
+  // come from the object arena
+  state.objectArena = std::make_unique<helium::ObjectArena>();
+
   m_initialized = true;
 }
 
@@ -275,9 +297,13 @@ void HelideDevice::deviceCommitParameters()
   bool allowInvalidSurfaceMaterials = state.allowInvalidSurfaceMaterials;
 
   state.allowInvalidSurfaceMaterials =
-      getParam<bool>("allowInvalidMaterials", true);
+      getParam<bool>(param::allowInvalidMaterials, true);
   state.invalidMaterialColor =
-      getParam<float4>("invalidMaterialColor", float4(1.f, 0.f, 1.f, 1.f));
+      getParam<float4>(param::invalidMaterialColor, float4(1.f, 0.f, 1.f, 1.f));
+  state.sharedArrayPrivatization =
+      getParam<bool>(param::privatizeSharedArrays, true)
+      ? helium::SharedArrayPrivatization::COPY_ON_RELEASE
+      : helium::SharedArrayPrivatization::NEVER;
 
   if (allowInvalidSurfaceMaterials != state.allowInvalidSurfaceMaterials)
     state.objectUpdates.lastBLSReconstructSceneRequest = helium::newTimeStamp();
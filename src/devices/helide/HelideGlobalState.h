@@ -18,11 +18,12 @@ struct HelideGlobalState : public helium::BaseGlobalDeviceState
 {
   int numThreads{1};
 
+  // Changes to individual objects are passed up to the groups and worlds
+  // containing them as dirty flags (see DirtyFlags in Object.h), these are
+  // only for device-wide changes which affect every scene
   struct ObjectUpdates
   {
     helium::TimeStamp lastBLSReconstructSceneRequest{0};
-    helium::TimeStamp lastBLSCommitSceneRequest{0};
-    helium::TimeStamp lastTLSReconstructSceneRequest{0};
   } objectUpdates;
 
   RenderingSemaphore renderingSemaphore;
@@ -13,6 +13,19 @@
 
 namespace helide {
 
+// What about an object changed, raised with helium::BaseObject::markDirty() and
+// passed from geometries and surfaces up through groups and instances to the
+// worlds containing them
+enum DirtyFlags : uint32_t
+{
+  // A group's embree scene must be rebuilt from its surfaces
+  DIRTY_BLS_RECONSTRUCT = (1 << 0),
+  // A group's embree scene must be committed again
+  DIRTY_BLS_COMMIT = (1 << 1),
+  // An instance's embree geometry must be updated in the world's scene
+  DIRTY_TLS = (1 << 2)
+};
+
 struct Object : public helium::BaseObject
 {
   Object(ANARIDataType type, HelideGlobalState *s);
@@ -8,25 +8,32 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom direction("direction");
+static const helium::StringAtom imageRegion("imageRegion");
+static const helium::StringAtom position("position");
+static const helium::StringAtom up("up");
+} // namespace param
+
 Camera::Camera(HelideGlobalState *s) : Object(ANARI_CAMERA, s) {}
 
 Camera *Camera::createInstance(std::string_view type, HelideGlobalState *s)
 {
   if (type == "perspective")
-    return new Perspective(s);
+    return new (s) Perspective(s);
   else if (type == "orthographic")
-    return new Orthographic(s);
+    return new (s) Orthographic(s);
   else
-    return (Camera *)new UnknownObject(ANARI_CAMERA, s);
+    return (Camera *)new (s) UnknownObject(ANARI_CAMERA, s);
 }
 
 void Camera::commitParameters()
 {
-  m_pos = getParam<float3>("position", float3(0.f));
-  m_dir = normalize(getParam<float3>("direction", float3(0.f, 0.f, 1.f)));
-  m_up = normalize(getParam<float3>("up", float3(0.f, 1.f, 0.f)));
+  m_pos = getParam<float3>(param::position, float3(0.f));
+  m_dir = normalize(getParam<float3>(param::direction, float3(0.f, 0.f, 1.f)));
+  m_up = normalize(getParam<float3>(param::up, float3(0.f, 1.f, 0.f)));
   m_imageRegion = float4(0.f, 0.f, 1.f, 1.f);
-  getParam("imageRegion", ANARI_FLOAT32_BOX2, &m_imageRegion);
+  getParam(param::imageRegion, ANARI_FLOAT32_BOX2, &m_imageRegion);
 }
 
 } // namespace helide
@@ -5,13 +5,18 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom aspect("aspect");
+static const helium::StringAtom height("height");
+} // namespace param
+
 Orthographic::Orthographic(HelideGlobalState *s) : Camera(s) {}
 
 void Orthographic::commitParameters()
 {
   Camera::commitParameters();
-  m_aspect = getParam<float>("aspect", 1.f);
-  m_height = getParam<float>("height", 1.f);
+  m_aspect = getParam<float>(param::aspect, 1.f);
+  m_height = getParam<float>(param::height, 1.f);
 }
 
 void Orthographic::finalize()
@@ -5,15 +5,20 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom aspect("aspect");
+static const helium::StringAtom fovy("fovy");
+} // namespace param
+
 Perspective::Perspective(HelideGlobalState *s) : Camera(s) {}
 
 void Perspective::commitParameters()
 {
   Camera::commitParameters();
   // NOTE: demonstrate alternative 'raw' method for getting parameter values
-  if (!getParam("fovy", ANARI_FLOAT32, &m_fovy))
+  if (!getParam(param::fovy, ANARI_FLOAT32, &m_fovy))
     m_fovy = anari::radians(60.f);
-  m_aspect = getParam<float>("aspect", 1.f);
+  m_aspect = getParam<float>(param::aspect, 1.f);
 }
 
 void Perspective::finalize()
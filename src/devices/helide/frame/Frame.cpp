@@ -11,6 +11,22 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom camera("camera");
+static const helium::StringAtom channelColor("channel.color");
+static const helium::StringAtom channelDepth("channel.depth");
+static const helium::StringAtom channelInstanceId("channel.instanceId");
+static const helium::StringAtom channelObjectId("channel.objectId");
+static const helium::StringAtom channelPrimitiveId("channel.primitiveId");
+static const helium::StringAtom frameCompletionCallback(
+    "frameCompletionCallback");
+static const helium::StringAtom frameCompletionCallbackUserData(
+    "frameCompletionCallbackUserData");
+static const helium::StringAtom renderer("renderer");
+static const helium::StringAtom size("size");
+static const helium::StringAtom world("world");
+} // namespace param
+
 // Helper functions ///////////////////////////////////////////////////////////
 
 template <typename I, typename FUNC>
@@ -61,21 +77,23 @@ HelideGlobalState *Frame::deviceState() const
 
 void Frame::commitParameters()
 {
-  m_renderer = getParamObject<Renderer>("renderer");
-  m_camera = getParamObject<Camera>("camera");
-  m_world = getParamObject<World>("world");
+  m_renderer = getParamObject<Renderer>(param::renderer);
+  m_camera = getParamObject<Camera>(param::camera);
+  m_world = getParamObject<World>(param::world);
 
-  m_colorType = getParam<anari::DataType>("channel.color", ANARI_UNKNOWN);
-  m_depthType = getParam<anari::DataType>("channel.depth", ANARI_UNKNOWN);
+  m_colorType = getParam<anari::DataType>(param::channelColor, ANARI_UNKNOWN);
+  m_depthType = getParam<anari::DataType>(param::channelDepth, ANARI_UNKNOWN);
   m_primIdType =
-      getParam<anari::DataType>("channel.primitiveId", ANARI_UNKNOWN);
-  m_objIdType = getParam<anari::DataType>("channel.objectId", ANARI_UNKNOWN);
-  m_instIdType = getParam<anari::DataType>("channel.instanceId", ANARI_UNKNOWN);
-  m_frameData.size = getParam<uint2>("size", uint2(10));
+      getParam<anari::DataType>(param::channelPrimitiveId, ANARI_UNKNOWN);
+  m_objIdType =
+      getParam<anari::DataType>(param::channelObjectId, ANARI_UNKNOWN);
+  m_instIdType =
+      getParam<anari::DataType>(param::channelInstanceId, ANARI_UNKNOWN);
+  m_frameData.size = getParam<uint2>(param::size, uint2(10));
   m_callback = getParam<ANARIFrameCompletionCallback>(
-      "frameCompletionCallback", nullptr);
+      param::frameCompletionCallback, nullptr);
   m_callbackUserPtr =
-      getParam<void *>("frameCompletionCallbackUserData", nullptr);
+      getParam<void *>(param::frameCompletionCallbackUserData, nullptr);
 }
 
 void Frame::finalize()
@@ -152,12 +170,24 @@ void Frame::renderFrame()
       return;
     }
 
-    if (state->commitBuffer.lastObjectFinalization() <= m_frameLastRendered) {
+    // Keep refining progressive renderers while nothing changes, up to the
+    // number of frames they amortize their samples over
+    const bool sceneChanged =
+        state->commitBuffer.lastObjectFinalization() > m_frameLastRendered;
+    const int accumulationFrames = int(m_renderer->accumulationFrames());
+    if (!sceneChanged && m_frameData.frameID + 1 >= accumulationFrames) {
       state->renderingSemaphore.frameEnd();
       return;
     }
 
     m_frameLastRendered = helium::newTimeStamp();
+    m_frameData.frameID = sceneChanged ? 0 : m_frameData.frameID + 1;
+
+    const auto &size = m_frameData.size;
+    if (accumulationFrames > 1)
+      m_accumBuffer.resize(size.x * size.y);
+    else
+      m_accumBuffer.clear();
 
     // NOTE(jda) - We don't want any anariGetProperty() calls also trying to
     //             rebuild the Embree scene in parallel to us doing a rebuild.
@@ -166,7 +196,6 @@ void Frame::renderFrame()
 
     const auto taskGrainSize = uint2(m_renderer->taskGrainSize());
 
-    const auto &size = m_frameData.size;
     using Range = embree::range<uint32_t>;
     embree::parallel_for(0u, size.y, taskGrainSize.y, [&](const Range &ry) {
       for (auto y = ry.begin(); y < ry.end(); y++) {
@@ -177,7 +206,13 @@ void Frame::renderFrame()
             screen.x = linalg::lerp(imageRegion.x, imageRegion.z, screen.x);
             screen.y = linalg::lerp(imageRegion.y, imageRegion.w, screen.y);
             Ray ray = m_camera->createRay(screen);
-            writeSample(x, y, m_renderer->renderSample(screen, ray, *m_world));
+            writeSample(x,
+                y,
+                m_renderer->renderSample(screen,
+                    ray,
+                    *m_world,
+                    uint2(x, y),
+                    m_frameData.frameID));
           }
         });
       }
@@ -271,20 +306,31 @@ float2 Frame::screenFromPixel(const float2 &p) const
 void Frame::writeSample(int x, int y, const PixelSample &s)
 {
   const auto idx = y * m_frameData.size.x + x;
+
+  float4 sampleColor = s.color;
+  if (!m_accumBuffer.empty()) {
+    auto &accum = m_accumBuffer[idx];
+    const int frameID = m_frameData.frameID;
+    accum = frameID == 0
+        ? sampleColor
+        : linalg::lerp(accum, sampleColor, 1.f / (frameID + 1));
+    sampleColor = accum;
+  }
+
   auto *color = m_pixelBuffer.data() + (idx * m_perPixelBytes);
   switch (m_colorType) {
   case ANARI_UFIXED8_VEC4: {
-    auto c = helium::math::cvt_color_to_uint32(s.color);
+    auto c = helium::math::cvt_color_to_uint32(sampleColor);
     std::memcpy(color, &c, sizeof(c));
     break;
   }
   case ANARI_UFIXED8_RGBA_SRGB: {
-    auto c = helium::math::cvt_color_to_uint32_srgb(s.color);
+    auto c = helium::math::cvt_color_to_uint32_srgb(sampleColor);
     std::memcpy(color, &c, sizeof(c));
     break;
   }
   case ANARI_FLOAT32_VEC4: {
-    std::memcpy(color, &s.color, sizeof(s.color));
+    std::memcpy(color, &sampleColor, sizeof(sampleColor));
     break;
   }
   default:
@@ -72,6 +72,7 @@ struct Frame : public helium::BaseFrame
   std::vector<uint32_t> m_primIdBuffer;
   std::vector<uint32_t> m_objIdBuffer;
   std::vector<uint32_t> m_instIdBuffer;
+  std::vector<float4> m_accumBuffer;
 
   helium::IntrusivePtr<Renderer> m_renderer;
   helium::IntrusivePtr<Camera> m_camera;
@@ -7,6 +7,18 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom primitiveIndex("primitive.index");
+static const helium::StringAtom radius("radius");
+static const helium::StringAtom vertexAttribute0("vertex.attribute0");
+static const helium::StringAtom vertexAttribute1("vertex.attribute1");
+static const helium::StringAtom vertexAttribute2("vertex.attribute2");
+static const helium::StringAtom vertexAttribute3("vertex.attribute3");
+static const helium::StringAtom vertexColor("vertex.color");
+static const helium::StringAtom vertexPosition("vertex.position");
+static const helium::StringAtom vertexRadius("vertex.radius");
+} // namespace param
+
 Cone::Cone(HelideGlobalState *s)
     : Geometry(s), m_index(this), m_vertexPosition(this), m_vertexRadius(this)
 {
@@ -17,14 +29,14 @@ Cone::Cone(HelideGlobalState *s)
 void Cone::commitParameters()
 {
   Geometry::commitParameters();
-  m_index = getParamObject<Array1D>("primitive.index");
-  m_vertexPosition = getParamObject<Array1D>("vertex.position");
-  m_vertexRadius = getParamObject<Array1D>("vertex.radius");
-  m_vertexAttributes[0] = getParamObject<Array1D>("vertex.attribute0");
-  m_vertexAttributes[1] = getParamObject<Array1D>("vertex.attribute1");
-  m_vertexAttributes[2] = getParamObject<Array1D>("vertex.attribute2");
-  m_vertexAttributes[3] = getParamObject<Array1D>("vertex.attribute3");
-  m_vertexAttributes[4] = getParamObject<Array1D>("vertex.color");
+  m_index = getParamObject<Array1D>(param::primitiveIndex);
+  m_vertexPosition = getParamObject<Array1D>(param::vertexPosition);
+  m_vertexRadius = getParamObject<Array1D>(param::vertexRadius);
+  m_vertexAttributes[0] = getParamObject<Array1D>(param::vertexAttribute0);
+  m_vertexAttributes[1] = getParamObject<Array1D>(param::vertexAttribute1);
+  m_vertexAttributes[2] = getParamObject<Array1D>(param::vertexAttribute2);
+  m_vertexAttributes[3] = getParamObject<Array1D>(param::vertexAttribute3);
+  m_vertexAttributes[4] = getParamObject<Array1D>(param::vertexColor);
 }
 
 void Cone::finalize()
@@ -37,18 +49,25 @@ void Cone::finalize()
 
   const float *radius =
       m_vertexRadius ? m_vertexRadius->beginAs<float>() : nullptr;
-  m_globalRadius = getParam<float>("radius", 1.f);
+  m_globalRadius = getParam<float>(param::radius, 1.f);
 
   const auto numCones =
       m_index ? m_index->size() : m_vertexPosition->size() / 2;
 
   {
-    auto *vr = (float4 *)rtcSetNewGeometryBuffer(embreeGeometry(),
-        RTC_BUFFER_TYPE_VERTEX,
-        0,
-        RTC_FORMAT_FLOAT4,
-        sizeof(float4),
-        numCones * 2);
+    // Indexed cones don't map array elements to vertices one-to-one, so they
+    // always rewrite the whole vertex buffer
+    size_t first = 0;
+    size_t last = 0;
+    float4 *vr = nullptr;
+    if (m_index)
+      vr = vertexBufferForUpdate(numCones * 2, {}, first, last);
+    else {
+      vr = vertexBufferForUpdate(numCones * 2,
+          {m_vertexPosition.get(), m_vertexRadius.get()},
+          first,
+          last);
+    }
 
     if (m_index) {
       const auto *begin = m_index->beginAs<uint2>();
@@ -61,11 +80,10 @@ void Cone::finalize()
         cID += 2;
       });
     } else {
-      const auto *begin = m_vertexPosition->beginAs<float3>();
-      const auto *end = m_vertexPosition->endAs<float3>();
-      uint32_t rID = 0;
-      std::transform(begin, end, vr, [&](const float3 &v) {
-        return float4(v, radius ? radius[rID++] : m_globalRadius);
+      const auto *v = m_vertexPosition->beginAs<float3>();
+      size_t rID = first;
+      std::transform(v + first, v + last, vr + first, [&](const float3 &p) {
+        return float4(p, radius ? radius[rID++] : m_globalRadius);
       });
     }
   }
@@ -7,6 +7,18 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom primitiveIndex("primitive.index");
+static const helium::StringAtom radius("radius");
+static const helium::StringAtom vertexAttribute0("vertex.attribute0");
+static const helium::StringAtom vertexAttribute1("vertex.attribute1");
+static const helium::StringAtom vertexAttribute2("vertex.attribute2");
+static const helium::StringAtom vertexAttribute3("vertex.attribute3");
+static const helium::StringAtom vertexColor("vertex.color");
+static const helium::StringAtom vertexPosition("vertex.position");
+static const helium::StringAtom vertexRadius("vertex.radius");
+} // namespace param
+
 Curve::Curve(HelideGlobalState *s)
     : Geometry(s), m_index(this), m_vertexPosition(this), m_vertexRadius(this)
 {
@@ -17,14 +29,14 @@ Curve::Curve(HelideGlobalState *s)
 void Curve::commitParameters()
 {
   Geometry::commitParameters();
-  m_index = getParamObject<Array1D>("primitive.index");
-  m_vertexPosition = getParamObject<Array1D>("vertex.position");
-  m_vertexRadius = getParamObject<Array1D>("vertex.radius");
-  m_vertexAttributes[0] = getParamObject<Array1D>("vertex.attribute0");
-  m_vertexAttributes[1] = getParamObject<Array1D>("vertex.attribute1");
-  m_vertexAttributes[2] = getParamObject<Array1D>("vertex.attribute2");
-  m_vertexAttributes[3] = getParamObject<Array1D>("vertex.attribute3");
-  m_vertexAttributes[4] = getParamObject<Array1D>("vertex.color");
+  m_index = getParamObject<Array1D>(param::primitiveIndex);
+  m_vertexPosition = getParamObject<Array1D>(param::vertexPosition);
+  m_vertexRadius = getParamObject<Array1D>(param::vertexRadius);
+  m_vertexAttributes[0] = getParamObject<Array1D>(param::vertexAttribute0);
+  m_vertexAttributes[1] = getParamObject<Array1D>(param::vertexAttribute1);
+  m_vertexAttributes[2] = getParamObject<Array1D>(param::vertexAttribute2);
+  m_vertexAttributes[3] = getParamObject<Array1D>(param::vertexAttribute3);
+  m_vertexAttributes[4] = getParamObject<Array1D>(param::vertexColor);
 }
 
 void Curve::finalize()
@@ -37,25 +49,25 @@ void Curve::finalize()
 
   const float *radius =
       m_vertexRadius ? m_vertexRadius->beginAs<float>() : nullptr;
-  m_globalRadius = getParam<float>("radius", 1.f);
+  m_globalRadius = getParam<float>(param::radius, 1.f);
 
   const auto numSegments =
       m_index ? m_index->size() : m_vertexPosition->size() / 2;
 
   {
-    auto *vr = (float4 *)rtcSetNewGeometryBuffer(embreeGeometry(),
-        RTC_BUFFER_TYPE_VERTEX,
-        0,
-        RTC_FORMAT_FLOAT4,
-        sizeof(float4),
-        m_vertexPosition->size());
-
-    const auto *begin = m_vertexPosition->beginAs<float3>();
-    const auto *end = m_vertexPosition->endAs<float3>();
-    uint32_t rID = 0;
-    std::transform(begin, end, vr, [&](const float3 &v) {
-      return float4(v, radius ? radius[rID++] : m_globalRadius);
-    });
+    size_t first = 0;
+    size_t last = 0;
+    auto *vr = vertexBufferForUpdate(m_vertexPosition->size(),
+        {m_vertexPosition.get(), m_vertexRadius.get()},
+        first,
+        last);
+
+    const auto *vertices = m_vertexPosition->beginAs<float3>();
+    size_t rID = first;
+    std::transform(
+        vertices + first, vertices + last, vr + first, [&](const float3 &v) {
+          return float4(v, radius ? radius[rID++] : m_globalRadius);
+        });
   }
 
   if (m_index) {
@@ -10,11 +10,26 @@
 #include "Sphere.h"
 #include "Triangle.h"
 // std
+#include <algorithm>
 #include <cstring>
 #include <limits>
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom attribute0("attribute0");
+static const helium::StringAtom attribute1("attribute1");
+static const helium::StringAtom attribute2("attribute2");
+static const helium::StringAtom attribute3("attribute3");
+static const helium::StringAtom color("color");
+static const helium::StringAtom primitiveAttribute0("primitive.attribute0");
+static const helium::StringAtom primitiveAttribute1("primitive.attribute1");
+static const helium::StringAtom primitiveAttribute2("primitive.attribute2");
+static const helium::StringAtom primitiveAttribute3("primitive.attribute3");
+static const helium::StringAtom primitiveColor("primitive.color");
+static const helium::StringAtom primitiveId("primitive.id");
+} // namespace param
+
 Geometry::Geometry(HelideGlobalState *s) : Object(ANARI_GEOMETRY, s) {}
 
 Geometry::~Geometry()
@@ -26,19 +41,19 @@ Geometry *Geometry::createInstance(
     std::string_view subtype, HelideGlobalState *s)
 {
   if (subtype == "cone")
-    return new Cone(s);
+    return new (s) Cone(s);
   else if (subtype == "curve")
-    return new Curve(s);
+    return new (s) Curve(s);
   else if (subtype == "cylinder")
-    return new Cylinder(s);
+    return new (s) Cylinder(s);
   else if (subtype == "quad")
-    return new Quad(s);
+    return new (s) Quad(s);
   else if (subtype == "sphere")
-    return new Sphere(s);
+    return new (s) Sphere(s);
   else if (subtype == "triangle")
-    return new Triangle(s);
+    return new (s) Triangle(s);
   else
-    return (Geometry *)new UnknownObject(ANARI_GEOMETRY, s);
+    return (Geometry *)new (s) UnknownObject(ANARI_GEOMETRY, s);
 }
 
 RTCGeometry Geometry::embreeGeometry() const
@@ -46,27 +61,71 @@ RTCGeometry Geometry::embreeGeometry() const
   return m_embreeGeometry;
 }
 
+float4 *Geometry::vertexBufferForUpdate(size_t numVertices,
+    std::initializer_list<const Array1D *> sources,
+    size_t &begin,
+    size_t &end)
+{
+  const auto now = helium::newTimeStamp();
+
+  const bool reuse = m_vertexBuffer && sources.size() > 0
+      && numVertices == m_vertexBufferSize
+      && lastCommitted() < m_vertexBufferWritten;
+
+  if (reuse) {
+    begin = numVertices;
+    end = 0;
+    for (const auto *a : sources) {
+      if (!a)
+        continue;
+      const auto r = a->modifiedRangeSince(m_vertexBufferWritten);
+      if (r.first < r.second) {
+        begin = std::min(begin, r.first);
+        end = std::max(end, r.second);
+      }
+    }
+    end = std::min(end, numVertices);
+    if (begin < end)
+      rtcUpdateGeometryBuffer(embreeGeometry(), RTC_BUFFER_TYPE_VERTEX, 0);
+    else
+      begin = end = 0;
+  } else {
+    m_vertexBuffer = (float4 *)rtcSetNewGeometryBuffer(embreeGeometry(),
+        RTC_BUFFER_TYPE_VERTEX,
+        0,
+        RTC_FORMAT_FLOAT4,
+        sizeof(float4),
+        numVertices);
+    m_vertexBufferSize = numVertices;
+    begin = 0;
+    end = numVertices;
+  }
+
+  m_vertexBufferWritten = now;
+  return m_vertexBuffer;
+}
+
 void Geometry::commitParameters()
 {
   for (auto &a : m_uniformAttr)
     a.reset();
   float4 attrV = DEFAULT_ATTRIBUTE_VALUE;
-  if (getParam("attribute0", ANARI_FLOAT32_VEC4, &attrV))
+  if (getParam(param::attribute0, ANARI_FLOAT32_VEC4, &attrV))
     m_uniformAttr[0] = attrV;
-  if (getParam("attribute1", ANARI_FLOAT32_VEC4, &attrV))
+  if (getParam(param::attribute1, ANARI_FLOAT32_VEC4, &attrV))
     m_uniformAttr[1] = attrV;
-  if (getParam("attribute2", ANARI_FLOAT32_VEC4, &attrV))
+  if (getParam(param::attribute2, ANARI_FLOAT32_VEC4, &attrV))
     m_uniformAttr[2] = attrV;
-  if (getParam("attribute3", ANARI_FLOAT32_VEC4, &attrV))
+  if (getParam(param::attribute3, ANARI_FLOAT32_VEC4, &attrV))
     m_uniformAttr[3] = attrV;
-  if (getParam("color", ANARI_FLOAT32_VEC4, &attrV))
+  if (getParam(param::color, ANARI_FLOAT32_VEC4, &attrV))
     m_uniformAttr[4] = attrV;
-  m_primitiveAttr[0] = getParamObject<Array1D>("primitive.attribute0");
-  m_primitiveAttr[1] = getParamObject<Array1D>("primitive.attribute1");
-  m_primitiveAttr[2] = getParamObject<Array1D>("primitive.attribute2");
-  m_primitiveAttr[3] = getParamObject<Array1D>("primitive.attribute3");
-  m_primitiveAttr[4] = getParamObject<Array1D>("primitive.color");
-  m_primitiveId = getParamObject<Array1D>("primitive.id");
+  m_primitiveAttr[0] = getParamObject<Array1D>(param::primitiveAttribute0);
+  m_primitiveAttr[1] = getParamObject<Array1D>(param::primitiveAttribute1);
+  m_primitiveAttr[2] = getParamObject<Array1D>(param::primitiveAttribute2);
+  m_primitiveAttr[3] = getParamObject<Array1D>(param::primitiveAttribute3);
+  m_primitiveAttr[4] = getParamObject<Array1D>(param::primitiveColor);
+  m_primitiveId = getParamObject<Array1D>(param::primitiveId);
   if (m_primitiveId
       && !(m_primitiveId->elementType() != ANARI_UINT32
           || m_primitiveId->elementType() != ANARI_UINT64)) {
@@ -77,8 +136,7 @@ void Geometry::commitParameters()
 void Geometry::markFinalized()
 {
   Object::markFinalized();
-  deviceState()->objectUpdates.lastBLSCommitSceneRequest =
-      helium::newTimeStamp();
+  markDirty(DIRTY_BLS_COMMIT);
 }
 
 float4 Geometry::getAttributeValue(const Attribute &attr, const Ray &ray) const
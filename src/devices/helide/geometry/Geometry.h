@@ -5,6 +5,8 @@
 
 #include "Object.h"
 #include "array/Array1D.h"
+// std
+#include <initializer_list>
 
 namespace helide {
 
@@ -25,11 +27,28 @@ struct Geometry : public Object
   uint32_t getPrimID(const Ray &ray) const;
 
  protected:
+  // Return the Embree vertex buffer (slot 0, one float4 per vertex) to be
+  // filled from the 'sources' arrays, along with the [begin, end) range of
+  // vertices which need to be written. The buffer is reused between
+  // finalizations: if only array data changed since it was last written and
+  // its size is the same, the range only covers the elements modified in
+  // 'sources' (which must map element 'i' to vertex 'i'). Passing no sources
+  // always rewrites the whole buffer.
+  float4 *vertexBufferForUpdate(size_t numVertices,
+      std::initializer_list<const Array1D *> sources,
+      size_t &begin,
+      size_t &end);
+
   RTCGeometry m_embreeGeometry{nullptr};
 
   UniformAttributeSet m_uniformAttr;
   std::array<helium::IntrusivePtr<Array1D>, 5> m_primitiveAttr;
   helium::IntrusivePtr<Array1D> m_primitiveId;
+
+ private:
+  float4 *m_vertexBuffer{nullptr};
+  size_t m_vertexBufferSize{0};
+  helium::TimeStamp m_vertexBufferWritten{0};
 };
 
 // Inlined definitions ////////////////////////////////////////////////////////
@@ -7,6 +7,16 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom primitiveIndex("primitive.index");
+static const helium::StringAtom vertexAttribute0("vertex.attribute0");
+static const helium::StringAtom vertexAttribute1("vertex.attribute1");
+static const helium::StringAtom vertexAttribute2("vertex.attribute2");
+static const helium::StringAtom vertexAttribute3("vertex.attribute3");
+static const helium::StringAtom vertexColor("vertex.color");
+static const helium::StringAtom vertexPosition("vertex.position");
+} // namespace param
+
 Quad::Quad(HelideGlobalState *s)
     : Geometry(s), m_index(this), m_vertexPosition(this)
 {
@@ -16,13 +26,13 @@ Quad::Quad(HelideGlobalState *s)
 void Quad::commitParameters()
 {
   Geometry::commitParameters();
-  m_index = getParamObject<Array1D>("primitive.index");
-  m_vertexPosition = getParamObject<Array1D>("vertex.position");
-  m_vertexAttributes[0] = getParamObject<Array1D>("vertex.attribute0");
-  m_vertexAttributes[1] = getParamObject<Array1D>("vertex.attribute1");
-  m_vertexAttributes[2] = getParamObject<Array1D>("vertex.attribute2");
-  m_vertexAttributes[3] = getParamObject<Array1D>("vertex.attribute3");
-  m_vertexAttributes[4] = getParamObject<Array1D>("vertex.color");
+  m_index = getParamObject<Array1D>(param::primitiveIndex);
+  m_vertexPosition = getParamObject<Array1D>(param::vertexPosition);
+  m_vertexAttributes[0] = getParamObject<Array1D>(param::vertexAttribute0);
+  m_vertexAttributes[1] = getParamObject<Array1D>(param::vertexAttribute1);
+  m_vertexAttributes[2] = getParamObject<Array1D>(param::vertexAttribute2);
+  m_vertexAttributes[3] = getParamObject<Array1D>(param::vertexAttribute3);
+  m_vertexAttributes[4] = getParamObject<Array1D>(param::vertexColor);
 }
 
 void Quad::finalize()
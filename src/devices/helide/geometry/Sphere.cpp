@@ -5,6 +5,18 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom primitiveIndex("primitive.index");
+static const helium::StringAtom radius("radius");
+static const helium::StringAtom vertexAttribute0("vertex.attribute0");
+static const helium::StringAtom vertexAttribute1("vertex.attribute1");
+static const helium::StringAtom vertexAttribute2("vertex.attribute2");
+static const helium::StringAtom vertexAttribute3("vertex.attribute3");
+static const helium::StringAtom vertexColor("vertex.color");
+static const helium::StringAtom vertexPosition("vertex.position");
+static const helium::StringAtom vertexRadius("vertex.radius");
+} // namespace param
+
 Sphere::Sphere(HelideGlobalState *s)
     : Geometry(s), m_index(this), m_vertexPosition(this), m_vertexRadius(this)
 {
@@ -15,14 +27,14 @@ Sphere::Sphere(HelideGlobalState *s)
 void Sphere::commitParameters()
 {
   Geometry::commitParameters();
-  m_index = getParamObject<Array1D>("primitive.index");
-  m_vertexPosition = getParamObject<Array1D>("vertex.position");
-  m_vertexRadius = getParamObject<Array1D>("vertex.radius");
-  m_vertexAttributes[0] = getParamObject<Array1D>("vertex.attribute0");
-  m_vertexAttributes[1] = getParamObject<Array1D>("vertex.attribute1");
-  m_vertexAttributes[2] = getParamObject<Array1D>("vertex.attribute2");
-  m_vertexAttributes[3] = getParamObject<Array1D>("vertex.attribute3");
-  m_vertexAttributes[4] = getParamObject<Array1D>("vertex.color");
+  m_index = getParamObject<Array1D>(param::primitiveIndex);
+  m_vertexPosition = getParamObject<Array1D>(param::vertexPosition);
+  m_vertexRadius = getParamObject<Array1D>(param::vertexRadius);
+  m_vertexAttributes[0] = getParamObject<Array1D>(param::vertexAttribute0);
+  m_vertexAttributes[1] = getParamObject<Array1D>(param::vertexAttribute1);
+  m_vertexAttributes[2] = getParamObject<Array1D>(param::vertexAttribute2);
+  m_vertexAttributes[3] = getParamObject<Array1D>(param::vertexAttribute3);
+  m_vertexAttributes[4] = getParamObject<Array1D>(param::vertexColor);
 }
 
 void Sphere::finalize()
@@ -33,7 +45,7 @@ void Sphere::finalize()
     return;
   }
 
-  m_globalRadius = getParam<float>("radius", 0.01f);
+  m_globalRadius = getParam<float>(param::radius, 0.01f);
 
   const float *radius = nullptr;
   if (m_vertexRadius)
@@ -41,23 +53,28 @@ void Sphere::finalize()
 
   const auto numSpheres = m_index ? m_index->size() : m_vertexPosition->size();
 
-  auto *vr = (float4 *)rtcSetNewGeometryBuffer(embreeGeometry(),
-      RTC_BUFFER_TYPE_VERTEX,
-      0,
-      RTC_FORMAT_FLOAT4,
-      sizeof(float4),
-      numSpheres);
-
-  m_attributeIndex.clear();
+  // Indexed spheres don't map array elements to spheres one-to-one, so they
+  // always rewrite the whole vertex buffer
+  size_t first = 0;
+  size_t last = 0;
+  float4 *vr = nullptr;
+  if (m_index)
+    vr = vertexBufferForUpdate(numSpheres, {}, first, last);
+  else {
+    vr = vertexBufferForUpdate(numSpheres,
+        {m_vertexPosition.get(), m_vertexRadius.get()},
+        first,
+        last);
+  }
 
   if (m_index) {
+    m_attributeIndex.clear();
     m_attributeIndex.reserve(m_index->size());
 
     const auto *begin = m_index->beginAs<uint32_t>();
     const auto *end = m_index->endAs<uint32_t>();
     const auto *vertices = m_vertexPosition->beginAs<float3>();
 
-    size_t sphereID = 0;
     std::transform(begin, end, vr, [&](uint32_t i) {
       m_attributeIndex.push_back(i);
       const auto &v = vertices[i];
@@ -65,14 +82,16 @@ void Sphere::finalize()
       return float4(v.x, v.y, v.z, r);
     });
   } else {
-    const auto *begin = m_vertexPosition->beginAs<float3>();
-    const auto *end = m_vertexPosition->endAs<float3>();
+    m_attributeIndex.clear();
 
-    size_t sphereID = 0;
-    std::transform(begin, end, vr, [&](const float3 &v) {
-      const float r = radius ? radius[sphereID++] : m_globalRadius;
-      return float4(v.x, v.y, v.z, r);
-    });
+    const auto *vertices = m_vertexPosition->beginAs<float3>();
+
+    size_t sphereID = first;
+    std::transform(
+        vertices + first, vertices + last, vr + first, [&](const float3 &v) {
+          const float r = radius ? radius[sphereID++] : m_globalRadius;
+          return float4(v.x, v.y, v.z, r);
+        });
   }
 
   rtcCommitGeometry(embreeGeometry());
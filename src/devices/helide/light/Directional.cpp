@@ -0,0 +1,31 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Directional.h"
+
+namespace helide {
+
+namespace param {
+static const helium::StringAtom direction("direction");
+static const helium::StringAtom irradiance("irradiance");
+} // namespace param
+
+Directional::Directional(HelideGlobalState *s) : Light(s) {}
+
+void Directional::commitParameters()
+{
+  Light::commitParameters();
+  m_direction = getParam<float3>(param::direction, float3(0.f, 0.f, -1.f));
+  m_irradiance = std::max(getParam<float>(param::irradiance, 1.f), 0.f);
+}
+
+LightSample Directional::sample(const float3 &, const mat4 &xfm) const
+{
+  LightSample ls;
+  ls.dir = -normalize(xfmVec(xfm, m_direction));
+  ls.dist = std::numeric_limits<float>::infinity();
+  ls.irradiance = m_color * m_irradiance;
+  return ls;
+}
+
+} // namespace helide
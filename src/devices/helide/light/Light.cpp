@@ -2,14 +2,37 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "Light.h"
+// subtypes
+#include "Directional.h"
+#include "Point.h"
+#include "QuadLight.h"
+#include "Spot.h"
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom color("color");
+} // namespace param
+
 Light::Light(HelideGlobalState *s) : Object(ANARI_LIGHT, s) {}
 
-Light *Light::createInstance(std::string_view /*subtype*/, HelideGlobalState *s)
+Light *Light::createInstance(std::string_view subtype, HelideGlobalState *s)
+{
+  if (subtype == "directional")
+    return new (s) Directional(s);
+  else if (subtype == "point")
+    return new (s) Point(s);
+  else if (subtype == "spot")
+    return new (s) Spot(s);
+  else if (subtype == "quad")
+    return new (s) QuadLight(s);
+  else
+    return (Light *)new (s) UnknownObject(ANARI_LIGHT, s);
+}
+
+void Light::commitParameters()
 {
-  return (Light *)new UnknownObject(ANARI_LIGHT, s);
+  m_color = getParam<float3>(param::color, float3(1.f));
 }
 
 } // namespace helide
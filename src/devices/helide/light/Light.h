@@ -7,10 +7,26 @@
 
 namespace helide {
 
+struct LightSample
+{
+  float3 dir{0.f}; // normalized direction from the shaded point to the light
+  float dist{0.f}; // distance to the light along 'dir'
+  float3 irradiance{0.f}; // incident irradiance arriving along 'dir'
+};
+
 struct Light : public Object
 {
   Light(HelideGlobalState *d);
   static Light *createInstance(std::string_view subtype, HelideGlobalState *d);
+
+  void commitParameters() override;
+
+  // Sample the light as seen from world-space point 'P', where 'xfm' is the
+  // transform of the instance the light is found in
+  virtual LightSample sample(const float3 &P, const mat4 &xfm) const = 0;
+
+ protected:
+  float3 m_color{1.f, 1.f, 1.f};
 };
 
 } // namespace helide
@@ -0,0 +1,38 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Point.h"
+
+namespace helide {
+
+namespace param {
+static const helium::StringAtom intensity("intensity");
+static const helium::StringAtom position("position");
+static const helium::StringAtom power("power");
+} // namespace param
+
+Point::Point(HelideGlobalState *s) : Light(s) {}
+
+void Point::commitParameters()
+{
+  Light::commitParameters();
+  m_position = getParam<float3>(param::position, float3(0.f));
+  m_intensity = getParam<float>(param::intensity, 1.f);
+  if (!hasParam(param::intensity) && hasParam(param::power))
+    m_intensity = getParam<float>(param::power, 1.f) / (4.f * float(M_PI));
+  m_intensity = std::max(m_intensity, 0.f);
+}
+
+LightSample Point::sample(const float3 &P, const mat4 &xfm) const
+{
+  const float3 toLight = xfmPoint(xfm, m_position) - P;
+  const float dist2 = linalg::length2(toLight);
+
+  LightSample ls;
+  ls.dist = std::sqrt(dist2);
+  ls.dir = toLight / ls.dist;
+  ls.irradiance = m_color * (m_intensity / dist2);
+  return ls;
+}
+
+} // namespace helide
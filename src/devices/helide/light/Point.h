@@ -0,0 +1,23 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Light.h"
+
+namespace helide {
+
+struct Point : public Light
+{
+  Point(HelideGlobalState *s);
+
+  void commitParameters() override;
+
+  LightSample sample(const float3 &P, const mat4 &xfm) const override;
+
+ private:
+  float3 m_position{0.f};
+  float m_intensity{1.f};
+};
+
+} // namespace helide
@@ -0,0 +1,69 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "QuadLight.h"
+
+namespace helide {
+
+namespace param {
+static const helium::StringAtom edge1("edge1");
+static const helium::StringAtom edge2("edge2");
+static const helium::StringAtom intensity("intensity");
+static const helium::StringAtom position("position");
+static const helium::StringAtom power("power");
+static const helium::StringAtom radiance("radiance");
+static const helium::StringAtom side("side");
+} // namespace param
+
+QuadLight::QuadLight(HelideGlobalState *s) : Light(s) {}
+
+void QuadLight::commitParameters()
+{
+  Light::commitParameters();
+  m_position = getParam<float3>(param::position, float3(0.f));
+  m_edge1 = getParam<float3>(param::edge1, float3(1.f, 0.f, 0.f));
+  m_edge2 = getParam<float3>(param::edge2, float3(0.f, 1.f, 0.f));
+
+  const auto side = getParamString(param::side, "front");
+  m_frontSide = side != "back";
+  m_backSide = side != "front";
+
+  const float area = std::max(length(cross(m_edge1, m_edge2)), 1e-6f);
+  const float numSides = float(m_frontSide) + float(m_backSide);
+
+  m_radiance = getParam<float>(param::radiance, 1.f);
+  if (!hasParam(param::radiance) && hasParam(param::intensity))
+    m_radiance = getParam<float>(param::intensity, 1.f) / area;
+  else if (!hasParam(param::radiance) && hasParam(param::power)) {
+    m_radiance =
+        getParam<float>(param::power, 1.f) / (numSides * float(M_PI) * area);
+  }
+  m_radiance = std::max(m_radiance, 0.f);
+}
+
+LightSample QuadLight::sample(const float3 &P, const mat4 &xfm) const
+{
+  // NOTE: the quad is treated as a point emitter at its center, scaled by its
+  //       projected area, which gives hard shadows but no sampling noise
+  const float3 e1 = xfmVec(xfm, m_edge1);
+  const float3 e2 = xfmVec(xfm, m_edge2);
+  const float3 center = xfmPoint(xfm, m_position) + 0.5f * (e1 + e2);
+  const float3 toLight = center - P;
+  const float dist2 = linalg::length2(toLight);
+
+  LightSample ls;
+  ls.dist = std::sqrt(dist2);
+  ls.dir = toLight / ls.dist;
+
+  const float3 areaNormal = cross(e1, e2);
+  const float cosArea = linalg::dot(-ls.dir, areaNormal);
+  const bool visible = (cosArea > 0.f && m_frontSide)
+      || (cosArea < 0.f && m_backSide);
+
+  if (visible)
+    ls.irradiance = m_color * (m_radiance * std::abs(cosArea) / dist2);
+
+  return ls;
+}
+
+} // namespace helide
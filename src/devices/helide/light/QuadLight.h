@@ -0,0 +1,27 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Light.h"
+
+namespace helide {
+
+struct QuadLight : public Light
+{
+  QuadLight(HelideGlobalState *s);
+
+  void commitParameters() override;
+
+  LightSample sample(const float3 &P, const mat4 &xfm) const override;
+
+ private:
+  float3 m_position{0.f};
+  float3 m_edge1{1.f, 0.f, 0.f};
+  float3 m_edge2{0.f, 1.f, 0.f};
+  float m_radiance{1.f};
+  bool m_frontSide{true};
+  bool m_backSide{false};
+};
+
+} // namespace helide
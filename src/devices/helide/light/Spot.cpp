@@ -0,0 +1,63 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Spot.h"
+
+namespace helide {
+
+namespace param {
+static const helium::StringAtom direction("direction");
+static const helium::StringAtom falloffAngle("falloffAngle");
+static const helium::StringAtom intensity("intensity");
+static const helium::StringAtom openingAngle("openingAngle");
+static const helium::StringAtom position("position");
+static const helium::StringAtom power("power");
+} // namespace param
+
+Spot::Spot(HelideGlobalState *s) : Light(s) {}
+
+void Spot::commitParameters()
+{
+  Light::commitParameters();
+  m_position = getParam<float3>(param::position, float3(0.f));
+  m_direction = getParam<float3>(param::direction, float3(0.f, 0.f, -1.f));
+
+  const float openingAngle = std::clamp(
+      getParam<float>(param::openingAngle, float(M_PI)), 0.f, float(M_PI));
+  const float falloffAngle = std::clamp(
+      getParam<float>(param::falloffAngle, 0.1f), 0.f, openingAngle / 2);
+  m_cosOuterAngle = std::cos(openingAngle / 2);
+  m_cosInnerAngle = std::cos(openingAngle / 2 - falloffAngle);
+
+  m_intensity = getParam<float>(param::intensity, 1.f);
+  if (!hasParam(param::intensity) && hasParam(param::power)) {
+    const float solidAngle = 2.f * float(M_PI) * (1.f - m_cosOuterAngle);
+    m_intensity =
+        getParam<float>(param::power, 1.f) / std::max(solidAngle, 1e-6f);
+  }
+  m_intensity = std::max(m_intensity, 0.f);
+}
+
+LightSample Spot::sample(const float3 &P, const mat4 &xfm) const
+{
+  const float3 toLight = xfmPoint(xfm, m_position) - P;
+  const float dist2 = linalg::length2(toLight);
+
+  LightSample ls;
+  ls.dist = std::sqrt(dist2);
+  ls.dir = toLight / ls.dist;
+
+  const float3 spotDir = normalize(xfmVec(xfm, m_direction));
+  const float cosAngle = linalg::dot(-ls.dir, spotDir);
+  const float falloff = m_cosInnerAngle > m_cosOuterAngle
+      ? std::clamp((cosAngle - m_cosOuterAngle)
+              / (m_cosInnerAngle - m_cosOuterAngle),
+          0.f,
+          1.f)
+      : float(cosAngle >= m_cosOuterAngle);
+
+  ls.irradiance = m_color * (falloff * m_intensity / dist2);
+  return ls;
+}
+
+} // namespace helide
@@ -8,23 +8,28 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom alphaCutoff("alphaCutoff");
+static const helium::StringAtom alphaMode("alphaMode");
+} // namespace param
+
 Material::Material(HelideGlobalState *s) : Object(ANARI_MATERIAL, s) {}
 
 Material *Material::createInstance(
     std::string_view subtype, HelideGlobalState *s)
 {
   if (subtype == "matte")
-    return new Matte(s);
+    return new (s) Matte(s);
   else if (subtype == "physicallyBased")
-    return new PBM(s);
+    return new (s) PBM(s);
   else
-    return (Material *)new UnknownObject(ANARI_MATERIAL, s);
+    return (Material *)new (s) UnknownObject(ANARI_MATERIAL, s);
 }
 
 void Material::commitParameters()
 {
-  m_alphaMode = alphaModeFromString(getParamString("alphaMode", "opaque"));
-  m_alphaCutoff = getParam<float>("alphaCutoff", 0.5f);
+  m_alphaMode = alphaModeFromString(getParamString(param::alphaMode, "opaque"));
+  m_alphaCutoff = getParam<float>(param::alphaCutoff, 0.5f);
 }
 
 } // namespace helide
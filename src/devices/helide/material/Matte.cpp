@@ -5,6 +5,11 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom color("color");
+static const helium::StringAtom opacity("opacity");
+} // namespace param
+
 Matte::Matte(HelideGlobalState *s) : Material(s) {}
 
 void Matte::commitParameters()
@@ -12,14 +17,15 @@ void Matte::commitParameters()
   Material::commitParameters();
 
   m_color = float4(1.f, 1.f, 1.f, 1.f);
-  getParam("color", ANARI_FLOAT32_VEC3, &m_color);
-  getParam("color", ANARI_FLOAT32_VEC4, &m_color);
-  m_colorAttribute = attributeFromString(getParamString("color", "none"));
-  m_colorSampler = getParamObject<Sampler>("color");
-
-  m_opacity = getParam<float>("opacity", 1.f);
-  m_opacityAttribute = attributeFromString(getParamString("opacity", "none"));
-  m_opacitySampler = getParamObject<Sampler>("opacity");
+  getParam(param::color, ANARI_FLOAT32_VEC3, &m_color);
+  getParam(param::color, ANARI_FLOAT32_VEC4, &m_color);
+  m_colorAttribute = attributeFromString(getParamString(param::color, "none"));
+  m_colorSampler = getParamObject<Sampler>(param::color);
+
+  m_opacity = getParam<float>(param::opacity, 1.f);
+  m_opacityAttribute =
+      attributeFromString(getParamString(param::opacity, "none"));
+  m_opacitySampler = getParamObject<Sampler>(param::opacity);
 }
 
 } // namespace helide
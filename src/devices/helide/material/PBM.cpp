@@ -5,6 +5,11 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom baseColor("baseColor");
+static const helium::StringAtom opacity("opacity");
+} // namespace param
+
 PBM::PBM(HelideGlobalState *s) : Material(s) {}
 
 void PBM::commitParameters()
@@ -12,15 +17,16 @@ void PBM::commitParameters()
   Material::commitParameters();
 
   m_color = float4(1.f, 1.f, 1.f, 1.f);
-  getParam("baseColor", ANARI_FLOAT32_VEC3, &m_color);
-  getParam("baseColor", ANARI_FLOAT32_VEC4, &m_color);
+  getParam(param::baseColor, ANARI_FLOAT32_VEC3, &m_color);
+  getParam(param::baseColor, ANARI_FLOAT32_VEC4, &m_color);
   m_colorAttribute =
-      attributeFromString(getParamString("baseColor", "none"));
-  m_colorSampler = getParamObject<Sampler>("baseColor");
+      attributeFromString(getParamString(param::baseColor, "none"));
+  m_colorSampler = getParamObject<Sampler>(param::baseColor);
 
-  m_opacity = getParam<float>("opacity", 1.f);
-  m_opacityAttribute = attributeFromString(getParamString("opacity", "none"));
-  m_opacitySampler = getParamObject<Sampler>("opacity");
+  m_opacity = getParam<float>(param::opacity, 1.f);
+  m_opacityAttribute =
+      attributeFromString(getParamString(param::opacity, "none"));
+  m_opacitySampler = getParamObject<Sampler>(param::opacity);
 }
 
 } // namespace helide
@@ -2,9 +2,28 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "Renderer.h"
+// std
+#include <array>
+#include <random>
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom ambientColor("ambientColor");
+static const helium::StringAtom ambientRadiance("ambientRadiance");
+static const helium::StringAtom aoDistance("aoDistance");
+static const helium::StringAtom aoSamples("aoSamples");
+static const helium::StringAtom background("background");
+static const helium::StringAtom directLighting("directLighting");
+static const helium::StringAtom eyeLightBlendRatio("eyeLightBlendRatio");
+static const helium::StringAtom ignoreAmbientLighting("ignoreAmbientLighting");
+static const helium::StringAtom maxTransparencyDepth("maxTransparencyDepth");
+static const helium::StringAtom mode("mode");
+static const helium::StringAtom taskGrainSizeHeight("taskGrainSizeHeight");
+static const helium::StringAtom taskGrainSizeWidth("taskGrainSizeWidth");
+static const helium::StringAtom volumeSamplingRate("volumeSamplingRate");
+} // namespace param
+
 // Helper functions ///////////////////////////////////////////////////////////
 
 static RenderMode renderModeFromString(const std::string &name)
@@ -45,6 +64,8 @@ static RenderMode renderModeFromString(const std::string &name)
     return RenderMode::GEOMETRY_ATTRIBUTE_COLOR;
   else if (name == "opacityHeatmap")
     return RenderMode::OPACITY_HEATMAP;
+  else if (name == "ao")
+    return RenderMode::AMBIENT_OCCLUSION;
   else
     return RenderMode::DEFAULT;
 }
@@ -67,10 +88,7 @@ static float3 boolColor(bool pred)
 
 static float3 readAttributeValue(Attribute a, const Ray &r, const World &w)
 {
-  const Instance *inst = w.instances()[r.instID];
-  const Surface *surface = inst->group()->surfaces()[r.geomID];
-  const Geometry *geom = surface->geometry();
-  const auto v = geom->getAttributeValue(a, r);
+  const auto v = w.shadingRecordFromRay(r).geometry->getAttributeValue(a, r);
   return float3(v.x, v.y, v.z);
 }
 
@@ -90,6 +108,136 @@ static float4 backgroundColorFromImage(
   return linalg::lerp(v0, v1, interp_x.frac);
 }
 
+// Progressive 2D blue-noise point set, built once with Mitchell's
+// best-candidate algorithm on the unit torus: every prefix of the sequence is
+// itself well distributed, so consecutive frames can consume consecutive
+// chunks of it
+constexpr int BLUE_NOISE_SEQUENCE_SIZE = 64;
+
+static const std::array<float2, BLUE_NOISE_SEQUENCE_SIZE> &blueNoiseSequence()
+{
+  static const auto sequence = []() {
+    std::array<float2, BLUE_NOISE_SEQUENCE_SIZE> points;
+    std::minstd_rand rng(0x5eed);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+    auto toroidalDist2 = [](const float2 &a, const float2 &b) {
+      auto d = linalg::abs(a - b);
+      d = linalg::min(d, float2(1.f) - d);
+      return linalg::dot(d, d);
+    };
+
+    points[0] = float2(dist(rng), dist(rng));
+    for (int i = 1; i < BLUE_NOISE_SEQUENCE_SIZE; i++) {
+      float bestDist2 = -1.f;
+      for (int c = 0; c < 8 * i; c++) {
+        const float2 candidate(dist(rng), dist(rng));
+        float minDist2 = std::numeric_limits<float>::max();
+        for (int j = 0; j < i; j++)
+          minDist2 = std::min(minDist2, toroidalDist2(candidate, points[j]));
+        if (minDist2 > bestDist2) {
+          bestDist2 = minDist2;
+          points[i] = candidate;
+        }
+      }
+    }
+    return points;
+  }();
+  return sequence;
+}
+
+// Per-pixel blue-noise-like offset (interleaved gradient noise) used to
+// decorrelate the shared sequence between neighboring pixels
+static float interleavedGradientNoise(float x, float y)
+{
+  const float f = 0.06711056f * x + 0.00583715f * y;
+  const float g = 52.9829189f * (f - std::floor(f));
+  return g - std::floor(g);
+}
+
+static float3 cosineSampleHemisphere(const float3 &N, const float2 &u)
+{
+  const float r = std::sqrt(u.x);
+  const float phi = 2.f * float(M_PI) * u.y;
+  const float3 T = std::abs(N.x) > 0.9f
+      ? linalg::normalize(linalg::cross(float3(0.f, 1.f, 0.f), N))
+      : linalg::normalize(linalg::cross(float3(1.f, 0.f, 0.f), N));
+  const float3 B = linalg::cross(N, T);
+  return r * std::cos(phi) * T + r * std::sin(phi) * B
+      + std::sqrt(std::max(0.f, 1.f - u.x)) * N;
+}
+
+// Composite the part of 'vray' within [t0, t1) behind what was accumulated
+// so far
+static void renderVolumeSegment(const VolumeRay &vray,
+    float t0,
+    float t1,
+    float invSamplingRate,
+    float3 &color,
+    float &opacity)
+{
+  VolumeRay segment = vray;
+  segment.t.lower = std::max(t0, vray.t.lower);
+  segment.t.upper = std::min(t1, vray.t.upper);
+  if (segment.t.lower >= segment.t.upper)
+    return;
+
+  float3 segmentColor(0.f);
+  float segmentOpacity = 0.f;
+  segment.volume->render(
+      segment, invSamplingRate, segmentColor, segmentOpacity);
+  accumulateValue(color, segmentColor, opacity);
+  accumulateValue(opacity, segmentOpacity, opacity);
+}
+
+// Trace up to 4 occlusion rays as a single packet, setting 'occluded[i]' for
+// each active lane which hits something before 'tfars[i]'
+static void traceOcclusionRays(const World &w,
+    const float3 &org,
+    const float3 *dirs,
+    const float *tfars,
+    int count,
+    bool *occluded)
+{
+  RTCOccludedArguments oargs;
+  WorldRayQueryContext ctx;
+  w.initOccludedArguments(oargs, ctx);
+
+  if (count == 1) {
+    Ray ray;
+    ray.org = org;
+    ray.dir = dirs[0];
+    ray.tfar = tfars[0];
+    rtcOccluded1(w.embreeScene(), (RTCRay *)&ray, &oargs);
+    occluded[0] = ray.tfar < 0.f;
+    return;
+  }
+
+  alignas(16) int valid[4] = {0, 0, 0, 0};
+  alignas(16) RTCRay4 rays;
+  for (int i = 0; i < 4; i++) {
+    const bool active = i < count;
+    valid[i] = active ? -1 : 0;
+    rays.org_x[i] = org.x;
+    rays.org_y[i] = org.y;
+    rays.org_z[i] = org.z;
+    rays.tnear[i] = 0.f;
+    rays.dir_x[i] = active ? dirs[i].x : 0.f;
+    rays.dir_y[i] = active ? dirs[i].y : 0.f;
+    rays.dir_z[i] = active ? dirs[i].z : 1.f;
+    rays.time[i] = 0.f;
+    rays.tfar[i] = active ? tfars[i] : 0.f;
+    rays.mask[i] = ~0u;
+    rays.id[i] = i;
+    rays.flags[i] = 0;
+  }
+
+  rtcOccluded4(valid, w.embreeScene(), &rays, &oargs);
+
+  for (int i = 0; i < count; i++)
+    occluded[i] = rays.tfar[i] < 0.f;
+}
+
 // Renderer definitions ///////////////////////////////////////////////////////
 
 Renderer::Renderer(HelideGlobalState *s) : Object(ANARI_RENDERER, s)
@@ -97,7 +245,7 @@ Renderer::Renderer(HelideGlobalState *s) : Object(ANARI_RENDERER, s)
   Array1DMemoryDescriptor md;
   md.elementType = ANARI_FLOAT32_VEC3;
   md.numItems = 4;
-  m_heatmap = new Array1D(s, md);
+  m_heatmap = new (s) Array1D(s, md);
   m_heatmap->refDec(helium::RefType::PUBLIC);
 
   auto *colors = (float3 *)m_heatmap->map();
@@ -110,31 +258,67 @@ Renderer::Renderer(HelideGlobalState *s) : Object(ANARI_RENDERER, s)
 
 void Renderer::commitParameters()
 {
-  m_bgColor = getParam<float4>("background", float4(float3(0.f), 1.f));
-  m_bgImage = getParamObject<Array2D>("background");
-  m_ambientRadiance = getParam<float>("ambientRadiance", 1.f);
-  m_falloffBlendRatio = getParam<float>("eyeLightBlendRatio", 0.5f);
-  m_invVolumeSR = 1.f / getParam<float>("volumeSamplingRate", 1.f);
-  m_mode = renderModeFromString(getParamString("mode", "default"));
-  m_taskGrainSize.x = getParam<int32_t>("taskGrainSizeWidth", 4);
-  m_taskGrainSize.y = getParam<int32_t>("taskGrainSizeHeight", 4);
-
-  bool ignoreAmbientLighting = getParam<bool>("ignoreAmbientLighting", true);
-  if (ignoreAmbientLighting)
+  m_bgColor = getParam<float4>(param::background, float4(float3(0.f), 1.f));
+  m_bgImage = getParamObject<Array2D>(param::background);
+  m_ambientRadiance = getParam<float>(param::ambientRadiance, 1.f);
+  m_ambientColor = getParam<float3>(param::ambientColor, float3(1.f));
+  m_falloffBlendRatio = getParam<float>(param::eyeLightBlendRatio, 0.5f);
+  m_invVolumeSR = 1.f / getParam<float>(param::volumeSamplingRate, 1.f);
+  m_mode = renderModeFromString(getParamString(param::mode, "default"));
+  m_taskGrainSize.x = getParam<int32_t>(param::taskGrainSizeWidth, 4);
+  m_taskGrainSize.y = getParam<int32_t>(param::taskGrainSizeHeight, 4);
+  m_maxTransparencyDepth =
+      std::clamp(getParam<int32_t>(param::maxTransparencyDepth, 8),
+          0,
+          MAX_TRANSPARENT_HITS);
+  m_aoSamples = std::clamp(
+      getParam<int32_t>(param::aoSamples, 1), 1, BLUE_NOISE_SEQUENCE_SIZE);
+  m_aoDistance = getParam<float>(param::aoDistance, 1e20f);
+
+  m_directLighting = getParam<bool>(param::directLighting, false);
+
+  m_ignoreAmbientLighting = getParam<bool>(param::ignoreAmbientLighting, true);
+  if (m_ignoreAmbientLighting)
     m_ambientRadiance = 1.f;
 }
 
-PixelSample Renderer::renderSample(
-    const float2 &screen, Ray ray, const World &w) const
+uint32_t Renderer::accumulationFrames() const
+{
+  if (m_mode != RenderMode::AMBIENT_OCCLUSION)
+    return 1;
+  return (BLUE_NOISE_SEQUENCE_SIZE + m_aoSamples - 1) / m_aoSamples;
+}
+
+PixelSample Renderer::renderSample(const float2 &screen,
+    Ray ray,
+    const World &w,
+    const uint2 &pixel,
+    int frameID) const
 {
   PixelSample retval;
 
   // Intersect Surfaces //
 
+  // Translucent layers are only composited by the shaded modes
+  TransparentHitList layers;
+  const bool collectLayers = m_maxTransparencyDepth > 0
+      && (m_mode == RenderMode::DEFAULT
+          || m_mode == RenderMode::AMBIENT_OCCLUSION);
+
   RTCIntersectArguments iargs;
-  rtcInitIntersectArguments(&iargs);
+  WorldRayQueryContext ctx;
+  w.initIntersectArguments(iargs, ctx);
+  if (collectLayers) {
+    layers.capacity = m_maxTransparencyDepth;
+    ctx.transparentHits = &layers;
+  }
   rtcIntersect1(w.embreeScene(), (RTCRayHit *)&ray, &iargs);
 
+  // Layers gathered before traversal found the closest opaque hit may lie
+  // behind it
+  while (layers.count > 0 && layers.hits[layers.count - 1].tfar >= ray.tfar)
+    layers.count--;
+
   // Intersect Volumes //
 
   VolumeRay vray;
@@ -145,7 +329,7 @@ PixelSample Renderer::renderSample(
 
   // Shade //
 
-  shadeRay(retval, screen, ray, vray, w);
+  shadeRay(retval, screen, ray, vray, layers, w, pixel, frameID);
 
   return retval;
 }
@@ -153,38 +337,163 @@ PixelSample Renderer::renderSample(
 Renderer *Renderer::createInstance(
     std::string_view /* subtype */, HelideGlobalState *s)
 {
-  return new Renderer(s);
+  return new (s) Renderer(s);
+}
+
+float3 Renderer::computeDirectLighting(
+    const float3 &P, const float3 &N, const World &w) const
+{
+  float3 irradiance = m_ignoreAmbientLighting
+      ? float3(0.f)
+      : m_ambientColor * m_ambientRadiance;
+
+  // Shadow rays are gathered across lights and traced in packets of 4
+  constexpr int PACKET_SIZE = 4;
+  float3 dirs[PACKET_SIZE];
+  float dists[PACKET_SIZE];
+  float3 contributions[PACKET_SIZE];
+  bool occluded[PACKET_SIZE];
+  int count = 0;
+
+  auto flush = [&]() {
+    if (count == 0)
+      return;
+    traceOcclusionRays(w, P, dirs, dists, count, occluded);
+    for (int i = 0; i < count; i++) {
+      if (!occluded[i])
+        irradiance += contributions[i];
+    }
+    count = 0;
+  };
+
+  for (const auto &li : w.lights()) {
+    const LightSample ls = li.light->sample(P, li.xfm);
+    const float c = linalg::dot(N, ls.dir);
+    if (c <= 0.f || ls.dist <= 0.f || ls.irradiance == float3(0.f))
+      continue;
+    dirs[count] = ls.dir;
+    dists[count] = ls.dist;
+    contributions[count] = ls.irradiance * c;
+    if (++count == PACKET_SIZE)
+      flush();
+  }
+  flush();
+
+  return irradiance;
+}
+
+float Renderer::computeAmbientOcclusion(const float3 &P,
+    const float3 &N,
+    const World &w,
+    const uint2 &pixel,
+    int frameID) const
+{
+  const auto &sequence = blueNoiseSequence();
+  const float2 offset(interleavedGradientNoise(pixel.x, pixel.y),
+      interleavedGradientNoise(pixel.x + 47.f, pixel.y + 17.f));
+
+  // Each frame rotates to the next chunk of the sequence so that accumulated
+  // frames together cover all of it
+  const int first = (frameID * m_aoSamples) % BLUE_NOISE_SEQUENCE_SIZE;
+
+  constexpr int PACKET_SIZE = 4;
+  float3 dirs[PACKET_SIZE];
+  float tfars[PACKET_SIZE];
+  bool occluded[PACKET_SIZE];
+
+  int numOccluded = 0;
+  for (int s = 0; s < m_aoSamples; s += PACKET_SIZE) {
+    const int count = std::min(PACKET_SIZE, m_aoSamples - s);
+    for (int i = 0; i < count; i++) {
+      auto u = sequence[(first + s + i) % BLUE_NOISE_SEQUENCE_SIZE] + offset;
+      u -= linalg::floor(u);
+      dirs[i] = cosineSampleHemisphere(N, u);
+      tfars[i] = m_aoDistance;
+    }
+    traceOcclusionRays(w, P, dirs, tfars, count, occluded);
+    for (int i = 0; i < count; i++)
+      numOccluded += occluded[i];
+  }
+
+  return 1.f - float(numOccluded) / m_aoSamples;
+}
+
+float3 Renderer::shadeSurface(const Ray &ray,
+    const SurfaceShadingRecord &sr,
+    const World &w,
+    const uint2 &pixel,
+    int frameID) const
+{
+  const Instance *inst = sr.instance;
+
+  const auto n = linalg::mul(inst->xfmInvRot(ray.instArrayID), ray.Ng);
+  const auto falloff = std::abs(linalg::dot(-ray.dir, linalg::normalize(n)));
+  const float4 c = evaluateSurfaceColor(
+      sr, ray, inst->getUniformAttributes(ray.instArrayID));
+
+  auto N = linalg::normalize(n);
+  if (linalg::dot(N, ray.dir) > 0.f)
+    N = -N;
+  const float3 P = ray.org + ray.tfar * ray.dir;
+  const float3 secondaryOrg = P + N * (1e-4f * std::max(1.f, ray.tfar));
+
+  if (m_mode == RenderMode::AMBIENT_OCCLUSION) {
+    const float ao =
+        computeAmbientOcclusion(secondaryOrg, N, w, pixel, frameID);
+    return float3(c.x, c.y, c.z) * ao * m_ambientRadiance;
+  } else if (m_directLighting) {
+    return float3(c.x, c.y, c.z) * computeDirectLighting(secondaryOrg, N, w);
+  } else {
+    const float3 sc = float3(c.x, c.y, c.z) * std::clamp(falloff, 0.f, 1.f);
+    return ((m_falloffBlendRatio * sc)
+               + ((1.f - m_falloffBlendRatio) * float3(c.x, c.y, c.z)))
+        * m_ambientRadiance;
+  }
 }
 
 void Renderer::shadeRay(PixelSample &retval,
     const float2 &screen,
     const Ray &ray,
     const VolumeRay &vray,
-    const World &w) const
+    const TransparentHitList &layers,
+    const World &w,
+    const uint2 &pixel,
+    int frameID) const
 {
   const bool hitGeometry = ray.geomID != RTC_INVALID_GEOMETRY_ID;
   const bool hitVolume = vray.volume != nullptr;
+  const bool hitLayers = layers.count > 0;
 
   const float4 bgColorOpacity =
       m_bgImage ? backgroundColorFromImage(*m_bgImage, screen) : m_bgColor;
 
+  // The nearest translucent layer, if any, is what ids and depth refer to
+  const Ray &firstHit = hitLayers ? layers.hits[0] : ray;
+
   // Write depth //
 
-  retval.depth = hitVolume ? std::min(ray.tfar, vray.t.lower) : ray.tfar;
+  retval.depth =
+      hitVolume ? std::min(firstHit.tfar, vray.t.lower) : firstHit.tfar;
 
-  if (!hitGeometry && !hitVolume) {
+  if (!hitGeometry && !hitVolume && !hitLayers) {
     retval.color = bgColorOpacity;
     return;
   }
 
+  const SurfaceShadingRecord *sr =
+      hitGeometry ? &w.shadingRecordFromRay(ray) : nullptr;
+
   // Write ids //
 
-  if (hitGeometry || hitVolume) {
-    retval.primId =
-        hitVolume ? 0 : w.surfaceFromRay(ray)->geometry()->getPrimID(ray);
-    retval.objId = hitVolume ? vray.volume->id() : w.surfaceFromRay(ray)->id();
-    retval.instId = hitVolume ? w.instanceFromRay(vray)->id(vray.instArrayID)
-                              : w.instanceFromRay(ray)->id(ray.instArrayID);
+  if (hitVolume) {
+    retval.primId = 0;
+    retval.objId = vray.volume->id();
+    retval.instId = w.instanceFromRay(vray)->id(vray.instArrayID);
+  } else {
+    const auto &fsr = w.shadingRecordFromRay(firstHit);
+    retval.primId = fsr.geometry->getPrimID(firstHit);
+    retval.objId = fsr.surfaceID;
+    retval.instId = fsr.instance->id(firstHit.instArrayID);
   }
 
   // Write color //
@@ -263,41 +572,48 @@ void Renderer::shadeRay(PixelSample &retval,
     break;
   case RenderMode::OPACITY_HEATMAP: {
     if (hitGeometry) {
-      const Instance *inst = w.instanceFromRay(ray);
-      const Surface *surface = w.surfaceFromRay(ray);
+      const Instance *inst = sr->instance;
 
       const auto n = linalg::mul(inst->xfmInvRot(), ray.Ng);
       const auto falloff =
           std::abs(linalg::dot(-ray.dir, linalg::normalize(n)));
-      const float4 sc = surface->getSurfaceColor(
-          ray, inst->getUniformAttributes(ray.instArrayID));
-      const float so = surface->getSurfaceOpacity(
-          ray, inst->getUniformAttributes(ray.instArrayID));
-      const float o = surface->adjustedAlpha(std::clamp(sc.w * so, 0.f, 1.f));
+      const auto instAttrV = inst->getUniformAttributes(ray.instArrayID);
+      const float4 sc = evaluateSurfaceColor(*sr, ray, instAttrV);
+      const float so = evaluateSurfaceOpacity(*sr, ray, instAttrV);
+      const float o = adjustedAlpha(*sr, std::clamp(sc.w * so, 0.f, 1.f));
       const float3 c = m_heatmap->valueAtLinear<float3>(o);
       const float3 fc = c * falloff;
       geometryColor = (0.8f * fc + 0.2f * c) * m_ambientRadiance;
     }
   } break;
+  case RenderMode::AMBIENT_OCCLUSION:
   case RenderMode::DEFAULT:
   default: {
-    if (hitGeometry) {
-      const Instance *inst = w.instanceFromRay(ray);
-      const Surface *surface = w.surfaceFromRay(ray);
-
-      const auto n = linalg::mul(inst->xfmInvRot(ray.instArrayID), ray.Ng);
-      const auto falloff =
-          std::abs(linalg::dot(-ray.dir, linalg::normalize(n)));
-      const float4 c = surface->getSurfaceColor(
-          ray, inst->getUniformAttributes(ray.instArrayID));
-      const float3 sc = float3(c.x, c.y, c.z) * std::clamp(falloff, 0.f, 1.f);
-      geometryColor =
-          ((m_falloffBlendRatio * sc)
-              + ((1.f - m_falloffBlendRatio) * float3(c.x, c.y, c.z)))
-          * m_ambientRadiance;
-    }
-
-    if (hitVolume)
+    if (hitGeometry)
+      geometryColor = shadeSurface(ray, *sr, w, pixel, frameID);
+
+    if (hitLayers) {
+      // Composite translucent layers front-to-back, interleaved with the
+      // volume segments in front of each of them
+      float t = vray.t.lower;
+      for (int i = 0; i < layers.count; i++) {
+        const Ray &layer = layers.hits[i];
+        if (hitVolume) {
+          renderVolumeSegment(
+              vray, t, layer.tfar, m_invVolumeSR, volumeColor, volumeOpacity);
+          t = std::max(t, layer.tfar);
+        }
+        const auto &lsr = w.shadingRecordFromRay(layer);
+        const float3 lc = linalg::min(
+            shadeSurface(layer, lsr, w, pixel, frameID), float3(1.f));
+        accumulateValue(volumeColor, lc * layers.alpha[i], volumeOpacity);
+        accumulateValue(volumeOpacity, layers.alpha[i], volumeOpacity);
+      }
+      if (hitVolume) {
+        renderVolumeSegment(
+            vray, t, vray.t.upper, m_invVolumeSR, volumeColor, volumeOpacity);
+      }
+    } else if (hitVolume)
       vray.volume->render(vray, m_invVolumeSR, volumeColor, volumeOpacity);
 
   } break;
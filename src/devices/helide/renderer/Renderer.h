@@ -42,7 +42,8 @@ enum class RenderMode
   GEOMETRY_ATTRIBUTE_2,
   GEOMETRY_ATTRIBUTE_3,
   GEOMETRY_ATTRIBUTE_COLOR,
-  OPACITY_HEATMAP
+  OPACITY_HEATMAP,
+  AMBIENT_OCCLUSION
 };
 
 struct Renderer : public Object
@@ -54,7 +55,15 @@ struct Renderer : public Object
 
   int2 taskGrainSize() const;
 
-  PixelSample renderSample(const float2 &screen, Ray ray, const World &w) const;
+  // Number of frames over which samples are amortized when the scene does not
+  // change; 1 means the renderer produces its final image in a single frame
+  uint32_t accumulationFrames() const;
+
+  PixelSample renderSample(const float2 &screen,
+      Ray ray,
+      const World &w,
+      const uint2 &pixel,
+      int frameID) const;
 
   static Renderer *createInstance(
       std::string_view subtype, HelideGlobalState *d);
@@ -64,14 +73,35 @@ struct Renderer : public Object
       const float2 &screen,
       const Ray &ray,
       const VolumeRay &vray,
-      const World &w) const;
+      const TransparentHitList &layers,
+      const World &w,
+      const uint2 &pixel,
+      int frameID) const;
+  float3 shadeSurface(const Ray &ray,
+      const SurfaceShadingRecord &sr,
+      const World &w,
+      const uint2 &pixel,
+      int frameID) const;
+  float3 computeDirectLighting(
+      const float3 &P, const float3 &N, const World &w) const;
+  float computeAmbientOcclusion(const float3 &P,
+      const float3 &N,
+      const World &w,
+      const uint2 &pixel,
+      int frameID) const;
 
   float4 m_bgColor{float3(0.f), 1.f};
   float m_ambientRadiance{1.f};
+  float3 m_ambientColor{1.f};
+  bool m_ignoreAmbientLighting{true};
+  bool m_directLighting{false};
   float m_falloffBlendRatio{0.5f};
   float m_invVolumeSR{1.f};
   RenderMode m_mode{RenderMode::DEFAULT};
   int2 m_taskGrainSize{4, 4};
+  int m_maxTransparencyDepth{8};
+  int m_aoSamples{1};
+  float m_aoDistance{1e20f};
 
   helium::IntrusivePtr<Array1D> m_heatmap;
   helium::IntrusivePtr<Array2D> m_bgImage;
@@ -6,6 +6,17 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom filter("filter");
+static const helium::StringAtom image("image");
+static const helium::StringAtom inAttribute("inAttribute");
+static const helium::StringAtom inOffset("inOffset");
+static const helium::StringAtom inTransform("inTransform");
+static const helium::StringAtom outOffset("outOffset");
+static const helium::StringAtom outTransform("outTransform");
+static const helium::StringAtom wrapMode("wrapMode");
+} // namespace param
+
 Image1D::Image1D(HelideGlobalState *s) : Sampler(s) {}
 
 bool Image1D::isValid() const
@@ -16,15 +27,16 @@ bool Image1D::isValid() const
 void Image1D::commitParameters()
 {
   Sampler::commitParameters();
-  m_image = getParamObject<Array1D>("image");
+  m_image = getParamObject<Array1D>(param::image);
   m_inAttribute =
-      attributeFromString(getParamString("inAttribute", "attribute0"));
-  m_linearFilter = getParamString("filter", "linear") != "nearest";
-  m_wrapMode = wrapModeFromString(getParamString("wrapMode", "clampToEdge"));
-  m_inTransform = getParam<mat4>("inTransform", mat4(linalg::identity));
-  m_inOffset = getParam<float4>("inOffset", float4(0.f, 0.f, 0.f, 0.f));
-  m_outTransform = getParam<mat4>("outTransform", mat4(linalg::identity));
-  m_outOffset = getParam<float4>("outOffset", float4(0.f, 0.f, 0.f, 0.f));
+      attributeFromString(getParamString(param::inAttribute, "attribute0"));
+  m_linearFilter = getParamString(param::filter, "linear") != "nearest";
+  m_wrapMode =
+      wrapModeFromString(getParamString(param::wrapMode, "clampToEdge"));
+  m_inTransform = getParam<mat4>(param::inTransform, mat4(linalg::identity));
+  m_inOffset = getParam<float4>(param::inOffset, float4(0.f, 0.f, 0.f, 0.f));
+  m_outTransform = getParam<mat4>(param::outTransform, mat4(linalg::identity));
+  m_outOffset = getParam<float4>(param::outOffset, float4(0.f, 0.f, 0.f, 0.f));
 }
 
 float4 Image1D::getSample(
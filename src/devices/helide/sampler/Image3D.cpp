@@ -6,6 +6,17 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom filter("filter");
+static const helium::StringAtom image("image");
+static const helium::StringAtom inAttribute("inAttribute");
+static const helium::StringAtom inTransform("inTransform");
+static const helium::StringAtom outTransform("outTransform");
+static const helium::StringAtom wrapMode1("wrapMode1");
+static const helium::StringAtom wrapMode2("wrapMode2");
+static const helium::StringAtom wrapMode3("wrapMode3");
+} // namespace param
+
 Image3D::Image3D(HelideGlobalState *s) : Sampler(s) {}
 
 bool Image3D::isValid() const
@@ -16,15 +27,18 @@ bool Image3D::isValid() const
 void Image3D::commitParameters()
 {
   Sampler::commitParameters();
-  m_image = getParamObject<Array3D>("image");
+  m_image = getParamObject<Array3D>(param::image);
   m_inAttribute =
-      attributeFromString(getParamString("inAttribute", "attribute0"));
-  m_linearFilter = getParamString("filter", "linear") != "nearest";
-  m_wrapMode1 = wrapModeFromString(getParamString("wrapMode1", "clampToEdge"));
-  m_wrapMode2 = wrapModeFromString(getParamString("wrapMode2", "clampToEdge"));
-  m_wrapMode3 = wrapModeFromString(getParamString("wrapMode3", "clampToEdge"));
-  m_inTransform = getParam<mat4>("inTransform", mat4(linalg::identity));
-  m_outTransform = getParam<mat4>("outTransform", mat4(linalg::identity));
+      attributeFromString(getParamString(param::inAttribute, "attribute0"));
+  m_linearFilter = getParamString(param::filter, "linear") != "nearest";
+  m_wrapMode1 =
+      wrapModeFromString(getParamString(param::wrapMode1, "clampToEdge"));
+  m_wrapMode2 =
+      wrapModeFromString(getParamString(param::wrapMode2, "clampToEdge"));
+  m_wrapMode3 =
+      wrapModeFromString(getParamString(param::wrapMode3, "clampToEdge"));
+  m_inTransform = getParam<mat4>(param::inTransform, mat4(linalg::identity));
+  m_outTransform = getParam<mat4>(param::outTransform, mat4(linalg::identity));
 }
 
 float4 Image3D::getSample(
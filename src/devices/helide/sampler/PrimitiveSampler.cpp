@@ -6,6 +6,11 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom array("array");
+static const helium::StringAtom offset("offset");
+} // namespace param
+
 PrimitiveSampler::PrimitiveSampler(HelideGlobalState *s) : Sampler(s) {}
 
 bool PrimitiveSampler::isValid() const
@@ -16,9 +21,9 @@ bool PrimitiveSampler::isValid() const
 void PrimitiveSampler::commitParameters()
 {
   Sampler::commitParameters();
-  m_array = getParamObject<Array1D>("array");
-  m_offset =
-      uint32_t(getParam<uint64_t>("offset", getParam<uint32_t>("offset", 0)));
+  m_array = getParamObject<Array1D>(param::array);
+  m_offset = uint32_t(
+      getParam<uint64_t>(param::offset, getParam<uint32_t>(param::offset, 0)));
 }
 
 float4 PrimitiveSampler::getSample(const Geometry &g,
@@ -16,17 +16,17 @@ Sampler::Sampler(HelideGlobalState *s) : Object(ANARI_SAMPLER, s) {}
 Sampler *Sampler::createInstance(std::string_view subtype, HelideGlobalState *s)
 {
   if (subtype == "image1D")
-    return new Image1D(s);
+    return new (s) Image1D(s);
   else if (subtype == "image2D")
-    return new Image2D(s);
+    return new (s) Image2D(s);
   else if (subtype == "image3D")
-    return new Image3D(s);
+    return new (s) Image3D(s);
   else if (subtype == "transform")
-    return new TransformSampler(s);
+    return new (s) TransformSampler(s);
   else if (subtype == "primitive")
-    return new PrimitiveSampler(s);
+    return new (s) PrimitiveSampler(s);
   else
-    return (Sampler *)new UnknownObject(ANARI_SAMPLER, s);
+    return (Sampler *)new (s) UnknownObject(ANARI_SAMPLER, s);
 }
 
 } // namespace helide
@@ -6,6 +6,11 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom inAttribute("inAttribute");
+static const helium::StringAtom transform("transform");
+} // namespace param
+
 TransformSampler::TransformSampler(HelideGlobalState *s) : Sampler(s) {}
 
 bool TransformSampler::isValid() const
@@ -17,8 +22,8 @@ void TransformSampler::commitParameters()
 {
   Sampler::commitParameters();
   m_inAttribute =
-      attributeFromString(getParamString("inAttribute", "attribute0"));
-  m_transform = getParam<mat4>("transform", mat4(linalg::identity));
+      attributeFromString(getParamString(param::inAttribute, "attribute0"));
+  m_transform = getParam<mat4>(param::transform, mat4(linalg::identity));
 }
 
 float4 TransformSampler::getSample(
@@ -15,9 +15,9 @@ SpatialField *SpatialField::createInstance(
     std::string_view subtype, HelideGlobalState *s)
 {
   if (subtype == "structuredRegular")
-    return new StructuredRegularField(s);
+    return new (s) StructuredRegularField(s);
   else
-    return (SpatialField *)new UnknownObject(ANARI_SPATIAL_FIELD, s);
+    return (SpatialField *)new (s) UnknownObject(ANARI_SPATIAL_FIELD, s);
 }
 
 void SpatialField::setStepSize(float size)
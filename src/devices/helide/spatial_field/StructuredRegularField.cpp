@@ -7,15 +7,21 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom data("data");
+static const helium::StringAtom origin("origin");
+static const helium::StringAtom spacing("spacing");
+} // namespace param
+
 StructuredRegularField::StructuredRegularField(HelideGlobalState *d)
     : SpatialField(d)
 {}
 
 void StructuredRegularField::commitParameters()
 {
-  m_dataArray = getParamObject<Array3D>("data");
-  m_origin = getParam<float3>("origin", float3(0.f));
-  m_spacing = getParam<float3>("spacing", float3(1.f));
+  m_dataArray = getParamObject<Array3D>(param::data);
+  m_origin = getParam<float3>(param::origin, float3(0.f));
+  m_spacing = getParam<float3>(param::spacing, float3(1.f));
 }
 
 void StructuredRegularField::finalize()
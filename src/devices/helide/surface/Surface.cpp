@@ -6,13 +6,22 @@
 
 namespace helide {
 
-Surface::Surface(HelideGlobalState *s) : Object(ANARI_SURFACE, s) {}
+namespace param {
+static const helium::StringAtom geometry("geometry");
+static const helium::StringAtom id("id");
+static const helium::StringAtom material("material");
+} // namespace param
+
+Surface::Surface(HelideGlobalState *s)
+    : Object(ANARI_SURFACE, s),
+      m_geometry(this, helium::ObserverMode::DIRTY_FLAGS)
+{}
 
 void Surface::commitParameters()
 {
-  m_id = getParam<uint32_t>("id", ~0u);
-  m_geometry = getParamObject<Geometry>("geometry");
-  m_material = getParamObject<Material>("material");
+  m_id = getParam<uint32_t>(param::id, ~0u);
+  m_geometry = getParamObject<Geometry>(param::geometry);
+  m_material = getParamObject<Material>(param::material);
 }
 
 void Surface::finalize()
@@ -27,8 +36,12 @@ void Surface::finalize()
 void Surface::markFinalized()
 {
   Object::markFinalized();
-  deviceState()->objectUpdates.lastBLSReconstructSceneRequest =
-      helium::newTimeStamp();
+  markDirty(DIRTY_BLS_RECONSTRUCT);
+}
+
+void Surface::on_DependencyDirty(helium::BaseObject *, uint32_t flags)
+{
+  markDirty(flags);
 }
 
 bool Surface::isValid() const
@@ -45,7 +58,7 @@ bool Surface::isValid() const
 
 const Geometry *Surface::geometry() const
 {
-  return m_geometry.ptr;
+  return m_geometry.get();
 }
 
 const Material *Surface::material() const
@@ -56,59 +69,128 @@ const Material *Surface::material() const
 float4 Surface::getSurfaceColor(
     const Ray &ray, const UniformAttributeSet &instAttrV) const
 {
-  const auto &state = *deviceState();
-  const auto &imc = state.invalidMaterialColor;
+  return evaluateSurfaceColor(makeShadingRecord(), ray, instAttrV);
+}
+
+float Surface::getSurfaceOpacity(
+    const Ray &ray, const UniformAttributeSet &instAttrV) const
+{
+  return evaluateSurfaceOpacity(makeShadingRecord(), ray, instAttrV);
+}
+
+SurfaceShadingRecord Surface::makeShadingRecord(const Instance *inst) const
+{
+  SurfaceShadingRecord sr;
+  sr.instance = inst;
+  sr.surface = this;
+  sr.geometry = geometry();
+  sr.surfaceID = id();
 
   const auto *mat = material();
 
-  if (!mat)
-    return float4(imc.x, imc.y, imc.z, 1.f);
+  if (!mat) {
+    const auto &imc = deviceState()->invalidMaterialColor;
+    sr.color.source = ShadingSource::INVALID_MATERIAL;
+    sr.color.value = float4(imc.x, imc.y, imc.z, 1.f);
+    sr.opacity.source = ShadingSource::INVALID_MATERIAL;
+    sr.opacity.value = float4(0.f);
+    return sr;
+  }
+
+  sr.hasMaterial = true;
+  sr.alphaMode = mat->alphaMode();
+  sr.alphaCutoff = mat->alphaCutoff();
 
-  const auto colorAttribute = mat->colorAttribute();
   const auto *colorSampler = mat->colorSampler();
+  const auto colorAttribute = mat->colorAttribute();
+  sr.color.attribute = colorAttribute;
+  sr.color.value = mat->color();
+  if (colorSampler && colorSampler->isValid()) {
+    sr.color.source = ShadingSource::SAMPLER;
+    sr.color.sampler = colorSampler;
+  } else if (colorAttribute == Attribute::WORLD_POSITION
+      || colorAttribute == Attribute::WORLD_NORMAL
+      || colorAttribute == Attribute::OBJECT_POSITION
+      || colorAttribute == Attribute::OBJECT_NORMAL) {
+    sr.color.source = ShadingSource::RAY;
+  } else if (colorAttribute == Attribute::NONE)
+    sr.color.source = ShadingSource::CONSTANT;
+  else
+    sr.color.source = ShadingSource::ATTRIBUTE;
 
-  if (colorSampler && colorSampler->isValid())
-    return colorSampler->getSample(*geometry(), ray, instAttrV);
-  else if (colorAttribute == Attribute::WORLD_POSITION)
-    return float4(ray.org + ray.dir * ray.tfar, 1.f);
-  else if (colorAttribute == Attribute::WORLD_NORMAL)
-    return float4(normalize(ray.Ng), 1.f);
-  else if (colorAttribute == Attribute::OBJECT_POSITION)
-    return float4(
-        ray.org + ray.dir * ray.tfar, 1.f); // TODO: transform to object space
-  else if (colorAttribute == Attribute::OBJECT_NORMAL)
-    return float4(normalize(ray.Ng), 1.f); // TODO: transform to object space
-  else if (colorAttribute == Attribute::NONE)
-    return mat->color();
-  else if (const auto &ia = getUniformAttribute(instAttrV, colorAttribute); ia)
-    return *ia;
+  const auto *opacitySampler = mat->opacitySampler();
+  const auto opacityAttribute = mat->opacityAttribute();
+  sr.opacity.attribute = opacityAttribute;
+  sr.opacity.value = float4(mat->opacity());
+  if (opacitySampler && opacitySampler->isValid()) {
+    sr.opacity.source = ShadingSource::SAMPLER;
+    sr.opacity.sampler = opacitySampler;
+  } else if (opacityAttribute == Attribute::NONE)
+    sr.opacity.source = ShadingSource::CONSTANT;
   else
-    return geometry()->getAttributeValue(colorAttribute, ray);
+    sr.opacity.source = ShadingSource::ATTRIBUTE;
+
+  if (sr.alphaMode != AlphaMode::OPAQUE) {
+    if (sr.color.source == ShadingSource::CONSTANT
+        && sr.opacity.source == ShadingSource::CONSTANT) {
+      sr.constantAlpha = helide::adjustedAlpha(
+          sr, std::clamp(sr.color.value.w * sr.opacity.value.x, 0.f, 1.f));
+    }
+    const bool opaque = sr.constantAlpha >= 1.f;
+    sr.alphaTest = sr.alphaMode == AlphaMode::MASK && !opaque;
+    sr.blend = sr.alphaMode == AlphaMode::BLEND && !opaque;
+  }
+
+  return sr;
 }
 
-float Surface::getSurfaceOpacity(
-    const Ray &ray, const UniformAttributeSet &instAttrV) const
+// Shading record evaluation //////////////////////////////////////////////////
+
+static float4 evaluateShadingInput(const SurfaceShadingRecord::Input &in,
+    const Geometry &geom,
+    const Ray &ray,
+    const UniformAttributeSet &instAttrV)
 {
-  auto &state = *deviceState();
-  auto &imc = state.invalidMaterialColor;
+  switch (in.source) {
+  case ShadingSource::SAMPLER:
+    return in.sampler->getSample(geom, ray, instAttrV);
+  case ShadingSource::RAY:
+    return *getRayAttribute(in.attribute, ray);
+  case ShadingSource::ATTRIBUTE:
+    if (const auto &ia = getUniformAttribute(instAttrV, in.attribute); ia)
+      return *ia;
+    return geom.getAttributeValue(in.attribute, ray);
+  case ShadingSource::CONSTANT:
+  case ShadingSource::INVALID_MATERIAL:
+  default:
+    return in.value;
+  }
+}
 
-  auto *mat = material();
+float4 evaluateSurfaceColor(const SurfaceShadingRecord &sr,
+    const Ray &ray,
+    const UniformAttributeSet &instAttrV)
+{
+  return evaluateShadingInput(sr.color, *sr.geometry, ray, instAttrV);
+}
 
-  if (!mat)
-    return 0.f;
+float evaluateSurfaceOpacity(const SurfaceShadingRecord &sr,
+    const Ray &ray,
+    const UniformAttributeSet &instAttrV)
+{
+  return evaluateShadingInput(sr.opacity, *sr.geometry, ray, instAttrV).x;
+}
 
-  const auto opacityAttribute = mat->opacityAttribute();
-  const auto *opacitySampler = mat->opacitySampler();
+float evaluateSurfaceAlpha(const SurfaceShadingRecord &sr,
+    const Ray &ray,
+    const UniformAttributeSet &instAttrV)
+{
+  if (sr.constantAlpha >= 0.f)
+    return sr.constantAlpha;
 
-  if (opacitySampler && opacitySampler->isValid())
-    return opacitySampler->getSample(*geometry(), ray, instAttrV).x;
-  else if (opacityAttribute == Attribute::NONE)
-    return mat->opacity();
-  else if (const auto &ia = getUniformAttribute(instAttrV, opacityAttribute);
-      ia)
-    return ia->x;
-  else
-    return geometry()->getAttributeValue(opacityAttribute, ray).x;
+  const float4 c = evaluateSurfaceColor(sr, ray, instAttrV);
+  const float o = evaluateSurfaceOpacity(sr, ray, instAttrV);
+  return adjustedAlpha(sr, std::clamp(c.w * o, 0.f, 1.f));
 }
 
 } // namespace helide
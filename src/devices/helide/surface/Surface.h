@@ -9,6 +9,59 @@
 namespace helide {
 
 struct Instance;
+struct Surface;
+
+// Where a surface's color/opacity comes from, resolved once from the material
+enum class ShadingSource
+{
+  CONSTANT,
+  SAMPLER,
+  RAY,
+  ATTRIBUTE,
+  INVALID_MATERIAL
+};
+
+// Flattened view of everything shadeRay() needs for a single hit surface
+struct SurfaceShadingRecord
+{
+  const Instance *instance{nullptr};
+  const Surface *surface{nullptr};
+  const Geometry *geometry{nullptr};
+  uint32_t surfaceID{~0u};
+
+  struct Input
+  {
+    ShadingSource source{ShadingSource::CONSTANT};
+    Attribute attribute{Attribute::NONE};
+    const Sampler *sampler{nullptr};
+    float4 value{1.f, 1.f, 1.f, 1.f};
+  };
+
+  Input color;
+  Input opacity;
+
+  AlphaMode alphaMode{AlphaMode::OPAQUE};
+  float alphaCutoff{0.5f};
+  bool hasMaterial{false};
+
+  // Hits on this surface must be alpha tested ('mask') or collected as
+  // translucent layers ('blend') during traversal, where 'constantAlpha'
+  // (if >= 0) is the already adjusted alpha of every hit
+  bool alphaTest{false};
+  bool blend{false};
+  float constantAlpha{-1.f};
+};
+
+float4 evaluateSurfaceColor(const SurfaceShadingRecord &sr,
+    const Ray &ray,
+    const UniformAttributeSet &instAttrV);
+float evaluateSurfaceOpacity(const SurfaceShadingRecord &sr,
+    const Ray &ray,
+    const UniformAttributeSet &instAttrV);
+float adjustedAlpha(const SurfaceShadingRecord &sr, float a);
+float evaluateSurfaceAlpha(const SurfaceShadingRecord &sr,
+    const Ray &ray,
+    const UniformAttributeSet &instAttrV);
 
 struct Surface : public Object
 {
@@ -31,9 +84,13 @@ struct Surface : public Object
 
   float adjustedAlpha(float a) const;
 
+  SurfaceShadingRecord makeShadingRecord(const Instance *inst = nullptr) const;
+
  private:
+  void on_DependencyDirty(helium::BaseObject *, uint32_t flags) override;
+
   uint32_t m_id{~0u};
-  helium::IntrusivePtr<Geometry> m_geometry;
+  helium::ChangeObserverPtr<Geometry> m_geometry;
   helium::IntrusivePtr<Material> m_material;
 };
 
@@ -53,6 +110,14 @@ inline float Surface::adjustedAlpha(float a) const
       a, material()->alphaCutoff(), material()->alphaMode());
 }
 
+inline float adjustedAlpha(const SurfaceShadingRecord &sr, float a)
+{
+  if (!sr.hasMaterial)
+    return 0.f;
+
+  return adjustOpacityFromMode(a, sr.alphaCutoff, sr.alphaMode);
+}
+
 } // namespace helide
 
 HELIDE_ANARI_TYPEFOR_SPECIALIZATION(helide::Surface *, ANARI_SURFACE);
@@ -7,6 +7,14 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom color("color");
+static const helium::StringAtom opacity("opacity");
+static const helium::StringAtom unitDistance("unitDistance");
+static const helium::StringAtom value("value");
+static const helium::StringAtom valueRange("valueRange");
+} // namespace param
+
 TransferFunction1D::TransferFunction1D(HelideGlobalState *d)
     : Volume(d), m_field(this), m_colorData(this), m_opacityData(this)
 {}
@@ -16,20 +24,20 @@ TransferFunction1D::~TransferFunction1D() = default;
 void TransferFunction1D::commitParameters()
 {
   Volume::commitParameters();
-  m_field = getParamObject<SpatialField>("value");
-  m_valueRange = getParam<box1>("valueRange", box1(0.f, 1.f));
+  m_field = getParamObject<SpatialField>(param::value);
+  m_valueRange = getParam<box1>(param::valueRange, box1(0.f, 1.f));
   double valueRange_d[2] = {0.0, 1.0};
-  if (getParam("valueRange", ANARI_FLOAT64_BOX1, &valueRange_d[0])) {
+  if (getParam(param::valueRange, ANARI_FLOAT64_BOX1, &valueRange_d[0])) {
     m_valueRange.lower = float(valueRange_d[0]);
     m_valueRange.upper = float(valueRange_d[1]);
   }
-  m_colorData = getParamObject<Array1D>("color");
+  m_colorData = getParamObject<Array1D>(param::color);
   m_uniformColor = float4(1.f);
-  getParam("color", ANARI_FLOAT32_VEC3, &m_uniformColor);
-  getParam("color", ANARI_FLOAT32_VEC4, &m_uniformColor);
-  m_opacityData = getParamObject<Array1D>("opacity");
-  m_uniformOpacity = getParam<float>("opacity", 1.f) * m_uniformColor.w;
-  m_unitDistance = getParam<float>("unitDistance", 1.f);
+  getParam(param::color, ANARI_FLOAT32_VEC3, &m_uniformColor);
+  getParam(param::color, ANARI_FLOAT32_VEC4, &m_uniformColor);
+  m_opacityData = getParamObject<Array1D>(param::opacity);
+  m_uniformOpacity = getParam<float>(param::opacity, 1.f) * m_uniformColor.w;
+  m_unitDistance = getParam<float>(param::unitDistance, 1.f);
 }
 
 void TransferFunction1D::finalize()
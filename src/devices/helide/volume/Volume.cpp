@@ -7,19 +7,23 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom id("id");
+} // namespace param
+
 Volume::Volume(HelideGlobalState *s) : Object(ANARI_VOLUME, s) {}
 
 Volume *Volume::createInstance(std::string_view subtype, HelideGlobalState *s)
 {
   if (subtype == "transferFunction1D")
-    return new TransferFunction1D(s);
+    return new (s) TransferFunction1D(s);
   else
-    return (Volume *)new UnknownObject(ANARI_VOLUME, s);
+    return (Volume *)new (s) UnknownObject(ANARI_VOLUME, s);
 }
 
 void Volume::commitParameters()
 {
-  m_id = getParam<uint32_t>("id", ~0u);
+  m_id = getParam<uint32_t>(param::id, ~0u);
 }
 
 } // namespace helide
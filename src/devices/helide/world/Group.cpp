@@ -7,8 +7,17 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom light("light");
+static const helium::StringAtom surface("surface");
+static const helium::StringAtom volume("volume");
+} // namespace param
+
 Group::Group(HelideGlobalState *s)
-    : Object(ANARI_GROUP, s), m_surfaceData(this), m_volumeData(this)
+    : Object(ANARI_GROUP, s),
+      m_surfaceData(this),
+      m_volumeData(this),
+      m_lightData(this)
 {}
 
 Group::~Group()
@@ -38,26 +47,46 @@ bool Group::getProperty(
 
 void Group::commitParameters()
 {
-  m_surfaceData = getParamObject<ObjectArray>("surface");
-  m_volumeData = getParamObject<ObjectArray>("volume");
+  m_surfaceData = getParamObject<ObjectArray>(param::surface);
+  m_volumeData = getParamObject<ObjectArray>(param::volume);
+  m_lightData = getParamObject<ObjectArray>(param::light);
 }
 
 void Group::finalize()
 {
   cleanup();
+  m_observedSurfaces.clear();
+  if (m_surfaceData) {
+    std::for_each(m_surfaceData->handlesBegin(),
+        m_surfaceData->handlesEnd(),
+        [&](auto *o) {
+          if (o) {
+            m_observedSurfaces.emplace_back(
+                this, helium::ObserverMode::DIRTY_FLAGS);
+            m_observedSurfaces.back() = (Surface *)o;
+          }
+        });
+  }
   if (m_volumeData) {
     std::transform(m_volumeData->handlesBegin(),
         m_volumeData->handlesEnd(),
         std::back_inserter(m_volumes),
         [](auto *o) { return (Volume *)o; });
   }
+  if (m_lightData) {
+    std::for_each(m_lightData->handlesBegin(),
+        m_lightData->handlesEnd(),
+        [&](auto *o) {
+          if (o && o->isValid())
+            m_lights.push_back((Light *)o);
+        });
+  }
 }
 
 void Group::markFinalized()
 {
   Object::markFinalized();
-  deviceState()->objectUpdates.lastBLSReconstructSceneRequest =
-      helium::newTimeStamp();
+  markDirty(DIRTY_BLS_RECONSTRUCT);
 }
 
 const std::vector<Surface *> &Group::surfaces() const
@@ -70,6 +99,11 @@ const std::vector<Volume *> &Group::volumes() const
   return m_volumes;
 }
 
+const std::vector<Light *> &Group::lights() const
+{
+  return m_lights;
+}
+
 void Group::intersectVolumes(VolumeRay &ray, const mat4 &invMat) const
 {
   Volume *originalVolume = ray.volume;
@@ -109,14 +143,20 @@ RTCScene Group::embreeScene() const
 void Group::embreeSceneConstruct()
 {
   const auto &state = *deviceState();
-  if (m_objectUpdates.lastSceneConstruction
-      > state.objectUpdates.lastBLSReconstructSceneRequest)
+  if (m_embreeScene && !(dirtyFlags() & DIRTY_BLS_RECONSTRUCT)
+      && m_objectUpdates.lastSceneConstruction
+          > state.objectUpdates.lastBLSReconstructSceneRequest)
     return;
 
+  // Changes raised from here on need another rebuild
+  clearDirtyFlags(DIRTY_BLS_RECONSTRUCT | DIRTY_BLS_COMMIT);
+
   reportMessage(ANARI_SEVERITY_DEBUG, "helide::Group rebuilding embree scene");
 
   rtcReleaseScene(m_embreeScene);
   m_embreeScene = rtcNewScene(deviceState()->embreeDevice);
+  rtcSetSceneFlags(m_embreeScene, RTC_SCENE_FLAG_FILTER_FUNCTION_IN_ARGUMENTS);
+  m_surfaces.clear();
 
   if (m_surfaceData) {
     uint32_t id = 0;
@@ -153,10 +193,9 @@ void Group::embreeSceneConstruct()
 
 void Group::embreeSceneCommit()
 {
-  const auto &state = *deviceState();
+  const bool geometryChanged = clearDirtyFlags(DIRTY_BLS_COMMIT);
   if (!m_embreeScene
-      || m_objectUpdates.lastSceneCommit
-          > state.objectUpdates.lastBLSCommitSceneRequest)
+      || (m_objectUpdates.lastSceneCommit != 0 && !geometryChanged))
     return;
 
   reportMessage(ANARI_SEVERITY_DEBUG, "helide::Group committing embree scene");
@@ -165,10 +204,16 @@ void Group::embreeSceneCommit()
   m_objectUpdates.lastSceneCommit = helium::newTimeStamp();
 }
 
+void Group::on_DependencyDirty(helium::BaseObject *, uint32_t flags)
+{
+  markDirty(flags);
+}
+
 void Group::cleanup()
 {
   m_surfaces.clear();
   m_volumes.clear();
+  m_lights.clear();
 
   m_objectUpdates.lastSceneConstruction = 0;
   m_objectUpdates.lastSceneCommit = 0;
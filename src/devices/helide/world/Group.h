@@ -27,6 +27,7 @@ struct Group : public Object
 
   const std::vector<Surface *> &surfaces() const;
   const std::vector<Volume *> &volumes() const;
+  const std::vector<Light *> &lights() const;
 
   void intersectVolumes(VolumeRay &ray, const mat4 &invMat) const;
 
@@ -36,17 +37,26 @@ struct Group : public Object
 
  private:
   void cleanup();
+  void on_DependencyDirty(helium::BaseObject *, uint32_t flags) override;
 
   // Geometry //
 
   helium::ChangeObserverPtr<ObjectArray> m_surfaceData;
   std::vector<Surface *> m_surfaces;
+  // Every surface in 'm_surfaceData', valid or not, so this group hears about
+  // changes to them through their dirty flags
+  std::vector<helium::ChangeObserverPtr<Surface>> m_observedSurfaces;
 
   // Volume //
 
   helium::ChangeObserverPtr<ObjectArray> m_volumeData;
   std::vector<Volume *> m_volumes;
 
+  // Light //
+
+  helium::ChangeObserverPtr<ObjectArray> m_lightData;
+  std::vector<Light *> m_lights;
+
   // BVH //
 
   struct ObjectUpdates
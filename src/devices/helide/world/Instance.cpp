@@ -7,8 +7,22 @@
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom attribute0("attribute0");
+static const helium::StringAtom attribute1("attribute1");
+static const helium::StringAtom attribute2("attribute2");
+static const helium::StringAtom attribute3("attribute3");
+static const helium::StringAtom color("color");
+static const helium::StringAtom group("group");
+static const helium::StringAtom id("id");
+static const helium::StringAtom transform("transform");
+} // namespace param
+
 Instance::Instance(HelideGlobalState *s)
-    : Object(ANARI_INSTANCE, s), m_xfmArray(this), m_idArray(this)
+    : Object(ANARI_INSTANCE, s),
+      m_xfmArray(this),
+      m_idArray(this),
+      m_group(this, helium::ObserverMode::DIRTY_FLAGS)
 {
   m_embreeGeometry =
       rtcNewGeometry(s->embreeDevice, RTC_GEOMETRY_TYPE_INSTANCE_ARRAY);
@@ -21,31 +35,31 @@ Instance::~Instance()
 
 void Instance::commitParameters()
 {
-  m_idArray = getParamObject<Array1D>("id");
-  m_id = getParam<uint32_t>("id", ~0u);
-  m_xfmArray = getParamObject<Array1D>("transform");
-  m_xfm = getParam<mat4>("transform", mat4(linalg::identity));
-  m_group = getParamObject<Group>("group");
+  m_idArray = getParamObject<Array1D>(param::id);
+  m_id = getParam<uint32_t>(param::id, ~0u);
+  m_xfmArray = getParamObject<Array1D>(param::transform);
+  m_xfm = getParam<mat4>(param::transform, mat4(linalg::identity));
+  m_group = getParamObject<Group>(param::group);
 
   for (auto &a : m_uniformAttr)
     a.reset();
   float4 attrV = DEFAULT_ATTRIBUTE_VALUE;
-  if (getParam("attribute0", ANARI_FLOAT32_VEC4, &attrV))
+  if (getParam(param::attribute0, ANARI_FLOAT32_VEC4, &attrV))
     m_uniformAttr[0] = attrV;
-  if (getParam("attribute1", ANARI_FLOAT32_VEC4, &attrV))
+  if (getParam(param::attribute1, ANARI_FLOAT32_VEC4, &attrV))
     m_uniformAttr[1] = attrV;
-  if (getParam("attribute2", ANARI_FLOAT32_VEC4, &attrV))
+  if (getParam(param::attribute2, ANARI_FLOAT32_VEC4, &attrV))
     m_uniformAttr[2] = attrV;
-  if (getParam("attribute3", ANARI_FLOAT32_VEC4, &attrV))
+  if (getParam(param::attribute3, ANARI_FLOAT32_VEC4, &attrV))
     m_uniformAttr[3] = attrV;
-  if (getParam("color", ANARI_FLOAT32_VEC4, &attrV))
+  if (getParam(param::color, ANARI_FLOAT32_VEC4, &attrV))
     m_uniformAttr[4] = attrV;
 
-  m_uniformAttrArrays.attribute0 = getParamObject<Array1D>("attribute0");
-  m_uniformAttrArrays.attribute1 = getParamObject<Array1D>("attribute1");
-  m_uniformAttrArrays.attribute2 = getParamObject<Array1D>("attribute2");
-  m_uniformAttrArrays.attribute3 = getParamObject<Array1D>("attribute3");
-  m_uniformAttrArrays.color = getParamObject<Array1D>("color");
+  m_uniformAttrArrays.attribute0 = getParamObject<Array1D>(param::attribute0);
+  m_uniformAttrArrays.attribute1 = getParamObject<Array1D>(param::attribute1);
+  m_uniformAttrArrays.attribute2 = getParamObject<Array1D>(param::attribute2);
+  m_uniformAttrArrays.attribute3 = getParamObject<Array1D>(param::attribute3);
+  m_uniformAttrArrays.color = getParamObject<Array1D>(param::color);
 }
 
 void Instance::finalize()
@@ -80,8 +94,7 @@ void Instance::finalize()
 void Instance::markFinalized()
 {
   Object::markFinalized();
-  deviceState()->objectUpdates.lastTLSReconstructSceneRequest =
-      helium::newTimeStamp();
+  markDirty(DIRTY_TLS);
 }
 
 bool Instance::isValid() const
@@ -129,12 +142,18 @@ UniformAttributeSet Instance::getUniformAttributes(uint32_t i) const
 
 const Group *Instance::group() const
 {
-  return m_group.ptr;
+  return m_group.get();
 }
 
 Group *Instance::group()
 {
-  return m_group.ptr;
+  return m_group.get();
+}
+
+void Instance::on_DependencyDirty(helium::BaseObject *, uint32_t flags)
+{
+  // Any change to the group's scene changes the bounds of this instance
+  markDirty(flags | DIRTY_TLS);
 }
 
 RTCGeometry Instance::embreeGeometry() const
@@ -53,7 +53,9 @@ struct Instance : public Object
     helium::IntrusivePtr<Array1D> color;
   } m_uniformAttrArrays;
 
-  helium::IntrusivePtr<Group> m_group;
+  void on_DependencyDirty(helium::BaseObject *, uint32_t flags) override;
+
+  helium::ChangeObserverPtr<Group> m_group;
 
   RTCGeometry m_embreeGeometry{nullptr};
 };
@@ -2,17 +2,28 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "World.h"
+// std
+#include <algorithm>
 
 namespace helide {
 
+namespace param {
+static const helium::StringAtom id("id");
+static const helium::StringAtom instance("instance");
+static const helium::StringAtom light("light");
+static const helium::StringAtom surface("surface");
+static const helium::StringAtom volume("volume");
+} // namespace param
+
 World::World(HelideGlobalState *s)
     : Object(ANARI_WORLD, s),
       m_zeroSurfaceData(this),
       m_zeroVolumeData(this),
+      m_zeroLightData(this),
       m_instanceData(this)
 {
-  m_zeroGroup = new Group(s);
-  m_zeroInstance = new Instance(s);
+  m_zeroGroup = new (s) Group(s);
+  m_zeroInstance = new (s) Instance(s);
   m_zeroInstance->setParamDirect("group", m_zeroGroup.ptr);
 
   // never any public ref to these objects
@@ -50,16 +61,18 @@ bool World::getProperty(
 
 void World::commitParameters()
 {
-  m_zeroSurfaceData = getParamObject<ObjectArray>("surface");
-  m_zeroVolumeData = getParamObject<ObjectArray>("volume");
-  m_instanceData = getParamObject<ObjectArray>("instance");
+  m_zeroSurfaceData = getParamObject<ObjectArray>(param::surface);
+  m_zeroVolumeData = getParamObject<ObjectArray>(param::volume);
+  m_zeroLightData = getParamObject<ObjectArray>(param::light);
+  m_instanceData = getParamObject<ObjectArray>(param::instance);
 }
 
 void World::finalize()
 {
   cleanup();
 
-  const bool addZeroInstance = m_zeroSurfaceData || m_zeroVolumeData;
+  const bool addZeroInstance =
+      m_zeroSurfaceData || m_zeroVolumeData || m_zeroLightData;
   if (addZeroInstance)
     reportMessage(ANARI_SEVERITY_DEBUG, "helide::World will add zero instance");
 
@@ -67,19 +80,27 @@ void World::finalize()
     reportMessage(ANARI_SEVERITY_DEBUG,
         "helide::World found %zu surfaces in zero instance",
         m_zeroSurfaceData->size());
-    m_zeroGroup->setParamDirect("surface", getParamDirect("surface"));
+    m_zeroGroup->setParamDirect("surface", borrowParamDirect(param::surface));
   } else
-    m_zeroGroup->removeParam("surface");
+    m_zeroGroup->removeParam(param::surface);
 
   if (m_zeroVolumeData) {
     reportMessage(ANARI_SEVERITY_DEBUG,
         "helide::World found %zu volumes in zero instance",
         m_zeroVolumeData->size());
-    m_zeroGroup->setParamDirect("volume", getParamDirect("volume"));
+    m_zeroGroup->setParamDirect("volume", borrowParamDirect(param::volume));
   } else
-    m_zeroGroup->removeParam("volume");
+    m_zeroGroup->removeParam(param::volume);
 
-  m_zeroInstance->setParam("id", getParam<uint32_t>("id", ~0u));
+  if (m_zeroLightData) {
+    reportMessage(ANARI_SEVERITY_DEBUG,
+        "helide::World found %zu lights in zero instance",
+        m_zeroLightData->size());
+    m_zeroGroup->setParamDirect("light", borrowParamDirect(param::light));
+  } else
+    m_zeroGroup->removeParam(param::light);
+
+  m_zeroInstance->setParam("id", getParam<uint32_t>(param::id, ~0u));
 
   m_zeroGroup->commitParameters();
   m_zeroInstance->commitParameters();
@@ -100,9 +121,20 @@ void World::finalize()
   if (addZeroInstance)
     m_instances.push_back(m_zeroInstance.ptr);
 
+  m_observedInstances.clear();
+  for (auto *i : m_instances) {
+    m_observedInstances.emplace_back(this, helium::ObserverMode::DIRTY_FLAGS);
+    m_observedInstances.back() = i;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(m_dirtyInstancesMutex);
+    m_dirtyInstances.clear();
+  }
+
   m_objectUpdates.lastTLSBuild = 0;
   m_objectUpdates.lastBLSReconstructCheck = 0;
-  m_objectUpdates.lastBLSCommitCheck = 0;
+  m_objectUpdates.lastShadingDataBuild = 0;
 }
 
 const std::vector<Instance *> &World::instances() const
@@ -110,6 +142,11 @@ const std::vector<Instance *> &World::instances() const
   return m_instances;
 }
 
+const std::vector<LightInstance> &World::lights() const
+{
+  return m_lights;
+}
+
 void World::intersectVolumes(VolumeRay &ray) const
 {
   const auto &insts = instances();
@@ -128,72 +165,93 @@ RTCScene World::embreeScene() const
 
 void World::embreeSceneUpdate()
 {
-  rebuildBLSs();
-  recommitBLSs();
-  rebuildTLS();
-}
-
-void World::rebuildBLSs()
-{
-  const auto &state = *deviceState();
-  if (state.objectUpdates.lastBLSReconstructSceneRequest
-      < m_objectUpdates.lastBLSReconstructCheck) {
-    return;
+  {
+    std::lock_guard<std::mutex> guard(m_dirtyInstancesMutex);
+    std::swap(m_dirtyInstances, m_updatedInstances);
   }
+  std::sort(m_updatedInstances.begin(), m_updatedInstances.end());
+  m_updatedInstances.erase(
+      std::unique(m_updatedInstances.begin(), m_updatedInstances.end()),
+      m_updatedInstances.end());
+  clearDirtyFlags();
 
-  m_objectUpdates.lastTLSBuild = 0; // BLS changed, so need to build TLS
-  reportMessage(ANARI_SEVERITY_DEBUG,
-      "helide::World rebuilding %zu BLSs",
-      m_instances.size());
-  std::for_each(m_instances.begin(), m_instances.end(), [&](auto *inst) {
-    inst->group()->embreeSceneConstruct();
-  });
+  updateBLSs();
+  updateTLS();
+  rebuildShadingData();
 
-  m_objectUpdates.lastBLSReconstructCheck = helium::newTimeStamp();
-  m_objectUpdates.lastBLSCommitCheck = helium::newTimeStamp();
+  m_updatedInstances.clear();
 }
 
-void World::recommitBLSs()
+void World::updateBLSs()
 {
+  // Only the groups of instances which raised dirty flags can have changed,
+  // unless something device-wide (or the world itself) changed
   const auto &state = *deviceState();
-  if (state.objectUpdates.lastBLSCommitSceneRequest
-      < m_objectUpdates.lastBLSCommitCheck) {
-    return;
+  const bool checkAll = state.objectUpdates.lastBLSReconstructSceneRequest
+      >= m_objectUpdates.lastBLSReconstructCheck;
+
+  if (checkAll) {
+    reportMessage(ANARI_SEVERITY_DEBUG,
+        "helide::World checking %zu BLSs",
+        m_instances.size());
+    m_objectUpdates.lastTLSBuild = 0;
+  } else if (!m_updatedInstances.empty()) {
+    reportMessage(ANARI_SEVERITY_DEBUG,
+        "helide::World updating BLSs of %zu instances",
+        m_updatedInstances.size());
   }
 
-  m_objectUpdates.lastTLSBuild = 0; // BLS changed, so need to build TLS
-  reportMessage(ANARI_SEVERITY_DEBUG,
-      "helide::World recommitting %zu BLSs",
-      m_instances.size());
-  std::for_each(m_instances.begin(), m_instances.end(), [&](auto *inst) {
-    inst->group()->embreeSceneCommit();
+  const auto &instances = checkAll ? m_instances : m_updatedInstances;
+  std::for_each(instances.begin(), instances.end(), [&](auto *inst) {
+    if (auto *g = inst->group(); g) {
+      g->embreeSceneConstruct();
+      g->embreeSceneCommit();
+    }
   });
 
-  m_objectUpdates.lastBLSCommitCheck = helium::newTimeStamp();
+  m_objectUpdates.lastBLSReconstructCheck = helium::newTimeStamp();
 }
 
-void World::rebuildTLS()
+void World::updateTLS()
 {
-  const auto &state = *deviceState();
-  if (state.objectUpdates.lastTLSReconstructSceneRequest
-      < m_objectUpdates.lastTLSBuild) {
+  const bool rebuild = m_objectUpdates.lastTLSBuild == 0 || !m_embreeScene;
+  if (!rebuild && m_updatedInstances.empty())
     return;
-  }
 
-  reportMessage(ANARI_SEVERITY_DEBUG,
-      "helide::World rebuilding TLS over %zu instances",
-      m_instances.size());
+  if (rebuild) {
+    reportMessage(ANARI_SEVERITY_DEBUG,
+        "helide::World rebuilding TLS over %zu instances",
+        m_instances.size());
+
+    rtcReleaseScene(m_embreeScene);
+    m_embreeScene = rtcNewScene(deviceState()->embreeDevice);
+    rtcSetSceneFlags(
+        m_embreeScene, RTC_SCENE_FLAG_FILTER_FUNCTION_IN_ARGUMENTS);
+    m_instanceAttached.assign(m_instances.size(), false);
+  } else {
+    reportMessage(ANARI_SEVERITY_DEBUG,
+        "helide::World updating %zu of %zu instances in TLS",
+        m_updatedInstances.size(),
+        m_instances.size());
+  }
 
-  rtcReleaseScene(m_embreeScene);
-  m_embreeScene = rtcNewScene(deviceState()->embreeDevice);
+  for (uint32_t id = 0; id < m_instances.size(); id++) {
+    auto *i = m_instances[id];
+    if (!rebuild
+        && !std::binary_search(
+            m_updatedInstances.begin(), m_updatedInstances.end(), i))
+      continue;
 
-  uint32_t id = 0;
-  std::for_each(m_instances.begin(), m_instances.end(), [&](auto *i) {
-    if (i && i->isValid() && !i->group()->surfaces().empty()) {
+    const bool attach =
+        i && i->isValid() && !i->group()->surfaces().empty();
+    if (attach) {
       i->embreeGeometryUpdate();
-      rtcAttachGeometryByID(m_embreeScene, i->embreeGeometry(), id);
+      if (!m_instanceAttached[id])
+        rtcAttachGeometryByID(m_embreeScene, i->embreeGeometry(), id);
     } else {
-      if (i->group()->surfaces().empty()) {
+      if (m_instanceAttached[id])
+        rtcDetachGeometry(m_embreeScene, id);
+      if (i && i->isValid()) {
         reportMessage(ANARI_SEVERITY_DEBUG,
             "helide::World rejecting empty surfaces in instance(%p) "
             "when building TLS",
@@ -205,13 +263,159 @@ void World::rebuildTLS()
             i);
       }
     }
-    id++;
-  });
+    m_instanceAttached[id] = attach;
+  }
 
   rtcCommitScene(m_embreeScene);
   m_objectUpdates.lastTLSBuild = helium::newTimeStamp();
 }
 
+void World::rebuildShadingData()
+{
+  // NOTE: material changes do not propagate to surfaces or groups, so any
+  //       finalization is treated as a reason to re-resolve shading inputs
+  const auto &state = *deviceState();
+  if (state.commitBuffer.lastObjectFinalization()
+          < m_objectUpdates.lastShadingDataBuild
+      && m_objectUpdates.lastTLSBuild < m_objectUpdates.lastShadingDataBuild)
+    return;
+
+  m_shadingRecords.clear();
+  m_shadingRecordOffsets.clear();
+  m_shadingRecordOffsets.reserve(m_instances.size());
+  m_needsAlphaFilter = false;
+  m_lights.clear();
+
+  for (auto *inst : m_instances) {
+    m_shadingRecordOffsets.push_back(uint32_t(m_shadingRecords.size()));
+    if (!inst || !inst->group())
+      continue;
+    for (auto *s : inst->group()->surfaces()) {
+      m_shadingRecords.push_back(s->makeShadingRecord(inst));
+      const auto &sr = m_shadingRecords.back();
+      m_needsAlphaFilter |= sr.alphaTest || sr.blend;
+    }
+    for (auto *l : inst->group()->lights()) {
+      for (uint32_t i = 0; i < inst->numTransforms(); i++)
+        m_lights.push_back({l, inst->xfm(i)});
+    }
+  }
+
+  reportMessage(ANARI_SEVERITY_DEBUG,
+      "helide::World built %zu surface shading records and %zu lights",
+      m_shadingRecords.size(),
+      m_lights.size());
+
+  m_objectUpdates.lastShadingDataBuild = helium::newTimeStamp();
+}
+
+void World::initIntersectArguments(
+    RTCIntersectArguments &args, WorldRayQueryContext &ctx) const
+{
+  rtcInitIntersectArguments(&args);
+  rtcInitRayQueryContext(&ctx.embree);
+  ctx.world = this;
+  args.context = &ctx.embree;
+  if (m_needsAlphaFilter) {
+    args.flags = RTCRayQueryFlags(
+        args.flags | RTC_RAY_QUERY_FLAG_INVOKE_ARGUMENT_FILTER);
+    args.filter = &World::alphaFilter;
+  }
+}
+
+void World::initOccludedArguments(
+    RTCOccludedArguments &args, WorldRayQueryContext &ctx) const
+{
+  rtcInitOccludedArguments(&args);
+  rtcInitRayQueryContext(&ctx.embree);
+  ctx.world = this;
+  args.context = &ctx.embree;
+  if (m_needsAlphaFilter) {
+    args.flags = RTCRayQueryFlags(
+        args.flags | RTC_RAY_QUERY_FLAG_INVOKE_ARGUMENT_FILTER);
+    args.filter = &World::alphaFilter;
+  }
+}
+
+static void insertTransparentHit(
+    TransparentHitList &list, const Ray &hit, float alpha)
+{
+  // Embree may report the same hit more than once
+  for (int i = 0; i < list.count; i++) {
+    const Ray &h = list.hits[i];
+    if (h.primID == hit.primID && h.geomID == hit.geomID
+        && h.instID == hit.instID && h.instArrayID == hit.instArrayID)
+      return;
+  }
+
+  if (list.count == list.capacity
+      && hit.tfar >= list.hits[list.count - 1].tfar)
+    return;
+
+  int i = std::min(list.count, list.capacity - 1);
+  for (; i > 0 && list.hits[i - 1].tfar > hit.tfar; i--) {
+    list.hits[i] = list.hits[i - 1];
+    list.alpha[i] = list.alpha[i - 1];
+  }
+  list.hits[i] = hit;
+  list.alpha[i] = alpha;
+  list.count = std::min(list.count + 1, list.capacity);
+}
+
+void World::alphaFilter(const RTCFilterFunctionNArguments *args)
+{
+  const auto *ctx = (const WorldRayQueryContext *)args->context;
+  const World &w = *ctx->world;
+
+  for (unsigned int i = 0; i < args->N; i++) {
+    if (args->valid[i] == 0)
+      continue;
+
+    Ray ray;
+    ray.instID = RTCHitN_instID(args->hit, args->N, i, 0);
+    ray.geomID = RTCHitN_geomID(args->hit, args->N, i);
+
+    const auto &sr = w.shadingRecordFromRay(ray);
+    if (!sr.alphaTest && !sr.blend)
+      continue; // opaque surfaces accept the hit right away
+
+    ray.org.x = RTCRayN_org_x(args->ray, args->N, i);
+    ray.org.y = RTCRayN_org_y(args->ray, args->N, i);
+    ray.org.z = RTCRayN_org_z(args->ray, args->N, i);
+    ray.dir.x = RTCRayN_dir_x(args->ray, args->N, i);
+    ray.dir.y = RTCRayN_dir_y(args->ray, args->N, i);
+    ray.dir.z = RTCRayN_dir_z(args->ray, args->N, i);
+    ray.tfar = RTCRayN_tfar(args->ray, args->N, i);
+    ray.Ng.x = RTCHitN_Ng_x(args->hit, args->N, i);
+    ray.Ng.y = RTCHitN_Ng_y(args->hit, args->N, i);
+    ray.Ng.z = RTCHitN_Ng_z(args->hit, args->N, i);
+    ray.u = RTCHitN_u(args->hit, args->N, i);
+    ray.v = RTCHitN_v(args->hit, args->N, i);
+    ray.primID = RTCHitN_primID(args->hit, args->N, i);
+    ray.instArrayID = RTCHitN_instPrimID(args->hit, args->N, i, 0);
+
+    float alpha = sr.constantAlpha;
+    if (alpha < 0.f) {
+      alpha = evaluateSurfaceAlpha(
+          sr, ray, sr.instance->getUniformAttributes(ray.instArrayID));
+    }
+
+    if (alpha <= 0.f)
+      args->valid[i] = 0;
+    else if (sr.blend && alpha < 1.f && ctx->transparentHits) {
+      insertTransparentHit(*ctx->transparentHits, ray, alpha);
+      args->valid[i] = 0;
+    }
+  }
+}
+
+void World::on_DependencyDirty(helium::BaseObject *obj, uint32_t flags)
+{
+  std::lock_guard<std::mutex> guard(m_dirtyInstancesMutex);
+  m_dirtyInstances.push_back((Instance *)obj);
+  markDirty(flags);
+}
+
 void World::cleanup()
 {
   rtcReleaseScene(m_embreeScene);
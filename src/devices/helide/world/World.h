@@ -4,9 +4,42 @@
 #pragma once
 
 #include "Instance.h"
+// std
+#include <mutex>
+#include <vector>
 
 namespace helide {
 
+// A light paired with the transform of the instance it was found in
+struct LightInstance
+{
+  const Light *light{nullptr};
+  mat4 xfm{linalg::identity};
+};
+
+struct World;
+
+constexpr int MAX_TRANSPARENT_HITS = 16;
+
+// Nearest 'blend' surface hits gathered during traversal, sorted by distance
+// where each hit's 'tfar' is its distance along the ray
+struct TransparentHitList
+{
+  Ray hits[MAX_TRANSPARENT_HITS];
+  float alpha[MAX_TRANSPARENT_HITS];
+  int count{0};
+  int capacity{0};
+};
+
+// Ray query context passed to Embree so traversal callbacks can reach the world
+struct WorldRayQueryContext
+{
+  RTCRayQueryContext embree;
+  const World *world{nullptr};
+  // If set, translucent hits are collected here instead of ending the ray
+  TransparentHitList *transparentHits{nullptr};
+};
+
 struct World : public Object
 {
   World(HelideGlobalState *s);
@@ -22,27 +55,50 @@ struct World : public Object
   void finalize() override;
 
   const std::vector<Instance *> &instances() const;
+  const std::vector<LightInstance> &lights() const;
 
   void intersectVolumes(VolumeRay &ray) const;
 
   const Instance *instanceFromRay(const Ray &ray) const;
   const Instance *instanceFromRay(const VolumeRay &ray) const;
   const Surface *surfaceFromRay(const Ray &ray) const;
+  const SurfaceShadingRecord &shadingRecordFromRay(const Ray &ray) const;
 
   RTCScene embreeScene() const;
   void embreeSceneUpdate();
 
+  // Setup Embree query arguments, enabling the alpha filter only if some
+  // surface in the world needs it
+  void initIntersectArguments(
+      RTCIntersectArguments &args, WorldRayQueryContext &ctx) const;
+  void initOccludedArguments(
+      RTCOccludedArguments &args, WorldRayQueryContext &ctx) const;
+
  private:
-  void rebuildBLSs();
-  void recommitBLSs();
-  void rebuildTLS();
+  void updateBLSs();
+  void updateTLS();
+  void rebuildShadingData();
   void cleanup();
+  void on_DependencyDirty(helium::BaseObject *, uint32_t flags) override;
+
+  static void alphaFilter(const RTCFilterFunctionNArguments *args);
 
   helium::ChangeObserverPtr<ObjectArray> m_zeroSurfaceData;
   helium::ChangeObserverPtr<ObjectArray> m_zeroVolumeData;
+  helium::ChangeObserverPtr<ObjectArray> m_zeroLightData;
 
   helium::ChangeObserverPtr<ObjectArray> m_instanceData;
   std::vector<Instance *> m_instances;
+  std::vector<helium::ChangeObserverPtr<Instance>> m_observedInstances;
+
+  // Instances which raised dirty flags since the scene was last updated, and
+  // those taken from it by the update in progress
+  std::mutex m_dirtyInstancesMutex;
+  std::vector<Instance *> m_dirtyInstances;
+  std::vector<Instance *> m_updatedInstances;
+
+  // Whether m_instances[i] is attached to the world's embree scene
+  std::vector<bool> m_instanceAttached;
 
   bool m_addZeroInstance{false};
   helium::IntrusivePtr<Group> m_zeroGroup;
@@ -56,9 +112,17 @@ struct World : public Object
   {
     helium::TimeStamp lastTLSBuild{0};
     helium::TimeStamp lastBLSReconstructCheck{0};
-    helium::TimeStamp lastBLSCommitCheck{0};
+    helium::TimeStamp lastShadingDataBuild{0};
   } m_objectUpdates;
 
+  // Shading records for every (instance, surface) pair, where the records for
+  // instance 'i' start at m_shadingRecordOffsets[i] and are indexed by geomID
+  std::vector<SurfaceShadingRecord> m_shadingRecords;
+  std::vector<uint32_t> m_shadingRecordOffsets;
+  bool m_needsAlphaFilter{false};
+
+  std::vector<LightInstance> m_lights;
+
   RTCScene m_embreeScene{nullptr};
 };
 
@@ -76,8 +140,13 @@ inline const Instance *World::instanceFromRay(const VolumeRay &ray) const
 
 inline const Surface *World::surfaceFromRay(const Ray &ray) const
 {
-  auto *inst = instanceFromRay(ray);
-  return inst->group()->surfaces()[ray.geomID];
+  return shadingRecordFromRay(ray).surface;
+}
+
+inline const SurfaceShadingRecord &World::shadingRecordFromRay(
+    const Ray &ray) const
+{
+  return m_shadingRecords[m_shadingRecordOffsets[ray.instID] + ray.geomID];
 }
 
 } // namespace helide
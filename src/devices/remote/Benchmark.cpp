@@ -0,0 +1,573 @@
+// Copyright 2023-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+// Starts anariRemoteServer on loopback (or connects to a running server),
+// replays scenes from anari_test_scenes through the remote device, and
+// reports message throughput, array upload time, frame round trip latency,
+// and compression ratios per codec as JSON.
+
+#include <anari/anari_cpp.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "anari_test_scenes.h"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Global variables
+static std::string g_libraryType = "sink";
+static std::string g_serverPath;
+static std::vector<std::string> g_serverArgs;
+static bool g_startServer = true;
+static std::string g_hostname = "localhost";
+static unsigned short g_port = 31051;
+static uint32_t g_width = 1024;
+static uint32_t g_height = 768;
+static uint32_t g_numFrames = 20;
+static uint32_t g_numMessages = 100000;
+static uint64_t g_arraySize = uint64_t(64) << 20;
+static bool g_sharedMemory = true;
+static std::vector<std::pair<std::string, std::string>> g_scenes;
+// The remote device logs to stdout, so the report goes to a file
+static std::string g_outputFile = "anariRemoteBenchmark.json";
+
+static double getCurrentTime()
+{
+  auto now = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(now.time_since_epoch()).count();
+}
+
+//--- Counters ------------------------------------------
+
+// The remote device's traffic counters ("remote.*" device properties)
+static const char *g_codecs[] = {
+    "raw", "sharedMemory", "turbojpeg", "snappy", "floatDepth"};
+static constexpr size_t numCodecs = sizeof(g_codecs) / sizeof(g_codecs[0]);
+
+struct Counters
+{
+  uint64_t calls{0};
+  uint64_t messagesSent{0};
+  uint64_t bytesSent{0};
+  uint64_t messagesReceived{0};
+  uint64_t bytesReceived{0};
+  uint64_t rawBytes[numCodecs]{};
+  uint64_t encodedBytes[numCodecs]{};
+
+  Counters operator-(const Counters &other) const
+  {
+    Counters result;
+    result.calls = calls - other.calls;
+    result.messagesSent = messagesSent - other.messagesSent;
+    result.bytesSent = bytesSent - other.bytesSent;
+    result.messagesReceived = messagesReceived - other.messagesReceived;
+    result.bytesReceived = bytesReceived - other.bytesReceived;
+    for (size_t i = 0; i < numCodecs; ++i) {
+      result.rawBytes[i] = rawBytes[i] - other.rawBytes[i];
+      result.encodedBytes[i] = encodedBytes[i] - other.encodedBytes[i];
+    }
+    return result;
+  }
+};
+
+static uint64_t getCounter(anari::Device d, const std::string &name)
+{
+  uint64_t value = 0;
+  anariGetProperty(d,
+      d,
+      ("remote." + name).c_str(),
+      ANARI_UINT64,
+      &value,
+      sizeof(value),
+      ANARI_NO_WAIT);
+  return value;
+}
+
+static Counters getCounters(anari::Device d)
+{
+  Counters result;
+  result.calls = getCounter(d, "calls");
+  result.messagesSent = getCounter(d, "messagesSent");
+  result.bytesSent = getCounter(d, "bytesSent");
+  result.messagesReceived = getCounter(d, "messagesReceived");
+  result.bytesReceived = getCounter(d, "bytesReceived");
+  for (size_t i = 0; i < numCodecs; ++i) {
+    result.rawBytes[i] = getCounter(d, g_codecs[i] + std::string(".rawBytes"));
+    result.encodedBytes[i] =
+        getCounter(d, g_codecs[i] + std::string(".encodedBytes"));
+  }
+  return result;
+}
+
+// Messages are processed in order, so once the server answered a query it
+// has processed everything sent before
+static void waitForServer(anari::Device d)
+{
+  int32_t version = 0;
+  anariGetProperty(
+      d, d, "version", ANARI_INT32, &version, sizeof(version), ANARI_WAIT);
+}
+
+//--- JSON ----------------------------------------------
+
+static std::string quote(const std::string &str)
+{
+  std::string result = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    result += c;
+  }
+  return result + "\"";
+}
+
+static double megabytesPerSecond(uint64_t bytes, double seconds)
+{
+  return seconds > 0.0 ? bytes / seconds / (1 << 20) : 0.0;
+}
+
+static void writeTraffic(
+    std::ostream &out, const Counters &counters, double seconds)
+{
+  out << "\"seconds\": " << seconds << ", \"calls\": " << counters.calls
+      << ", \"callsPerSecond\": "
+      << (seconds > 0.0 ? counters.calls / seconds : 0.0)
+      << ", \"messagesSent\": " << counters.messagesSent
+      << ", \"bytesSent\": " << counters.bytesSent
+      << ", \"messagesReceived\": " << counters.messagesReceived
+      << ", \"bytesReceived\": " << counters.bytesReceived
+      << ", \"megabytesPerSecond\": "
+      << megabytesPerSecond(
+             counters.bytesSent + counters.bytesReceived, seconds);
+}
+
+// Codecs which handled any data, with the ratio of raw to encoded bytes
+static void writeCodecs(std::ostream &out, const Counters &counters)
+{
+  out << "{";
+  bool first = true;
+  for (size_t i = 0; i < numCodecs; ++i) {
+    if (counters.rawBytes[i] == 0)
+      continue;
+    out << (first ? "" : ", ") << quote(g_codecs[i])
+        << ": {\"rawBytes\": " << counters.rawBytes[i]
+        << ", \"encodedBytes\": " << counters.encodedBytes[i]
+        << ", \"ratio\": "
+        << double(counters.rawBytes[i])
+            / std::max(counters.encodedBytes[i], uint64_t(1))
+        << "}";
+    first = false;
+  }
+  out << "}";
+}
+
+static void writeLatency(std::ostream &out, std::vector<double> latency)
+{
+  if (latency.empty()) {
+    out << "null";
+    return;
+  }
+
+  std::sort(latency.begin(), latency.end());
+  double sum = 0.0;
+  for (double l : latency)
+    sum += l;
+  auto percentile = [&](double p) {
+    return latency[size_t(p * (latency.size() - 1) + 0.5)] * 1000.0;
+  };
+
+  out << "{\"min\": " << latency.front() * 1000.0
+      << ", \"mean\": " << sum / latency.size() * 1000.0
+      << ", \"p50\": " << percentile(0.5) << ", \"p95\": " << percentile(0.95)
+      << ", \"max\": " << latency.back() * 1000.0 << "}";
+}
+
+//--- Server --------------------------------------------
+
+#ifndef _WIN32
+static pid_t g_serverPid = 0;
+
+static bool canConnect()
+{
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0)
+    return false;
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(g_port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bool connected = connect(fd, (sockaddr *)&addr, sizeof(addr)) == 0;
+  close(fd);
+  return connected;
+}
+#endif
+
+static bool startServer()
+{
+#ifndef _WIN32
+  std::vector<std::string> args = {g_serverPath,
+      "--library",
+      g_libraryType,
+      "--port",
+      std::to_string(g_port)};
+  args.insert(args.end(), g_serverArgs.begin(), g_serverArgs.end());
+
+  g_serverPid = fork();
+  if (g_serverPid < 0)
+    return false;
+
+  if (g_serverPid == 0) {
+    std::vector<char *> argv;
+    for (auto &arg : args)
+      argv.push_back(arg.data());
+    argv.push_back(nullptr);
+    execvp(argv[0], argv.data());
+    perror(argv[0]);
+    _exit(127);
+  }
+
+  // Wait until the server listens (or gave up)
+  for (int i = 0; i < 100; ++i) {
+    if (waitpid(g_serverPid, nullptr, WNOHANG) == g_serverPid) {
+      g_serverPid = 0;
+      return false;
+    }
+    if (canConnect())
+      return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  return false;
+#else
+  std::cerr << "Starting the server is not supported on this platform; "
+            << "start anariRemoteServer and pass --no-server\n";
+  return false;
+#endif
+}
+
+static void stopServer()
+{
+#ifndef _WIN32
+  if (g_serverPid > 0) {
+    kill(g_serverPid, SIGTERM);
+    waitpid(g_serverPid, nullptr, 0);
+    g_serverPid = 0;
+  }
+#endif
+}
+
+//--- Benchmarks ----------------------------------------
+
+// Many small calls that need no reply
+static void benchmarkMessages(anari::Device d, std::ostream &out)
+{
+  auto camera = anari::newObject<anari::Camera>(d, "perspective");
+  waitForServer(d);
+
+  Counters before = getCounters(d);
+  double start = getCurrentTime();
+  for (uint32_t i = 0; i < g_numMessages; ++i) {
+    anari::setParameter(
+        d, camera, "position", anari::math::float3(float(i), 0.f, 0.f));
+    if (i % 8 == 7)
+      anari::commitParameters(d, camera);
+  }
+  waitForServer(d);
+  double seconds = getCurrentTime() - start;
+  Counters counters = getCounters(d) - before;
+
+  anari::release(d, camera);
+
+  out << "  \"messages\": {";
+  writeTraffic(out, counters, seconds);
+  out << "},\n";
+}
+
+// One large array, created from application memory
+static void benchmarkArrayUpload(anari::Device d, std::ostream &out)
+{
+  std::vector<float> data(g_arraySize / sizeof(float));
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = float(i % 1000) * 0.001f;
+
+  Counters before = getCounters(d);
+  double start = getCurrentTime();
+  auto array = anari::newArray1D(d, data.data(), data.size());
+  waitForServer(d);
+  double seconds = getCurrentTime() - start;
+  Counters counters = getCounters(d) - before;
+
+  anari::release(d, array);
+
+  out << "  \"arrayUpload\": {\"arrayBytes\": " << g_arraySize << ", ";
+  writeTraffic(out, counters, seconds);
+  out << ", \"arrayMegabytesPerSecond\": "
+      << megabytesPerSecond(g_arraySize, seconds) << ", \"codecs\": ";
+  writeCodecs(out, counters);
+  out << "},\n";
+}
+
+// Build the scene, then render frames from its cameras
+static void benchmarkScene(anari::Device d,
+    const std::string &category,
+    const std::string &name,
+    std::ostream &out)
+{
+  Counters before = getCounters(d);
+  double start = getCurrentTime();
+  auto s = anari::scenes::createScene(d, category.c_str(), name.c_str());
+  anari::scenes::commit(s);
+  waitForServer(d);
+  double uploadSeconds = getCurrentTime() - start;
+  Counters upload = getCounters(d) - before;
+
+  auto camera = anari::newObject<anari::Camera>(d, "perspective");
+  anari::setParameter(d, camera, "aspect", (float)g_width / (float)g_height);
+
+  auto renderer = anari::newObject<anari::Renderer>(d, "default");
+  anari::commitParameters(d, renderer);
+
+  auto frame = anari::newObject<anari::Frame>(d);
+  anari::setParameter(d, frame, "size", anari::math::uint2(g_width, g_height));
+  anari::setParameter(d, frame, "channel.color", ANARI_UFIXED8_RGBA_SRGB);
+  anari::setParameter(d, frame, "channel.depth", ANARI_FLOAT32);
+  anari::setParameter(d, frame, "renderer", renderer);
+  anari::setParameter(d, frame, "camera", camera);
+  anari::setParameter(d, frame, "world", anari::scenes::getWorld(s));
+  anari::commitParameters(d, frame);
+
+  auto cameras = anari::scenes::getCameras(s);
+  auto renderFrame = [&](uint32_t i) {
+    if (!cameras.empty()) {
+      auto &cam = cameras[i % cameras.size()];
+      anari::setParameter(d, camera, "position", cam.position);
+      anari::setParameter(d, camera, "direction", cam.direction);
+      anari::setParameter(d, camera, "up", cam.up);
+    }
+    anari::commitParameters(d, camera);
+
+    anari::render(d, frame);
+    anari::wait(d, frame);
+    anari::map<uint32_t>(d, frame, "channel.color");
+    anari::unmap(d, frame, "channel.color");
+    anari::map<float>(d, frame, "channel.depth");
+    anari::unmap(d, frame, "channel.depth");
+  };
+
+  // The first frame also commits the world on the server
+  renderFrame(0);
+
+  std::vector<double> latency;
+  before = getCounters(d);
+  start = getCurrentTime();
+  for (uint32_t i = 0; i < g_numFrames; ++i) {
+    double frameStart = getCurrentTime();
+    renderFrame(i + 1);
+    latency.push_back(getCurrentTime() - frameStart);
+  }
+  double frameSeconds = getCurrentTime() - start;
+  Counters frames = getCounters(d) - before;
+
+  anari::release(d, camera);
+  anari::release(d, renderer);
+  anari::release(d, frame);
+  anari::scenes::release(s);
+
+  out << "    {\"category\": " << quote(category) << ", \"name\": "
+      << quote(name) << ",\n     \"upload\": {";
+  writeTraffic(out, upload, uploadSeconds);
+  out << ", \"codecs\": ";
+  writeCodecs(out, upload);
+  out << "},\n     \"frames\": {\"count\": " << g_numFrames
+      << ", \"framesPerSecond\": "
+      << (frameSeconds > 0.0 ? g_numFrames / frameSeconds : 0.0)
+      << ", \"latencyMs\": ";
+  writeLatency(out, latency);
+  out << ", ";
+  writeTraffic(out, frames, frameSeconds);
+  out << ", \"codecs\": ";
+  writeCodecs(out, frames);
+  out << "}}";
+}
+
+//--- Main ----------------------------------------------
+
+static void statusFunc(const void *userData,
+    ANARIDevice device,
+    ANARIObject source,
+    ANARIDataType sourceType,
+    ANARIStatusSeverity severity,
+    ANARIStatusCode code,
+    const char *message)
+{
+  if (severity == ANARI_SEVERITY_FATAL_ERROR)
+    fprintf(stderr, "[FATAL] %s\n", message);
+  else if (severity == ANARI_SEVERITY_ERROR)
+    fprintf(stderr, "[ERROR] %s\n", message);
+}
+
+static void printUsage()
+{
+  std::cout << "./anariRemoteBenchmark [{--help|-h}]\n"
+            << "   [{--library|-l} <ANARI library>]\n"
+            << "   [--server <path to anariRemoteServer>]\n"
+            << "   [--server-arg <argument>]\n"
+            << "   [--no-server]\n"
+            << "   [{--hostname|-n} <hostname>]\n"
+            << "   [{--port|-p} <N>]\n"
+            << "   [{--scene|-s} <category> <name>]\n"
+            << "   [{--frames|-f} <N>]\n"
+            << "   [--size <width> <height>]\n"
+            << "   [{--messages|-m} <N>]\n"
+            << "   [{--array-size|-a} <MiB>]\n"
+            << "   [--no-shared-memory]\n"
+            << "   [{--output|-o} <file.json>]\n";
+}
+
+static void parseCommandLine(int argc, char *argv[])
+{
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      printUsage();
+      std::exit(0);
+    } else if (arg == "-l" || arg == "--library")
+      g_libraryType = argv[++i];
+    else if (arg == "--server")
+      g_serverPath = argv[++i];
+    else if (arg == "--server-arg")
+      g_serverArgs.push_back(argv[++i]);
+    else if (arg == "--no-server")
+      g_startServer = false;
+    else if (arg == "-n" || arg == "--hostname")
+      g_hostname = argv[++i];
+    else if (arg == "-p" || arg == "--port")
+      g_port = std::stoi(argv[++i]);
+    else if (arg == "-s" || arg == "--scene") {
+      std::string category = argv[++i];
+      g_scenes.emplace_back(category, argv[++i]);
+    } else if (arg == "-f" || arg == "--frames")
+      g_numFrames = std::stoi(argv[++i]);
+    else if (arg == "--size") {
+      g_width = std::stoi(argv[++i]);
+      g_height = std::stoi(argv[++i]);
+    } else if (arg == "-m" || arg == "--messages")
+      g_numMessages = std::stoi(argv[++i]);
+    else if (arg == "-a" || arg == "--array-size")
+      g_arraySize = std::stoull(argv[++i]) << 20;
+    else if (arg == "--no-shared-memory")
+      g_sharedMemory = false;
+    else if (arg == "-o" || arg == "--output")
+      g_outputFile = argv[++i];
+  }
+
+  // By default, the server is next to this executable
+  if (g_serverPath.empty()) {
+    std::string self = argv[0];
+    size_t slash = self.find_last_of('/');
+    g_serverPath = slash == std::string::npos
+        ? "anariRemoteServer"
+        : self.substr(0, slash + 1) + "anariRemoteServer";
+  }
+
+  // All scenes that don't need files
+  if (g_scenes.empty()) {
+    for (auto &category : anari::scenes::getAvailableSceneCategories()) {
+      if (category == "file")
+        continue;
+      for (auto &name : anari::scenes::getAvailableSceneNames(category.c_str()))
+        g_scenes.emplace_back(category, name);
+    }
+    std::sort(g_scenes.begin(), g_scenes.end());
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  parseCommandLine(argc, argv);
+
+  if (g_startServer) {
+    g_hostname = "localhost";
+    if (!startServer()) {
+      std::cerr << "Could not start " << g_serverPath << "\n";
+      stopServer();
+      return 1;
+    }
+  }
+
+  auto lib = anari::loadLibrary("remote", statusFunc);
+  if (!lib) {
+    std::cerr << "Could not load the remote device library\n";
+    stopServer();
+    return 1;
+  }
+
+  auto d = anari::newDevice(lib, "default");
+  const char *hostname = g_hostname.c_str();
+  anariSetParameter(d, d, "server.hostname", ANARI_STRING, hostname);
+  anariSetParameter(d, d, "server.port", ANARI_UINT16, &g_port);
+  anariSetParameter(d, d, "server.sharedMemory", ANARI_BOOL, &g_sharedMemory);
+
+  double start = getCurrentTime();
+  waitForServer(d);
+  double connectSeconds = getCurrentTime() - start;
+
+  std::ostringstream out;
+  out << "{\n  \"library\": " << quote(g_libraryType)
+      << ",\n  \"sharedMemory\": " << (g_sharedMemory ? "true" : "false")
+      << ",\n  \"frameSize\": [" << g_width << ", " << g_height << "]"
+      << ",\n  \"connectSeconds\": " << connectSeconds << ",\n";
+
+  Counters before = getCounters(d);
+  start = getCurrentTime();
+
+  if (g_numMessages > 0)
+    benchmarkMessages(d, out);
+  if (g_arraySize > 0)
+    benchmarkArrayUpload(d, out);
+
+  out << "  \"scenes\": [\n";
+  for (size_t i = 0; i < g_scenes.size(); ++i) {
+    std::cerr << "Scene " << g_scenes[i].first << "/" << g_scenes[i].second
+              << "...\n";
+    benchmarkScene(d, g_scenes[i].first, g_scenes[i].second, out);
+    out << (i + 1 < g_scenes.size() ? ",\n" : "\n");
+  }
+  out << "  ],\n";
+
+  double seconds = getCurrentTime() - start;
+  Counters total = getCounters(d) - before;
+  out << "  \"total\": {";
+  writeTraffic(out, total, seconds);
+  out << ", \"codecs\": ";
+  writeCodecs(out, total);
+  out << "}\n}\n";
+
+  anari::release(d, d);
+  anari::unloadLibrary(lib);
+  stopServer();
+
+  std::ofstream file(g_outputFile);
+  file << out.str();
+  if (!file) {
+    std::cerr << "Could not write " << g_outputFile << "\n";
+    return 1;
+  }
+  std::cerr << "Wrote " << g_outputFile << "\n";
+
+  return 0;
+}
@@ -8,8 +8,10 @@
 #ifdef HAVE_TURBOJPEG
 #include <turbojpeg.h>
 #endif
-#include <map>
+#include <algorithm>
 #include <cstring>
+#include <map>
+#include <vector>
 #include "Logging.h"
 
 namespace remote {
@@ -26,6 +28,8 @@ CompressionFeatures getCompressionFeatures()
   cf.hasSNAPPY = true;
 #endif
 
+  cf.hasFloatDepth = true;
+
   return cf;
 }
 
@@ -35,7 +39,8 @@ CompressionFeatures getCompressionFeatures()
 
 #ifdef HAVE_TURBOJPEG
 
-static std::map<TurboJPEGOptions::PixelFormat, TJPF> MapPixelFormatTurboJPEG = {
+static const std::map<TurboJPEGOptions::PixelFormat, TJPF>
+    MapPixelFormatTurboJPEG = {
     {TurboJPEGOptions::PixelFormat::RGB, TJPF_RGB},
     {TurboJPEGOptions::PixelFormat::BGR, TJPF_BGR},
     {TurboJPEGOptions::PixelFormat::RGBX, TJPF_RGBX},
@@ -49,6 +54,32 @@ static std::map<TurboJPEGOptions::PixelFormat, TJPF> MapPixelFormatTurboJPEG = {
     {TurboJPEGOptions::PixelFormat::ARGB, TJPF_ARGB},
 };
 
+// Creating handles is expensive, so every thread keeps one of each around
+struct TurboJPEGHandle
+{
+  explicit TurboJPEGHandle(bool compress)
+      : handle(compress ? tjInitCompress() : tjInitDecompress())
+  {}
+  ~TurboJPEGHandle()
+  {
+    if (handle)
+      tjDestroy(handle);
+  }
+  tjhandle handle{nullptr};
+};
+
+static tjhandle threadCompressor()
+{
+  thread_local TurboJPEGHandle compressor(true);
+  return compressor.handle;
+}
+
+static tjhandle threadDecompressor()
+{
+  thread_local TurboJPEGHandle decompressor(false);
+  return decompressor.handle;
+}
+
 size_t getMaxCompressedBufferSizeTurboJPEG(TurboJPEGOptions options)
 {
   return tjBufSize(options.width, options.height, TJSAMP_444);
@@ -59,40 +90,38 @@ bool compressTurboJPEG(const uint8_t *dataIN,
     size_t &compressedSizeInBytesOUT,
     TurboJPEGOptions options)
 {
-  uint8_t *compressedImage = nullptr;
-  unsigned long jpegSize = 0;
-  tjhandle jpegCompressor = tjInitCompress();
+  tjhandle jpegCompressor = threadCompressor();
   if (jpegCompressor == nullptr) {
     LOG(logging::Level::Warning) << "turbojpeg error: " << tjGetErrorStr();
     return false;
   }
 
-  TJPF pixelFormat = MapPixelFormatTurboJPEG[options.pixelFormat];
+  TJPF pixelFormat = MapPixelFormatTurboJPEG.at(options.pixelFormat);
+
+  // Compress straight into 'dataOUT', which holds at least
+  // getMaxCompressedBufferSizeTurboJPEG() bytes
+  uint8_t *compressedImage = dataOUT;
+  unsigned long jpegSize = getMaxCompressedBufferSizeTurboJPEG(options);
 
   int tj_err = 0;
   tj_err = tjCompress2(jpegCompressor,
       dataIN,
       options.width,
-      0,
+      options.pitch,
       options.height,
       pixelFormat,
       &compressedImage,
       &jpegSize,
       TJSAMP_444,
       options.quality,
-      TJFLAG_FASTDCT);
+      TJFLAG_FASTDCT | TJFLAG_NOREALLOC);
   if (tj_err != 0) {
     LOG(logging::Level::Warning) << "turbojpeg error: " << tjGetErrorStr();
     return false;
   }
 
-  tjDestroy(jpegCompressor);
-
-  memcpy(dataOUT, compressedImage, jpegSize);
   compressedSizeInBytesOUT = jpegSize;
 
-  tjFree(compressedImage);
-
   return true;
 }
 
@@ -101,9 +130,11 @@ bool uncompressTurboJPEG(const uint8_t *dataIN,
     size_t compressedSizeInBytesIN,
     TurboJPEGOptions options)
 {
-  tjhandle jpegDecompressor = tjInitDecompress();
-  if (jpegDecompressor == nullptr)
+  tjhandle jpegDecompressor = threadDecompressor();
+  if (jpegDecompressor == nullptr) {
     LOG(logging::Level::Warning) << "turbojpeg error: " << tjGetErrorStr();
+    return false;
+  }
 
   uint32_t jpegSize(compressedSizeInBytesIN);
   int jpegWidth, jpegHeight, jpegSubsamp;
@@ -129,23 +160,22 @@ bool uncompressTurboJPEG(const uint8_t *dataIN,
     return false;
   }
 
-  TJPF pixelFormat = MapPixelFormatTurboJPEG[options.pixelFormat];
+  TJPF pixelFormat = MapPixelFormatTurboJPEG.at(options.pixelFormat);
   tj_err = tjDecompress2(jpegDecompressor,
       (uint8_t *)dataIN,
       jpegSize,
       dataOUT,
       options.width,
-      0,
+      options.pitch,
       options.height,
       pixelFormat,
       TJFLAG_FASTDCT);
 
   if (tj_err != 0) {
     LOG(logging::Level::Warning) << "turbojpeg error: " << tjGetErrorStr();
+    return false;
   }
 
-  tjDestroy(jpegDecompressor);
-
   return true;
 }
 
@@ -197,7 +227,15 @@ bool uncompressSNAPPY(const uint8_t *dataIN,
     size_t compressedSizeInBytesIN,
     SNAPPYOptions options)
 {
-  (void)options;
+  // The output buffer holds exactly options.inputSize bytes, so refuse
+  // streams which decode to anything else
+  size_t uncompressedSize = 0;
+  if (!snappy::GetUncompressedLength((const char *)dataIN,
+          compressedSizeInBytesIN,
+          &uncompressedSize)
+      || uncompressedSize != options.inputSize)
+    return false;
+
   return snappy::RawUncompress(
       (const char *)dataIN, compressedSizeInBytesIN, (char *)dataOUT);
 }
@@ -221,4 +259,179 @@ bool uncompressSNAPPY(const uint8_t *, uint8_t *, size_t, SNAPPYOptions)
 
 #endif
 
+// ==================================================================
+// Float depth
+// ==================================================================
+//
+// Depth values are predicted from their left, upper and upper-left
+// neighbors (the LOCO-I median predictor, on the float bits, which are
+// ordered like the values they represent for non-negative floats). The
+// zig-zag encoded residuals are split into four byte planes, high bytes
+// first, and zero bytes in each plane are run-length encoded. Smooth
+// surfaces leave mostly zeros in the upper planes, and background pixels
+// zeros in all of them.
+//
+// Layout: 4x { uint32 planeSize, plane }, where a plane is a sequence of
+// non-zero bytes, and zero bytes followed by a varint count of additional
+// zeros.
+
+static uint32_t quantizeDepth(uint32_t bits, uint32_t precisionBits)
+{
+  if (precisionBits >= 23 || (bits & 0x7f800000u) == 0x7f800000u)
+    return bits; // lossless, or inf/NaN
+
+  // Round to nearest, carrying into the exponent is fine unless that would
+  // round to inf
+  uint32_t dropped = 23 - precisionBits;
+  uint32_t mask = (1u << dropped) - 1;
+  uint32_t rounded = (bits + (1u << (dropped - 1))) & ~mask;
+  if ((rounded & 0x7f800000u) == 0x7f800000u)
+    return bits & ~mask;
+  return rounded;
+}
+
+static uint32_t predictDepth(const uint32_t *bits, size_t x, size_t y, size_t w)
+{
+  if (y == 0)
+    return x == 0 ? 0 : bits[x - 1];
+  uint32_t b = bits[(y - 1) * w + x];
+  if (x == 0)
+    return b;
+  uint32_t a = bits[y * w + x - 1];
+  uint32_t c = bits[(y - 1) * w + x - 1];
+  if (c >= std::max(a, b))
+    return std::min(a, b);
+  if (c <= std::min(a, b))
+    return std::max(a, b);
+  return a + b - c;
+}
+
+size_t getMaxCompressedBufferSizeFloatDepth(FloatDepthOptions options)
+{
+  // Worst case, every other byte is a single zero
+  size_t numPixels = size_t(options.width) * options.height;
+  return 4 * (sizeof(uint32_t) + 2 * numPixels);
+}
+
+bool compressFloatDepth(const float *dataIN,
+    uint8_t *dataOUT,
+    size_t &compressedSizeInBytesOUT,
+    FloatDepthOptions options)
+{
+  size_t w = options.width;
+  size_t numPixels = w * options.height;
+
+  // Reused across frames by each encoding thread
+  thread_local std::vector<uint32_t> bits, residuals;
+  bits.resize(numPixels);
+  residuals.resize(numPixels);
+  for (size_t i = 0; i < numPixels; ++i) {
+    uint32_t b;
+    memcpy(&b, dataIN + i, sizeof(b));
+    bits[i] = quantizeDepth(b, options.precisionBits);
+  }
+
+  for (size_t y = 0, i = 0; y < options.height; ++y) {
+    for (size_t x = 0; x < w; ++x, ++i) {
+      int32_t residual = int32_t(bits[i] - predictDepth(bits.data(), x, y, w));
+      residuals[i] = (uint32_t(residual) << 1) ^ uint32_t(residual >> 31);
+    }
+  }
+
+  uint8_t *out = dataOUT;
+  for (int plane = 3; plane >= 0; --plane) {
+    uint8_t *planeSize = out;
+    out += sizeof(uint32_t);
+    uint8_t *planeBegin = out;
+
+    size_t zeros = 0;
+    auto flushZeros = [&]() {
+      if (zeros == 0)
+        return;
+      *out++ = 0;
+      for (size_t n = zeros - 1; ; n >>= 7) {
+        *out++ = uint8_t(n & 0x7f) | (n > 0x7f ? 0x80 : 0);
+        if (n <= 0x7f)
+          break;
+      }
+      zeros = 0;
+    };
+
+    for (size_t i = 0; i < numPixels; ++i) {
+      uint8_t byte = uint8_t(residuals[i] >> (plane * 8));
+      if (byte == 0) {
+        zeros++;
+      } else {
+        flushZeros();
+        *out++ = byte;
+      }
+    }
+    flushZeros();
+
+    uint32_t size = uint32_t(out - planeBegin);
+    memcpy(planeSize, &size, sizeof(size));
+  }
+
+  compressedSizeInBytesOUT = out - dataOUT;
+  return true;
+}
+
+bool uncompressFloatDepth(const uint8_t *dataIN,
+    float *dataOUT,
+    size_t compressedSizeInBytesIN,
+    FloatDepthOptions options)
+{
+  size_t w = options.width;
+  size_t numPixels = w * options.height;
+
+  thread_local std::vector<uint32_t> bits;
+  bits.assign(numPixels, 0);
+
+  const uint8_t *in = dataIN;
+  const uint8_t *end = dataIN + compressedSizeInBytesIN;
+  for (int plane = 3; plane >= 0; --plane) {
+    uint32_t size;
+    if (end - in < ptrdiff_t(sizeof(size)))
+      return false;
+    memcpy(&size, in, sizeof(size));
+    in += sizeof(size);
+    if (end - in < ptrdiff_t(size))
+      return false;
+
+    const uint8_t *planeEnd = in + size;
+    size_t i = 0;
+    while (in < planeEnd) {
+      uint8_t byte = *in++;
+      if (byte != 0) {
+        if (i >= numPixels)
+          return false;
+        bits[i++] |= uint32_t(byte) << (plane * 8);
+        continue;
+      }
+      size_t zeros = 1;
+      for (int shift = 0; in < planeEnd; shift += 7) {
+        uint8_t v = *in++;
+        zeros += size_t(v & 0x7f) << shift;
+        if (!(v & 0x80))
+          break;
+      }
+      i += zeros;
+    }
+    if (i != numPixels)
+      return false;
+  }
+
+  // Residuals were stored in place, undo the prediction in scan order
+  for (size_t y = 0, i = 0; y < options.height; ++y) {
+    for (size_t x = 0; x < w; ++x, ++i) {
+      uint32_t zigzag = bits[i];
+      uint32_t residual = (zigzag >> 1) ^ (0u - (zigzag & 1));
+      bits[i] = residual + predictDepth(bits.data(), x, y, w);
+    }
+  }
+
+  memcpy(dataOUT, bits.data(), numPixels * sizeof(uint32_t));
+  return true;
+}
+
 } // namespace remote
@@ -12,6 +12,7 @@ struct CompressionFeatures
 {
   int32_t hasTurboJPEG{false};
   int32_t hasSNAPPY{false};
+  int32_t hasFloatDepth{false};
 };
 
 CompressionFeatures getCompressionFeatures();
@@ -41,6 +42,8 @@ struct TurboJPEGOptions
   int height;
   PixelFormat pixelFormat;
   int quality = 80;
+  // Bytes per row of the uncompressed image, 0 if rows are tightly packed
+  int pitch = 0;
 };
 
 size_t getMaxCompressedBufferSizeTurboJPEG(TurboJPEGOptions options);
@@ -76,4 +79,29 @@ bool uncompressSNAPPY(const uint8_t *dataIN,
     size_t compressedSizeInBytesIN,
     SNAPPYOptions options);
 
+// ==================================================================
+// Float depth (built in, lossless unless precisionBits < 23)
+// ==================================================================
+
+struct FloatDepthOptions
+{
+  uint32_t width;
+  uint32_t height;
+  // Mantissa bits kept of finite values; fewer bits compress better, with a
+  // relative error below 2^-precisionBits (for normal floats)
+  uint32_t precisionBits = 23;
+};
+
+size_t getMaxCompressedBufferSizeFloatDepth(FloatDepthOptions options);
+
+bool compressFloatDepth(const float *dataIN,
+    uint8_t *dataOUT,
+    size_t &compressedSizeInBytesOUT,
+    FloatDepthOptions options);
+
+bool uncompressFloatDepth(const uint8_t *dataIN,
+    float *dataOUT,
+    size_t compressedSizeInBytesIN,
+    FloatDepthOptions options);
+
 } // namespace remote
@@ -3,17 +3,20 @@
 
 #include "Device.h"
 #include <anari/anari_cpp.hpp>
+#include <algorithm>
 #include <climits>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <random>
 #include <sstream>
 #include "ArrayInfo.h"
 #include "Compression.h"
 #include "Frame.h"
 #include "Logging.h"
 #include "ObjectDesc.h"
+#include "SharedMemory.h"
 #include "async/connection.h"
 #include "async/connection_manager.h"
 #include "async/work_queue.h"
@@ -28,6 +31,12 @@
 using namespace std::placeholders;
 using namespace helium;
 
+// Size of each of the shared memory rings, if the server is on the same host
+static constexpr size_t ringCapacity = size_t(32) << 20;
+
+// Seconds to wait for space in a ring before sending through the socket
+static constexpr double ringTimeout = 1.0;
+
 inline double getCurrentTime()
 {
 #ifndef _WIN32
@@ -153,14 +162,33 @@ ANARIArray3D Device::newArray3D(const void *appMemory,
 
 void *Device::mapArray(ANARIArray array)
 {
+  std::unique_lock l(sync[SyncPoints::MapArray].mtx);
+  ArrayData &data = arrays[array];
+
+  // Nothing to fetch: contents are undefined until the app writes them
+  if (!data.shadowed && (!data.contentsOnServer || !remoteDevice)) {
+    data.value.resize(data.info.getSizeInBytes());
+    data.shadowed = true;
+  }
+
+  if (data.shadowed) {
+    LOG(logging::Level::Info) << "Array mapped (client-side): " << array;
+    return data.value.data();
+  }
+
+  l.unlock();
+
   auto buf = std::make_shared<Buffer>();
   buf->write(ObjectDesc(remoteDevice, array));
   write(MessageType::MapArray, buf);
 
-  std::unique_lock l(sync[SyncPoints::MapArray].mtx);
-  ArrayData &data = arrays[array];
+  l.lock();
   sync[SyncPoints::MapArray].cv.wait(
       l, [&]() { return (std::int64_t)data.value.size() == data.bytesExpected; });
+  data.shadowed = true;
+  data.contentsOnServer = false;
+  if (deltaArrayTransfer)
+    data.reference = data.value;
   l.unlock();
 
   LOG(logging::Level::Info) << "Array mapped: " << array;
@@ -170,18 +198,35 @@ void *Device::mapArray(ANARIArray array)
 
 void Device::unmapArray(ANARIArray array)
 {
-  auto buf = std::make_shared<Buffer>();
-  buf->write(ObjectDesc(remoteDevice, array));
-  uint64_t numBytes = arrays[array].value.size();
-  buf->write(arrays[array].value.data(), numBytes);
-  write(MessageType::UnmapArray, buf);
-
   std::unique_lock l(sync[SyncPoints::MapArray].mtx);
-  ArrayData &data = arrays[array];
-  sync[SyncPoints::MapArray].cv.wait(l, [&]() { return data.value.empty(); });
+  auto it = arrays.find(array);
+  if (it == arrays.end() || !it->second.shadowed) {
+    LOG(logging::Level::Warning) << "Array was not mapped: " << array;
+    return;
+  }
+  // The contents are sent without holding the lock, so keep the entry from
+  // being erased by a concurrent release() in the meantime
+  ArrayData &data = it->second;
+  data.refCount++;
   l.unlock();
 
-  arrays.erase(array);
+  bool haveReference = data.reference.size() == data.value.size();
+  sendArrayData(array,
+      data.info,
+      data.value.data(),
+      haveReference ? data.reference.data() : nullptr);
+
+  l.lock();
+  if (--data.refCount == 0)
+    arrays.erase(it);
+  else if (deltaArrayTransfer)
+    data.reference = data.value;
+  l.unlock();
+
+  // The server applies messages in order, no need to wait for it here
+  auto buf = std::make_shared<Buffer>();
+  buf->write(ObjectDesc(remoteDevice, array));
+  write(MessageType::UnmapArray, buf);
 
   LOG(logging::Level::Info) << "Array unmapped: " << array;
 }
@@ -275,6 +320,25 @@ void Device::setParameter(
         return;
       }
       server.port = *(unsigned short *)mem;
+    } else if (std::string(name) == "server.sharedMemory") {
+      if (remoteDevice != nullptr) {
+        LOG(logging::Level::Error)
+            << "server.sharedMemory must be set after device creation";
+        return;
+      }
+      if (type == ANARI_BOOL)
+        useSharedMemory = *(const uint8_t *)mem != 0;
+    } else if (std::string(name) == "frame.inFlight") {
+      if (type == ANARI_UINT32)
+        framesInFlight = std::max(*(const uint32_t *)mem, 1u);
+    } else if (std::string(name) == "array.delta") {
+      if (type == ANARI_BOOL)
+        deltaArrayTransfer = *(const uint8_t *)mem != 0;
+    } else if (std::string(name) == "message.batchSize") {
+      if (type == ANARI_UINT32) {
+        flush();
+        batchSize = *(const uint32_t *)mem;
+      }
     }
     // device parameter, don't write to socket!
     return;
@@ -351,14 +415,35 @@ void Device::release(ANARIObject object)
     return;
   }
 
-  // If this is  a frame, delete it from map
-  if (frames.find(object) != frames.end())
-    frames.erase(object);
+  // If this is  a frame, delete it from map once no more of its channels are
+  // in flight
+  {
+    std::unique_lock l(sync[SyncPoints::FrameIsReady].mtx);
+    auto it = frames.find(object);
+    if (it != frames.end()) {
+      Frame &frm = it->second;
+      sync[SyncPoints::FrameIsReady].cv.wait(
+          l, [&]() { return frm.frameID >= frm.numSubmitted; });
+      frames.erase(it);
+    }
+  }
+
+  // Drop the client-side shadow once the app can no longer map the array
+  {
+    std::unique_lock l(sync[SyncPoints::MapArray].mtx);
+    auto it = arrays.find((ANARIArray)object);
+    if (it != arrays.end() && --it->second.refCount == 0)
+      arrays.erase(it);
+  }
 
   auto buf = std::make_shared<Buffer>();
   buf->write(makeObjectDesc(object));
   write(MessageType::Release, buf);
 
+  // Nothing might follow that would send the batch
+  if (object == (ANARIObject)this)
+    flush();
+
   LOG(logging::Level::Info) << "Object released: " << object;
 }
 
@@ -369,6 +454,13 @@ void Device::retain(ANARIObject object)
     return;
   }
 
+  {
+    std::unique_lock l(sync[SyncPoints::MapArray].mtx);
+    auto it = arrays.find((ANARIArray)object);
+    if (it != arrays.end())
+      it->second.refCount++;
+  }
+
   auto buf = std::make_shared<Buffer>();
   buf->write(makeObjectDesc(object));
   write(MessageType::Retain, buf);
@@ -390,6 +482,24 @@ int Device::getProperty(ANARIObject object,
     return 0;
   }
 
+  // Traffic counters are kept on the client
+  if (object == (ANARIObject)this && getCounter(name, type, mem, size))
+    return 1;
+
+  // The object descriptor holds the remote device handle, so connect first
+  if (!remoteDevice && !initClient())
+    return 0;
+
+  // Wait for the reply to this query, not an earlier one
+  std::unique_lock l(sync[SyncPoints::Properties].mtx);
+  properties.erase(std::remove_if(properties.begin(),
+                       properties.end(),
+                       [name](const Property &prop) {
+                         return prop.name == std::string(name);
+                       }),
+      properties.end());
+  l.unlock();
+
   auto buf = std::make_shared<Buffer>();
   buf->write(makeObjectDesc(object));
   buf->write(std::string(name));
@@ -398,7 +508,7 @@ int Device::getProperty(ANARIObject object,
   buf->write(mask);
   write(MessageType::GetProperty, buf);
 
-  std::unique_lock l(sync[SyncPoints::Properties].mtx);
+  l.lock();
   std::vector<Property>::iterator it;
   sync[SyncPoints::Properties].cv.wait(l, [this, &it, name]() {
     it = std::find_if(
@@ -422,6 +532,49 @@ int Device::getProperty(ANARIObject object,
   return result;
 }
 
+bool Device::getCounter(
+    const char *name, ANARIDataType type, void *mem, uint64_t size)
+{
+  std::string str(name);
+  const std::string prefix = "remote.";
+  if (str.compare(0, prefix.size(), prefix) != 0)
+    return false;
+  str = str.substr(prefix.size());
+
+  const std::atomic<uint64_t> *counter = nullptr;
+  if (str == "calls")
+    counter = &counters.calls;
+  else if (str == "messagesSent")
+    counter = &counters.messagesSent;
+  else if (str == "bytesSent")
+    counter = &counters.bytesSent;
+  else if (str == "messagesReceived")
+    counter = &counters.messagesReceived;
+  else if (str == "bytesReceived")
+    counter = &counters.bytesReceived;
+
+  std::pair<const char *, const CodecCounters *> codecs[] = {
+      {"raw", &counters.raw},
+      {"sharedMemory", &counters.sharedMemory},
+      {"turbojpeg", &counters.turboJPEG},
+      {"snappy", &counters.snappy},
+      {"floatDepth", &counters.floatDepth},
+  };
+  for (auto &codec : codecs) {
+    if (str == std::string(codec.first) + ".rawBytes")
+      counter = &codec.second->rawBytes;
+    else if (str == std::string(codec.first) + ".encodedBytes")
+      counter = &codec.second->encodedBytes;
+  }
+
+  if (!counter || type != ANARI_UINT64 || size < sizeof(uint64_t))
+    return false;
+
+  uint64_t value = counter->load();
+  memcpy(mem, &value, sizeof(value));
+  return true;
+}
+
 const char **Device::getObjectSubtypes(ANARIDataType objectType)
 {
   auto it = std::find_if(objectSubtypes.begin(),
@@ -432,6 +585,9 @@ const char **Device::getObjectSubtypes(ANARIDataType objectType)
     return (const char **)it->value.data();
   }
 
+  if (!remoteDevice && !initClient())
+    return nullptr;
+
   auto buf = std::make_shared<Buffer>();
   buf->write(ObjectDesc(remoteDevice, remoteDevice));
   buf->write(objectType);
@@ -469,6 +625,9 @@ const void *Device::getObjectInfo(ANARIDataType objectType,
     return (*it)->info.data();
   }
 
+  if (!remoteDevice && !initClient())
+    return nullptr;
+
   auto buf = std::make_shared<Buffer>();
   buf->write(ObjectDesc(remoteDevice, remoteDevice));
   buf->write(objectType);
@@ -523,6 +682,9 @@ const void *Device::getParameterInfo(ANARIDataType objectType,
     return (*it)->info.data();
   }
 
+  if (!remoteDevice && !initClient())
+    return nullptr;
+
   auto buf = std::make_shared<Buffer>();
   buf->write(ObjectDesc(remoteDevice, remoteDevice));
   buf->write(objectType);
@@ -583,25 +745,26 @@ const void *Device::frameBufferMap(ANARIFrame fb,
     return nullptr;
   }
 
-  Frame &frm = frames[fb];
-
   // this is a no-op if we already waited:
   frameReady(fb, ANARI_WAIT);
 
-  *width = frm.size[0];
-  *height = frm.size[1];
+  std::unique_lock l(sync[SyncPoints::FrameIsReady].mtx);
+  Frame &frm = frames[fb];
+
+  *width = frm.mapped.size[0];
+  *height = frm.mapped.size[1];
 
   if (std::string(channel) == "channel.color")
-    *pixelType = frm.colorType;
+    *pixelType = frm.mapped.colorType;
   else if (std::string(channel) == "channel.depth")
-    *pixelType = frm.depthType;
+    *pixelType = frm.mapped.depthType;
 
   frm.state = Frame::Mapped; // this needs to be done on a per-channel level!!
 
   if (std::string(channel) == "channel.color")
-    return frm.color.data();
+    return frm.mapped.color.data();
   else if (std::string(channel) == "channel.depth")
-    return frm.depth.data();
+    return frm.mapped.depth.data();
 
   return nullptr;
 }
@@ -613,8 +776,16 @@ void Device::frameBufferUnmap(ANARIFrame fb, const char *channel)
     return;
   }
 
+  std::unique_lock l(sync[SyncPoints::FrameIsReady].mtx);
   Frame &frm = frames[fb];
   frm.state = Frame::Unmapped; // this needs to be done on a per-channel level!!
+
+  // A frame that completed while mapped becomes visible now
+  if (frm.receivedComplete)
+    frm.swapChannels();
+
+  l.unlock();
+  sync[SyncPoints::FrameIsReady].cv.notify_all();
 }
 
 //--- Frame Rendering ---------------------------------
@@ -631,22 +802,29 @@ void Device::renderFrame(ANARIFrame frame)
     return;
   }
 
+  // Without a server the frame would never complete
+  if (!remoteDevice && !initClient())
+    return;
+
   timing.beforeRenderFrame = getCurrentTime();
 
   LOG(logging::Level::Stats) << '\n';
 
-  Frame &frm = frames[frame];
-
-  // block till frame was unmapped
+  // block till frame was unmapped, and till there is room in the pipeline
   std::unique_lock l(sync[SyncPoints::FrameIsReady].mtx);
-  sync[SyncPoints::FrameIsReady].cv.wait(
-      l, [&]() { return frm.state != Frame::Mapped; });
+  Frame &frm = frames[frame];
+  sync[SyncPoints::FrameIsReady].cv.wait(l, [&]() {
+    return frm.state != Frame::Mapped
+        && frm.numSubmitted - frm.frameID < framesInFlight;
+  });
+  frm.numSubmitted++;
+  frm.submitTimes.push_back(timing.beforeRenderFrame);
+  frm.state = Frame::Render;
   l.unlock();
 
   auto buf = std::make_shared<Buffer>();
   buf->write(ObjectDesc(remoteDevice, frame));
   write(MessageType::RenderFrame, buf);
-  frm.state = Frame::Render;
 }
 
 int Device::frameReady(ANARIFrame frame, ANARIWaitMask m)
@@ -656,40 +834,30 @@ int Device::frameReady(ANARIFrame frame, ANARIWaitMask m)
     return 0;
   }
 
+  std::unique_lock l(sync[SyncPoints::FrameIsReady].mtx);
   Frame &frm = frames[frame];
 
-  if (m != ANARI_WAIT) {
-    if (frm.frameID == 0)
-      LOG(logging::Level::Warning)
-          << "Performance: anariFrameReady() will wait";
-    m = ANARI_WAIT;
-  }
+  if (frm.numSubmitted == 0)
+    return false;
 
-  if (frm.state == Frame::Render) {
-    auto buf = std::make_shared<Buffer>();
-    buf->write(ObjectDesc(remoteDevice, frame));
-    buf->write(m);
-    write(MessageType::FrameReady, buf);
-    if (m == ANARI_WAIT) { // TODO: mask is probably a bitmask?!
-      // block till device ID was returned by remote
-      std::unique_lock l(sync[SyncPoints::FrameIsReady].mtx);
-      sync[SyncPoints::FrameIsReady].cv.wait(
-          l, [&]() { return frm.state == Frame::Ready; });
-      l.unlock();
+  // With K frames in flight, the frame submitted K-1 frames ago is the one
+  // the application gets to see
+  auto ready = [&]() {
+    return frm.frameID > 0
+        && frm.frameID + framesInFlight > frm.numSubmitted;
+  };
 
-      timing.afterFrameReady = getCurrentTime();
+  if (m != ANARI_WAIT)
+    return ready();
 
-      double t = timing.afterFrameReady - timing.beforeRenderFrame;
-      LOG(logging::Level::Stats) << t << " sec. until frameReady";
-      return true;
-    }
+  sync[SyncPoints::FrameIsReady].cv.wait(l, ready);
+  l.unlock();
 
-    // TODO: implement for ANARI_NO_WAIT. Returns true
-    // only when the frame was rendered
-    return false;
-  }
+  timing.afterFrameReady = getCurrentTime();
 
-  return false;
+  double t = timing.afterFrameReady - timing.beforeRenderFrame;
+  LOG(logging::Level::Stats) << t << " sec. until frameReady";
+  return true;
 }
 
 void Device::discardFrame(ANARIFrame) {}
@@ -725,6 +893,10 @@ Device::~Device() {}
 
 ANARIObject Device::registerNewObject(ANARIDataType type, std::string subtype)
 {
+  // IDs are derived from the remote device handle, so connect first
+  if (!remoteDevice)
+    initClient();
+
   uint64_t objectID = nextObjectID++;
   ANARIObject object;
   memcpy(&object, &objectID, sizeof(objectID));
@@ -754,6 +926,10 @@ ANARIArray Device::registerNewArray(ANARIDataType type,
     uint64_t numItems2,
     uint64_t numItems3)
 {
+  // IDs are derived from the remote device handle, so connect first
+  if (!remoteDevice)
+    initClient();
+
   uint64_t objectID = nextObjectID++;
   ANARIArray array;
   memcpy(&array, &objectID, sizeof(objectID));
@@ -771,11 +947,31 @@ ANARIArray Device::registerNewArray(ANARIDataType type,
 
   ArrayInfo info(type, elementType, numItems1, numItems2, numItems3);
 
-  if (appMemory)
-    buf->write((const char *)appMemory, info.getSizeInBytes());
+  {
+    std::unique_lock l(sync[SyncPoints::MapArray].mtx);
+    ArrayData &data = arrays[array];
+    data.info = info;
+    data.contentsOnServer = appMemory != nullptr;
+    if (appMemory && deltaArrayTransfer) {
+      // The reference doubles as the shadow, saving the first map's fetch
+      const char *bytes = (const char *)appMemory;
+      data.value.assign(bytes, bytes + info.getSizeInBytes());
+      data.reference = data.value;
+      data.shadowed = true;
+      data.contentsOnServer = false;
+    }
+  }
 
   write(MessageType::NewArray, buf);
 
+  // Contents follow in (compressed) chunks, like on unmap
+  if (appMemory) {
+    sendArrayData(array, info, (const char *)appMemory);
+    auto unmapBuf = std::make_shared<Buffer>();
+    unmapBuf->write(ObjectDesc(remoteDevice, array));
+    write(MessageType::UnmapArray, unmapBuf);
+  }
+
   LOG(logging::Level::Info)
       << "Array created: " << anari::toString(type) << ", sending "
       << prettyBytes(buf->size()) << ", objectID: " << objectID;
@@ -791,33 +987,155 @@ ObjectDesc Device::makeObjectDesc(ANARIObject object) const
   return ObjectDesc(remoteDevice, object);
 }
 
-void Device::initClient()
+void Device::sendArrayData(ANARIArray array,
+    const ArrayInfo &info,
+    const char *data,
+    const char *reference)
 {
+  // Chunks are compressed here while the work queue sends the previous ones
+  constexpr size_t targetChunkSize = size_t(4) << 20;
+
+  CompressionFeatures cf = getCompressionFeatures();
+  bool compressionSNAPPY = cf.hasSNAPPY && server.compression.hasSNAPPY;
+
+  // The server translates object handles in place, so it can't apply XORs
+  bool deltaXOR = reference && !anari::isObject(info.elementType);
+
+  // Keep elements whole so the server can translate object handles per chunk
+  size_t elementSize = anari::sizeOf(info.elementType);
+  size_t chunkSize = std::max(targetChunkSize / elementSize, size_t(1))
+      * elementSize;
+  size_t numBytes = info.getSizeInBytes();
+
+  std::vector<uint8_t> delta;
+  std::vector<uint8_t> compressed;
+  size_t sentBytes = 0;
+  size_t skippedBytes = 0;
+
+  for (size_t offset = 0; offset < numBytes; offset += chunkSize) {
+    uint64_t chunkBytes = std::min(chunkSize, numBytes - offset);
+    const char *chunk = data + offset;
+    uint32_t encoding = ArrayDataEncoding::Raw;
+
+    if (reference) {
+      const char *ref = reference + offset;
+      if (std::memcmp(chunk, ref, chunkBytes) == 0) {
+        skippedBytes += chunkBytes;
+        continue;
+      }
+
+      if (deltaXOR) {
+        delta.resize(chunkBytes);
+        for (size_t i = 0; i < chunkBytes; ++i)
+          delta[i] = uint8_t(chunk[i]) ^ uint8_t(ref[i]);
+        chunk = (const char *)delta.data();
+        encoding |= ArrayDataEncoding::XOR;
+      }
+    }
+
+    auto buf = std::make_shared<Buffer>();
+    buf->write(ObjectDesc(remoteDevice, array));
+    buf->write(uint64_t(offset));
+    buf->write(chunkBytes);
+
+    // Same host: copy the chunk to shared memory, compressing isn't worth it
+    uint64_t ringPos = 0;
+    if (toServer.reserve(chunkBytes, ringPos, ringTimeout)) {
+      memcpy(toServer.data(ringPos, chunkBytes), chunk, chunkBytes);
+      buf->write(encoding | ArrayDataEncoding::SharedMemory);
+      buf->write(ringPos);
+      sentBytes += chunkBytes;
+      counters.sharedMemory.add(chunkBytes, chunkBytes);
+      write(MessageType::ArrayData, buf);
+      continue;
+    }
+
+    size_t compressedSize = 0;
+    if (compressionSNAPPY) {
+      SNAPPYOptions options;
+      options.inputSize = chunkBytes;
+      compressed.resize(getMaxCompressedBufferSizeSNAPPY(options));
+      if (!compressSNAPPY((const uint8_t *)chunk,
+              compressed.data(),
+              compressedSize,
+              options))
+        compressedSize = 0;
+    }
+
+    if (compressedSize != 0 && compressedSize < chunkBytes) {
+      buf->write(encoding | ArrayDataEncoding::SNAPPY);
+      buf->write(uint64_t(compressedSize));
+      buf->write((const char *)compressed.data(), compressedSize);
+      counters.snappy.add(chunkBytes, compressedSize);
+    } else {
+      buf->write(encoding);
+      buf->write(chunk, chunkBytes);
+      counters.raw.add(chunkBytes, chunkBytes);
+    }
+
+    sentBytes += buf->size();
+    write(MessageType::ArrayData, buf);
+  }
+
+  LOG(logging::Level::Stats)
+      << "Array data: raw " << prettyBytes(numBytes) << ", sent "
+      << prettyBytes(sentBytes) << ", unchanged " << prettyBytes(skippedBytes)
+      << ", objectID: " << (uint64_t)array;
+}
+
+bool Device::initClient()
+{
+  if (connectionFailed)
+    return false;
+
   connect(server.hostname, server.port);
   run();
 
   // wait till server accepted connection
   std::unique_lock l1(sync[SyncPoints::ConnectionEstablished].mtx);
   sync[SyncPoints::ConnectionEstablished].cv.wait(
-      l1, [this]() { return conn; });
+      l1, [this]() { return conn || connectionFailed; });
   l1.unlock();
 
+  if (connectionFailed)
+    return false;
+
   CompressionFeatures cf = getCompressionFeatures();
 
+  // Offer shared memory rings to a server on the same host; the server
+  // confirms that it could map them along with the device handle
+  std::string ringName;
+  uint64_t ringToken = 0;
+  if (useSharedMemory && conn->is_local()) {
+    std::random_device rd;
+    ringToken = (uint64_t(rd()) << 32) | rd();
+    ringName = makeSharedMemoryName();
+    if (!toServer.create(ringName + ".srv", ringCapacity, ringToken)
+        || !fromServer.create(ringName + ".cli", ringCapacity, ringToken)) {
+      LOG(logging::Level::Warning)
+          << "Could not create shared memory, using the socket only";
+      toServer.reset();
+      fromServer.reset();
+      ringName.clear();
+    }
+  }
+
   // request remote device to be created, send other client info along
   auto buf = std::make_shared<Buffer>();
   buf->write(ObjectDesc{});
   buf->write(remoteSubtype);
   buf->write(cf);
+  buf->write(ringName);
+  buf->write(ringToken);
   // write(MessageType::NewDevice, buf);
   //  post to queue directly: write() would call initClient() recursively!
   queue.post(std::bind(&Device::writeImpl, this, MessageType::NewDevice, buf));
 
-  // block till device ID was returned by remote
+  // block till device ID was returned by remote, or the server refused
   std::unique_lock l2(sync[SyncPoints::DeviceHandleRemote].mtx);
   sync[SyncPoints::DeviceHandleRemote].cv.wait(
-      l2, [this]() { return remoteDevice; });
-  l2.unlock();
+      l2, [this]() { return remoteDevice || connectionFailed; });
+  return remoteDevice != nullptr;
 }
 
 void Device::connect(std::string host, unsigned short port)
@@ -840,22 +1158,72 @@ void Device::run()
   queue.run_in_thread();
 }
 
+// Messages the server does not reply to, and that are usually small and
+// frequent (e.g., when building a scene)
+static bool isBatchable(unsigned type)
+{
+  return type == MessageType::NewObject || type == MessageType::NewArray
+      || type == MessageType::SetParam || type == MessageType::UnsetParam
+      || type == MessageType::UnsetAllParams
+      || type == MessageType::CommitParams || type == MessageType::Release
+      || type == MessageType::Retain;
+}
+
 void Device::write(unsigned type, std::shared_ptr<Buffer> buf)
 {
-  if (!remoteDevice)
-    initClient();
+  if (!remoteDevice && !initClient())
+    return;
+
+  counters.calls++;
+
+  if (batchSize > 0 && isBatchable(type) && buf->size() < batchSize) {
+    std::unique_lock l(batch.mtx);
+    double now = getCurrentTime();
+    if (!batch.buffer) {
+      batch.buffer = std::make_shared<Buffer>();
+      batch.startTime = now;
+    }
+    batch.buffer->write(uint32_t(type));
+    batch.buffer->write(uint32_t(buf->size()));
+    batch.buffer->write(buf->data(), buf->size());
+    bool full = batch.buffer->size() >= batchSize
+        || now - batch.startTime >= batchDelay;
+    l.unlock();
+
+    if (full)
+      flush();
+    return;
+  }
+
+  // Keep messages in order
+  flush();
 
   queue.post(std::bind(&Device::writeImpl, this, type, buf));
 }
 
 void Device::write(unsigned type, const void *begin, const void *end)
 {
-  if (!remoteDevice)
-    initClient();
+  if (!remoteDevice && !initClient())
+    return;
+
+  counters.calls++;
+
+  flush();
 
   queue.post(std::bind(&Device::writeImpl2, this, type, begin, end));
 }
 
+void Device::flush()
+{
+  std::unique_lock l(batch.mtx);
+  if (!batch.buffer)
+    return;
+
+  queue.post(
+      std::bind(&Device::writeImpl, this, MessageType::Batch, batch.buffer));
+  batch.buffer.reset();
+}
+
 bool Device::handleNewConnection(
     async::connection_pointer new_conn, std::error_code const &e)
 {
@@ -864,6 +1232,7 @@ bool Device::handleNewConnection(
         << "ANARIDevice client: could not connect to server. Error: "
         << e.message();
     manager->stop();
+    failConnection();
     return false;
   }
 
@@ -891,10 +1260,14 @@ void Device::handleMessage(async::connection::reason reason,
   if (e) {
     LOG(logging::Level::Error) << "ANARIDevice client: error" << e.message();
     manager->stop();
+    failConnection();
     return;
   }
 
   if (reason == async::connection::Read) {
+    counters.messagesReceived++;
+    counters.bytesReceived += message->size();
+
     if (message->type() == MessageType::DeviceHandle) {
       std::unique_lock l(sync[SyncPoints::DeviceHandleRemote].mtx);
 
@@ -909,13 +1282,40 @@ void Device::handleMessage(async::connection::reason reason,
       server.compression = *(CompressionFeatures *)msg;
       msg += sizeof(CompressionFeatures);
 
+      int32_t sharedMemory = false;
+      if (msg + sizeof(sharedMemory) <= message->data() + message->size())
+        memcpy(&sharedMemory, msg, sizeof(sharedMemory));
+
+      // Both sides have the rings mapped now, or won't use them
+      if (sharedMemory) {
+        toServer.unlink();
+        fromServer.unlink();
+      } else {
+        toServer.reset();
+        fromServer.reset();
+      }
+
       l.unlock();
+
+      // A null handle is the server turning this session down
+      if (!remoteDevice) {
+        LOG(logging::Level::Error)
+            << "ANARIDevice client: server refused the session, it has "
+               "reached its maximum number of sessions";
+        failConnection();
+        return;
+      }
+
       sync[SyncPoints::DeviceHandleRemote].cv.notify_all();
       LOG(logging::Level::Info) << "Got remote device handle: " << remoteDevice;
       LOG(logging::Level::Info)
           << "Server has TurboJPEG: " << server.compression.hasTurboJPEG;
       LOG(logging::Level::Info)
           << "Server has SNAPPY: " << server.compression.hasSNAPPY;
+      LOG(logging::Level::Info)
+          << "Server has float depth: " << server.compression.hasFloatDepth;
+      LOG(logging::Level::Info)
+          << "Using shared memory: " << toServer.valid();
     } else if (message->type() == MessageType::ArrayMapped) {
       std::unique_lock l(sync[SyncPoints::MapArray].mtx);
 
@@ -932,22 +1332,37 @@ void Device::handleMessage(async::connection::reason reason,
       memcpy(arrays[arr].value.data(), msg, numBytes);
       l.unlock();
       sync[SyncPoints::MapArray].cv.notify_all();
-    } else if (message->type() == MessageType::ArrayUnmapped) {
-      std::unique_lock l(sync[SyncPoints::UnmapArray].mtx);
-      char *msg = message->data();
-      ANARIArray arr = *(ANARIArray *)message->data();
-      arrays[arr].bytesExpected = -1;
-      arrays[arr].value.resize(0);
-      l.unlock();
-      sync[SyncPoints::MapArray].cv.notify_all();
     } else if (message->type() == MessageType::FrameIsReady) {
       assert(message->size() == sizeof(Handle));
       ANARIObject hnd = *(ANARIObject *)message->data();
+
+      std::unique_lock l(sync[SyncPoints::FrameIsReady].mtx);
       Frame &frm = frames[hnd];
-      frm.state = Frame::Ready;
+      frm.receivedComplete = true;
+      frm.receiving = false;
+      frm.colorBaseReady = false;
+      if (frm.state != Frame::Mapped) {
+        frm.swapChannels();
+        frm.state = Frame::Ready;
+      }
       frm.frameID++;
+
+      double now = getCurrentTime();
+      if (!frm.submitTimes.empty()) {
+        double latency = now - frm.submitTimes.front();
+        frm.submitTimes.pop_front();
+        LOG(logging::Level::Stats)
+            << latency << " sec. pipeline latency (" << framesInFlight
+            << " frame(s) in flight)";
+      }
+      if (frm.lastReceiveTime > 0.0) {
+        LOG(logging::Level::Stats) << 1.0 / (now - frm.lastReceiveTime)
+                                   << " frames/sec. pipeline throughput";
+      }
+      frm.lastReceiveTime = now;
+
+      l.unlock();
       sync[SyncPoints::FrameIsReady].cv.notify_all();
-      // LOG(logging::Level::Info) << "Frame state: " << frameState;
     } else if (message->type() == MessageType::Property) {
       std::unique_lock l(sync[SyncPoints::Properties].mtx);
 
@@ -1089,25 +1504,118 @@ void Device::handleMessage(async::connection::reason reason,
       type = *(uint32_t *)(message->data() + off);
       off += sizeof(type);
 
+      uint32_t firstRow, numRows, firstColumn, numColumns, flags, encoding;
+
+      firstRow = *(uint32_t *)(message->data() + off);
+      off += sizeof(firstRow);
+
+      numRows = *(uint32_t *)(message->data() + off);
+      off += sizeof(numRows);
+
+      firstColumn = *(uint32_t *)(message->data() + off);
+      off += sizeof(firstColumn);
+
+      numColumns = *(uint32_t *)(message->data() + off);
+      off += sizeof(numColumns);
+
+      flags = *(uint32_t *)(message->data() + off);
+      off += sizeof(flags);
+
+      encoding = *(uint32_t *)(message->data() + off);
+      off += sizeof(encoding);
+
+      if (firstRow + numRows > height || firstColumn + numColumns > width) {
+        LOG(logging::Level::Error) << "Received stripe exceeds frame size";
+        return;
+      }
+
+      // Only this thread writes the received channels, the application only
+      // swaps them in once complete
+      std::unique_lock l(sync[SyncPoints::FrameIsReady].mtx);
       Frame &frm = frames[hnd];
+      bool firstStripe = !frm.receiving;
+      if (firstStripe) {
+        // If the previous frame completed while mapped, it was not swapped
+        // in and still is the base to apply deltas to
+        frm.colorBaseReady = frm.receivedComplete;
+        frm.receiving = true;
+      }
+      frm.receivedComplete = false;
+      l.unlock();
+
+      bool lastStripe =
+          firstRow + numRows == height && firstColumn + numColumns == width;
 
-      timing.beforeFrameDecoded = getCurrentTime();
+      Frame::Channels &received = frm.received;
 
-      double t = timing.beforeFrameDecoded - timing.beforeRenderFrame;
+      if ((flags & ChannelFlags::Delta) && !frm.colorBaseReady) {
+        // 'mapped' is only swapped once this frame is complete, so it can be
+        // read without holding the lock
+        received.resizeColor(
+            frm.mapped.size[0], frm.mapped.size[1], frm.mapped.colorType);
+        std::copy(frm.mapped.color.begin(),
+            frm.mapped.color.end(),
+            received.color.begin());
+        frm.colorBaseReady = true;
+      }
+
+      if ((flags & ChannelFlags::Delta)
+          && (received.size[0] != width || received.size[1] != height
+              || received.colorType != type)) {
+        LOG(logging::Level::Error)
+            << "Received color delta does not match the previous frame";
+        return;
+      }
+
+      double beforeStripeDecoded = getCurrentTime();
+      if (firstStripe)
+        timing.beforeFrameDecoded = beforeStripeDecoded;
+
+      double t = beforeStripeDecoded - timing.beforeRenderFrame;
       std::string chan = message->type() == MessageType::ChannelColor
           ? "channel.color"
           : "channel.depth";
-      LOG(logging::Level::Stats) << t << " sec. until " << chan << " received";
+      if (firstStripe) {
+        LOG(logging::Level::Stats)
+            << t << " sec. until " << chan << " received";
+      }
 
       CompressionFeatures cf = getCompressionFeatures();
 
+      // Stripes are decoded straight into their rows
+      size_t pitch = width * anari::sizeOf(type);
+      size_t rowSize = numColumns * anari::sizeOf(type);
+      size_t numBytes = numRows * rowSize;
+      const uint8_t *payload = (const uint8_t *)message->data() + off;
+
+      // Raw rectangles in shared memory are released once copied
+      bool inRing = encoding == ChannelEncoding::SharedMemory;
+      uint64_t ringPos = 0;
+      if (inRing) {
+        if (!fromServer.valid()) {
+          LOG(logging::Level::Error)
+              << "Received stripe in shared memory, which is not mapped";
+          return;
+        }
+        memcpy(&ringPos, payload, sizeof(ringPos));
+        payload = fromServer.data(ringPos, numBytes);
+        if (!payload) {
+          LOG(logging::Level::Error)
+              << "Received stripe at an invalid shared memory range";
+          return;
+        }
+      }
+      CodecCounters &uncompressed =
+          inRing ? counters.sharedMemory : counters.raw;
+
       if (message->type() == MessageType::ChannelColor) {
-        frm.resizeColor(width, height, type);
+        received.resizeColor(width, height, type);
 
         bool compressionTurboJPEG =
             cf.hasTurboJPEG && server.compression.hasTurboJPEG;
 
-        if (!compressionTurboJPEG && frm.frameID == 0) {
+        if (!compressionTurboJPEG && !fromServer.valid() && frm.frameID == 0
+            && firstStripe) {
           if (cf.hasTurboJPEG)
             LOG(logging::Level::Warning)
                 << "Performance: client supports TurboJPEG compression for colors, but server does not";
@@ -1119,35 +1627,42 @@ void Device::handleMessage(async::connection::reason reason,
                 << "Performance: neither client nor server support TurboJPEG compression for colors";
         }
 
-        if (compressionTurboJPEG
-            && type == ANARI_UFIXED8_RGBA_SRGB) { // TODO: more formats..
-          uint32_t jpegSize = *(uint32_t *)(message->data() + off);
-          off += sizeof(jpegSize);
+        uint8_t *rows = received.color.data() + firstRow * pitch
+            + firstColumn * anari::sizeOf(type);
+
+        if (numBytes == 0) {
+          // Nothing changed since the previous frame
+        } else if (encoding == ChannelEncoding::Compressed) {
+          uint32_t jpegSize = *(uint32_t *)payload;
+          payload += sizeof(jpegSize);
 
           TurboJPEGOptions options;
-          options.width = width;
-          options.height = height;
+          options.width = numColumns;
+          options.height = numRows;
           options.pixelFormat = TurboJPEGOptions::PixelFormat::RGBX;
+          options.pitch = pitch;
 
-          if (uncompressTurboJPEG((const uint8_t *)message->data() + off,
-                  frm.color.data(),
-                  jpegSize,
-                  options)) {
-            LOG(logging::Level::Stats)
-                << "TurboJPEG: raw " << prettyBytes(frm.color.size())
+          counters.turboJPEG.add(numBytes, jpegSize);
+          if (uncompressTurboJPEG(payload, rows, jpegSize, options)) {
+            LOG(logging::Level::Info)
+                << "TurboJPEG: raw " << prettyBytes(numBytes)
                 << ", compressed: " << prettyBytes(jpegSize)
-                << ", rate: " << double(frm.color.size()) / jpegSize;
+                << ", rate: " << double(numBytes) / jpegSize;
           }
         } else {
-          size_t numBytes = width * height * anari::sizeOf(type);
-          memcpy(frm.color.data(), message->data() + off, numBytes);
+          uncompressed.add(numBytes, numBytes);
+          for (uint32_t y = 0; y < numRows; ++y)
+            memcpy(rows + y * pitch, payload + y * rowSize, rowSize);
         }
       } else {
-        frm.resizeDepth(width, height, type);
+        received.resizeDepth(width, height, type);
 
+        bool compressionFloatDepth =
+            cf.hasFloatDepth && server.compression.hasFloatDepth;
         bool compressionSNAPPY = cf.hasSNAPPY && server.compression.hasSNAPPY;
 
-        if (!compressionSNAPPY && frm.frameID == 0) {
+        if (!compressionFloatDepth && !compressionSNAPPY && !fromServer.valid()
+            && frm.frameID == 0 && firstStripe) {
           if (cf.hasTurboJPEG)
             LOG(logging::Level::Warning)
                 << "Performance: client supports SNAPPY compression for depths, but server does not";
@@ -1159,34 +1674,60 @@ void Device::handleMessage(async::connection::reason reason,
                 << "Performance: neither client nor server support SNAPPY compression for depths";
         }
 
-        if (compressionSNAPPY && type == ANARI_FLOAT32) {
-          uint32_t snappySize = *(uint32_t *)(message->data() + off);
-          off += sizeof(snappySize);
+        uint8_t *rows = received.depth.data() + firstRow * pitch;
+
+        if (encoding == ChannelEncoding::FloatDepth) {
+          uint32_t depthSize = *(uint32_t *)payload;
+          payload += sizeof(depthSize);
+
+          FloatDepthOptions options;
+          options.width = width;
+          options.height = numRows;
+
+          counters.floatDepth.add(numBytes, depthSize);
+          if (uncompressFloatDepth(
+                  payload, (float *)rows, depthSize, options)) {
+            LOG(logging::Level::Info)
+                << "Float depth: raw " << prettyBytes(numBytes)
+                << ", compressed: " << prettyBytes(depthSize)
+                << ", rate: " << double(numBytes) / depthSize;
+          } else {
+            LOG(logging::Level::Warning) << "Float depth decoding failed";
+          }
+        } else if (encoding == ChannelEncoding::Compressed) {
+          uint32_t snappySize = *(uint32_t *)payload;
+          payload += sizeof(snappySize);
+
+          SNAPPYOptions options;
+          options.inputSize = numBytes;
 
-          if (uncompressSNAPPY((const uint8_t *)message->data() + off,
-                  frm.depth.data(),
-                  snappySize,
-                  SNAPPYOptions{})) {
-            LOG(logging::Level::Stats)
-                << "SNAPPY: raw " << prettyBytes(frm.depth.size())
+          counters.snappy.add(numBytes, snappySize);
+          if (uncompressSNAPPY(payload, rows, snappySize, options)) {
+            LOG(logging::Level::Info)
+                << "SNAPPY: raw " << prettyBytes(numBytes)
                 << ", compressed: " << prettyBytes(snappySize)
-                << ", rate: " << double(frm.depth.size()) / snappySize;
+                << ", rate: " << double(numBytes) / snappySize;
           } else {
             LOG(logging::Level::Warning) << "snappy::RawUncompress failed";
           }
         } else {
-          size_t numBytes = width * height * anari::sizeOf(type);
-          memcpy(frm.depth.data(), message->data() + off, numBytes);
+          uncompressed.add(numBytes, numBytes);
+          memcpy(rows, payload, numBytes);
         }
       }
 
+      if (inRing)
+        fromServer.release(ringPos, numBytes);
+
       timing.afterFrameDecoded = getCurrentTime();
 
-      t = timing.afterFrameDecoded - timing.beforeFrameDecoded;
-      double t_total = timing.afterFrameDecoded - timing.beforeRenderFrame;
-      LOG(logging::Level::Stats) << t << " sec. to decode " << chan;
-      LOG(logging::Level::Stats)
-          << t_total << " sec. total until " << chan << " ready to use";
+      t = timing.afterFrameDecoded - beforeStripeDecoded;
+      LOG(logging::Level::Info) << t << " sec. to decode stripe of " << chan;
+      if (lastStripe) {
+        double t_total = timing.afterFrameDecoded - timing.beforeRenderFrame;
+        LOG(logging::Level::Stats)
+            << t_total << " sec. total until " << chan << " ready to use";
+      }
     } else {
       LOG(logging::Level::Warning)
           << "Unhandled message of size: " << message->size();
@@ -1195,13 +1736,28 @@ void Device::handleMessage(async::connection::reason reason,
   }
 }
 
+void Device::failConnection()
+{
+  for (int i :
+      {SyncPoints::ConnectionEstablished, SyncPoints::DeviceHandleRemote}) {
+    std::unique_lock l(sync[i].mtx);
+    connectionFailed = true;
+    l.unlock();
+    sync[i].cv.notify_all();
+  }
+}
+
 void Device::writeImpl(unsigned type, std::shared_ptr<Buffer> buf)
 {
+  counters.messagesSent++;
+  counters.bytesSent += buf->size();
   conn->write(type, *buf);
 }
 
 void Device::writeImpl2(unsigned type, const void *begin, const void *end)
 {
+  counters.messagesSent++;
+  counters.bytesSent += (const char *)end - (const char *)begin;
   conn->write(type, (const char *)begin, (const char *)end);
 }
 
@@ -4,14 +4,18 @@
 #pragma once
 
 #include <anari/backend/DeviceImpl.h>
+#include <atomic>
 #include <condition_variable>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
+#include "ArrayInfo.h"
 #include "Buffer.h"
 #include "Compression.h"
 #include "Frame.h"
 #include "ParameterList.h"
+#include "SharedMemory.h"
 #include "StringList.h"
 #include "async/connection.h"
 #include "async/connection_manager.h"
@@ -166,7 +170,8 @@ struct Device : anari::DeviceImpl, helium::ParameterizedObject
   ~Device();
 
  private:
-  void initClient();
+  // Connect and create the remote device, return false if that failed
+  bool initClient();
   uint64_t nextObjectID = 1;
 
   struct
@@ -176,6 +181,32 @@ struct Device : anari::DeviceImpl, helium::ParameterizedObject
     CompressionFeatures compression;
   } server;
 
+  // Keep a copy of what was last sent for each array, so that later updates
+  // only send what changed (device parameter "array.delta")
+  bool deltaArrayTransfer{false};
+
+  // Number of frames rendered ahead on the server ("frame.inFlight"); the
+  // application sees frames that many frames late
+  uint32_t framesInFlight{1};
+
+  // If the server runs on the same host, array contents and frames pass
+  // through shared memory rings instead of the socket ("server.sharedMemory")
+  bool useSharedMemory{true};
+  SharedRing toServer, fromServer;
+
+  // Small messages that need no reply are collected and sent as one Batch
+  // message once it reaches this many bytes ("message.batchSize", 0 sends
+  // each message on its own) or its oldest message has waited for batchDelay
+  // seconds when another one is added, and before any other message
+  uint32_t batchSize{64 << 10};
+  double batchDelay{0.01};
+  struct
+  {
+    std::mutex mtx;
+    std::shared_ptr<Buffer> buffer;
+    double startTime{0.0};
+  } batch;
+
   async::connection_manager_pointer manager;
   async::connection_pointer conn;
   async::work_queue queue;
@@ -193,7 +224,6 @@ struct Device : anari::DeviceImpl, helium::ParameterizedObject
       ConnectionEstablished,
       DeviceHandleRemote,
       MapArray,
-      UnmapArray,
       FrameIsReady,
       Properties,
       ObjectSubtypes,
@@ -207,6 +237,9 @@ struct Device : anari::DeviceImpl, helium::ParameterizedObject
   SyncPrimitives sync[SyncPoints::Count];
 
   ANARIDevice remoteDevice{nullptr};
+  // Set when the connection failed or the server turned the session down;
+  // the device then stays without a remote device and doesn't retry
+  std::atomic<bool> connectionFailed{false};
   std::string remoteSubtype = "default";
 
   struct Property
@@ -281,10 +314,22 @@ struct Device : anari::DeviceImpl, helium::ParameterizedObject
   std::vector<ParameterInfo::Ptr> parameterInfos;
 
   std::map<ANARIObject, Frame> frames;
+
+  // Client-side shadow of array contents. Arrays the client created without
+  // application memory, or has fetched from the server once, are mapped
+  // locally; only unmaps send the contents to the server, in chunks
   struct ArrayData
   {
+    ArrayInfo info;
     std::int64_t bytesExpected{-1};
     std::vector<char> value;
+    // 'value' holds the current array contents
+    bool shadowed{false};
+    // Contents only exist on the server (array was created from app memory)
+    bool contentsOnServer{false};
+    // Contents last sent to the server, to send deltas against ("array.delta")
+    std::vector<char> reference;
+    uint64_t refCount{1};
   };
   std::map<ANARIArray, ArrayData> arrays;
 
@@ -314,6 +359,14 @@ struct Device : anari::DeviceImpl, helium::ParameterizedObject
 
   ObjectDesc makeObjectDesc(ANARIObject object) const;
 
+  // Stream array contents to the server as ArrayData messages. Given the
+  // contents last sent ('reference'), unchanged chunks are skipped and the
+  // others are sent XOR'ed against it
+  void sendArrayData(ANARIArray array,
+      const ArrayInfo &info,
+      const char *data,
+      const char *reference = nullptr);
+
   //--- Net ---------------------------------------------
   void connect(std::string host, unsigned short port);
 
@@ -322,6 +375,9 @@ struct Device : anari::DeviceImpl, helium::ParameterizedObject
   void write(unsigned type, std::shared_ptr<Buffer> buf);
   void write(unsigned type, const void *begin, const void *end);
 
+  // Send pending batched messages now
+  void flush();
+
   bool handleNewConnection(
       async::connection_pointer new_conn, std::error_code const &e);
 
@@ -329,6 +385,9 @@ struct Device : anari::DeviceImpl, helium::ParameterizedObject
       async::message_pointer message,
       std::error_code const &e);
 
+  // Wake up initClient() when the connection failed
+  void failConnection();
+
   void writeImpl(unsigned type, std::shared_ptr<Buffer> buf);
   void writeImpl2(unsigned type, const void *begin, const void *end);
 
@@ -340,6 +399,36 @@ struct Device : anari::DeviceImpl, helium::ParameterizedObject
     double beforeFrameDecoded = 0.0;
     double afterFrameDecoded = 0.0;
   } timing;
+
+  // Bytes before and after encoding (arrays) or before decoding (frames)
+  struct CodecCounters
+  {
+    std::atomic<uint64_t> rawBytes{0};
+    std::atomic<uint64_t> encodedBytes{0};
+
+    void add(uint64_t raw, uint64_t encoded)
+    {
+      rawBytes += raw;
+      encodedBytes += encoded;
+    }
+  };
+
+  // Traffic counters, which benchmarks read as ANARI_UINT64 device properties
+  // (e.g. "remote.bytesSent", "remote.snappy.encodedBytes")
+  struct
+  {
+    // API calls which sent a message, batched or not
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> messagesSent{0};
+    std::atomic<uint64_t> bytesSent{0};
+    std::atomic<uint64_t> messagesReceived{0};
+    std::atomic<uint64_t> bytesReceived{0};
+    CodecCounters raw, sharedMemory, turboJPEG, snappy, floatDepth;
+  } counters;
+
+  // Reads the counter 'name' into 'mem'; false if there is no such counter
+  bool getCounter(
+      const char *name, ANARIDataType type, void *mem, uint64_t size);
 };
 
 } // namespace remote
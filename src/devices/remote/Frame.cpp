@@ -2,10 +2,13 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "Frame.h"
+// std
+#include <utility>
 
 namespace remote {
 
-void Frame::resizeColor(uint32_t width, uint32_t height, ANARIDataType type)
+void Frame::Channels::resizeColor(
+    uint32_t width, uint32_t height, ANARIDataType type)
 {
   size_t newSize =
       type == ANARI_UNKNOWN ? 0 : width * height * anari::sizeOf(type);
@@ -19,7 +22,8 @@ void Frame::resizeColor(uint32_t width, uint32_t height, ANARIDataType type)
   }
 }
 
-void Frame::resizeDepth(uint32_t width, uint32_t height, ANARIDataType type)
+void Frame::Channels::resizeDepth(
+    uint32_t width, uint32_t height, ANARIDataType type)
 {
   size_t newSize =
       type == ANARI_UNKNOWN ? 0 : width * height * anari::sizeOf(type);
@@ -33,4 +37,10 @@ void Frame::resizeDepth(uint32_t width, uint32_t height, ANARIDataType type)
   }
 }
 
+void Frame::swapChannels()
+{
+  std::swap(mapped, received);
+  receivedComplete = false;
+}
+
 } // namespace remote
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <anari/anari_cpp.hpp>
+#include <deque>
 #include <vector>
 
 namespace remote {
@@ -18,18 +19,40 @@ struct Frame
     Mapped,
   };
 
-  uint64_t frameID{0};
+  struct Channels
+  {
+    void resizeColor(uint32_t width, uint32_t height, ANARIDataType type);
+    void resizeDepth(uint32_t width, uint32_t height, ANARIDataType type);
+
+    uint32_t size[2] = {1, 1};
+    ANARIDataType colorType = ANARI_UNKNOWN, depthType = ANARI_UNKNOWN;
+
+    std::vector<uint8_t> color;
+    std::vector<uint8_t> depth;
+  };
 
-  void resizeColor(uint32_t width, uint32_t height, ANARIDataType type);
-  void resizeDepth(uint32_t width, uint32_t height, ANARIDataType type);
+  // Number of frames received from / submitted to the server
+  uint64_t frameID{0};
+  uint64_t numSubmitted{0};
 
   State state{Unmapped};
 
-  uint32_t size[2] = {1, 1};
-  ANARIDataType colorType = ANARI_UNKNOWN, depthType = ANARI_UNKNOWN;
+  // Channels of the latest complete frame, which the application maps, and
+  // those of the frame currently being received
+  Channels mapped, received;
+  bool receivedComplete{false};
+
+  // Set while messages of a frame arrive; delta encoded colors are applied
+  // on top of the previous frame's, once copied into 'received'
+  bool receiving{false};
+  bool colorBaseReady{false};
+
+  // Make the received frame the mapped one
+  void swapChannels();
 
-  std::vector<uint8_t> color;
-  std::vector<uint8_t> depth;
+  // Submission times of the frames in flight, oldest first
+  std::deque<double> submitTimes;
+  double lastReceiveTime{0.0};
 };
 
 } // namespace remote
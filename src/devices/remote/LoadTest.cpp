@@ -0,0 +1,167 @@
+// Copyright 2023-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+// Connects several clients to one anariRemoteServer at the same time; each
+// one (optionally) uploads the same array and renders frames. Reports frame
+// throughput per client and in total.
+
+#include <anari/anari.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Global variables
+static uint32_t g_numClients = 4;
+static uint32_t g_numFrames = 100;
+static uint32_t g_width = 1024;
+static uint32_t g_height = 768;
+static uint32_t g_framesInFlight = 1;
+static uint64_t g_arraySize = 0;
+static std::string g_hostname = "localhost";
+static unsigned short g_port = 31050;
+
+struct ClientResult
+{
+  double seconds{0.0};
+};
+
+static void runClient(ANARIDevice dev,
+    const std::vector<float> &arrayData,
+    ClientResult &result)
+{
+  const char *hostname = g_hostname.c_str();
+  anariSetParameter(dev, dev, "server.hostname", ANARI_STRING, hostname);
+  anariSetParameter(dev, dev, "server.port", ANARI_UINT16, &g_port);
+  anariSetParameter(dev, dev, "frame.inFlight", ANARI_UINT32, &g_framesInFlight);
+
+  // Same contents for every client, so a server sharing devices stores it once
+  ANARIArray1D array = nullptr;
+  if (!arrayData.empty()) {
+    array = anariNewArray1D(dev,
+        arrayData.data(),
+        nullptr,
+        nullptr,
+        ANARI_FLOAT32,
+        arrayData.size());
+  }
+
+  ANARIFrame frame = anariNewFrame(dev);
+  uint32_t size[2] = {g_width, g_height};
+  ANARIDataType colorType = ANARI_UFIXED8_RGBA_SRGB;
+  ANARIDataType depthType = ANARI_FLOAT32;
+  anariSetParameter(dev, frame, "size", ANARI_UINT32_VEC2, size);
+  anariSetParameter(dev, frame, "channel.color", ANARI_DATA_TYPE, &colorType);
+  anariSetParameter(dev, frame, "channel.depth", ANARI_DATA_TYPE, &depthType);
+  anariCommitParameters(dev, frame);
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint32_t i = 0; i < g_numFrames; ++i) {
+    anariRenderFrame(dev, frame);
+    anariFrameReady(dev, frame, ANARI_WAIT);
+
+    uint32_t width, height;
+    ANARIDataType type;
+    anariMapFrame(dev, frame, "channel.color", &width, &height, &type);
+    anariUnmapFrame(dev, frame, "channel.color");
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  result.seconds = std::chrono::duration<double>(end - start).count();
+
+  anariRelease(dev, frame);
+  if (array)
+    anariRelease(dev, array);
+}
+
+static void printUsage()
+{
+  std::cout << "./anariRemoteLoadTest [{--help|-h}]\n"
+            << "   [{--clients|-c} <N>]\n"
+            << "   [{--frames|-f} <N>]\n"
+            << "   [{--size|-s} <width> <height>]\n"
+            << "   [{--frames-in-flight|-k} <N>]\n"
+            << "   [{--array-size|-a} <MiB>]\n"
+            << "   [{--hostname|-n} <hostname>]\n"
+            << "   [{--port|-p} <N>]\n";
+}
+
+static void parseCommandLine(int argc, char *argv[])
+{
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      printUsage();
+      std::exit(0);
+    } else if (arg == "-c" || arg == "--clients")
+      g_numClients = std::stoi(argv[++i]);
+    else if (arg == "-f" || arg == "--frames")
+      g_numFrames = std::stoi(argv[++i]);
+    else if (arg == "-s" || arg == "--size") {
+      g_width = std::stoi(argv[++i]);
+      g_height = std::stoi(argv[++i]);
+    } else if (arg == "-k" || arg == "--frames-in-flight")
+      g_framesInFlight = std::stoi(argv[++i]);
+    else if (arg == "-a" || arg == "--array-size")
+      g_arraySize = std::stoull(argv[++i]) << 20;
+    else if (arg == "-n" || arg == "--hostname")
+      g_hostname = argv[++i];
+    else if (arg == "-p" || arg == "--port")
+      g_port = std::stoi(argv[++i]);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  parseCommandLine(argc, argv);
+
+  ANARILibrary lib = anariLoadLibrary("remote", nullptr, nullptr);
+  if (!lib) {
+    std::cerr << "Could not load the remote device library\n";
+    return 1;
+  }
+
+  std::vector<float> arrayData(g_arraySize / sizeof(float));
+  for (size_t i = 0; i < arrayData.size(); ++i)
+    arrayData[i] = float(i % 1000);
+
+  std::vector<ANARIDevice> devices(g_numClients);
+  for (auto &dev : devices)
+    dev = anariNewDevice(lib, "default");
+
+  std::vector<ClientResult> results(g_numClients);
+  std::vector<std::thread> clients;
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < g_numClients; ++i) {
+    clients.emplace_back(
+        runClient, devices[i], std::cref(arrayData), std::ref(results[i]));
+  }
+  for (auto &client : clients)
+    client.join();
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+
+  for (uint32_t i = 0; i < g_numClients; ++i) {
+    printf("client %u: %u frames in %.3f sec., %.2f frames/sec.\n",
+        i,
+        g_numFrames,
+        results[i].seconds,
+        g_numFrames / results[i].seconds);
+  }
+  printf("total: %u clients, %.2f frames/sec. (%ux%u)\n",
+      g_numClients,
+      g_numClients * g_numFrames / seconds,
+      g_width,
+      g_height);
+
+  for (auto &dev : devices)
+    anariRelease(dev, dev);
+  anariUnloadLibrary(lib);
+
+  return 0;
+}
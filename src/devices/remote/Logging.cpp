@@ -47,6 +47,11 @@ void Initialize(Level maxLevel)
   }
 }
 
+bool Enabled(Level level)
+{
+  return level <= OutputLevelMax;
+}
+
 Stream::Stream(Level level) : level_(level) {}
 
 Stream::~Stream()
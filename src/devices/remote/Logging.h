@@ -20,6 +20,9 @@ static Level OutputLevelMax = Level::Warning;
 
 void Initialize(Level maxLevel = Level::Warning);
 
+// Whether messages of this level are printed
+bool Enabled(Level level);
+
 class Stream
 {
  public:
@@ -38,4 +41,8 @@ class Stream
 } // namespace logging
 } // namespace remote
 
-#define LOG(LEVEL) ::remote::logging::Stream(LEVEL).stream()
+// Messages that are not printed are not formatted either
+#define LOG(LEVEL)                                                             \
+  if (!::remote::logging::Enabled(LEVEL)) {                                    \
+  } else                                                                       \
+    ::remote::logging::Stream(LEVEL).stream()
@@ -2,15 +2,28 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <anari/anari_cpp.hpp>
+#include <algorithm>
+#include <atomic>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <cstring>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <system_error>
+#include <thread>
+#include <tuple>
 #include "ArrayInfo.h"
 #include "Buffer.h"
 #include "Compression.h"
 #include "Logging.h"
 #include "ObjectDesc.h"
+#include "SharedMemory.h"
 #include "async/connection.h"
 #include "async/connection_manager.h"
 #include "async/work_queue.h"
@@ -23,6 +36,16 @@ static std::string g_libraryType = "environment";
 static ANARILibrary g_library = nullptr;
 static bool g_verbose = false;
 static unsigned short g_port = 31050;
+static uint32_t g_keyframeInterval = 60;
+static uint32_t g_depthPrecision = 23;
+static uint32_t g_maxSessions = 0;
+static uint32_t g_sessionThreads = 0;
+static uint64_t g_sessionMemory = 0;
+static bool g_shareDevices = false;
+
+// Seconds to wait for the client to free up space in the shared memory ring
+// before sending through the socket
+static constexpr double ringTimeout = 0.1;
 
 namespace remote {
 
@@ -124,6 +147,124 @@ static ANARIArray newArray(
   return array;
 }
 
+// 64-bit FNV-1a over words, to detect changed image blocks
+static uint64_t hashRect(
+    const uint8_t *data, size_t pitch, size_t rowSize, uint32_t numRows)
+{
+  uint64_t h = 14695981039346656037ull;
+  for (uint32_t y = 0; y < numRows; ++y) {
+    const uint8_t *row = data + y * pitch;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= rowSize; i += sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, row + i, sizeof(word));
+      h = (h ^ word) * 1099511628211ull;
+    }
+    for (; i < rowSize; ++i)
+      h = (h ^ row[i]) * 1099511628211ull;
+  }
+  return h;
+}
+
+// Two independent 64-bit hashes, to tell arrays apart by their contents
+struct ContentHash
+{
+  uint64_t fnv{14695981039346656037ull};
+  uint64_t mix{0x9e3779b97f4a7c15ull};
+
+  bool operator<(const ContentHash &other) const
+  {
+    return std::tie(fnv, mix) < std::tie(other.fnv, other.mix);
+  }
+};
+
+static ContentHash hashContents(const uint8_t *data, size_t numBytes)
+{
+  ContentHash h;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= numBytes; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    h.fnv = (h.fnv ^ word) * 1099511628211ull;
+    h.mix = (h.mix ^ word) * 0xbf58476d1ce4e5b9ull;
+    h.mix ^= h.mix >> 31;
+  }
+  for (; i < numBytes; ++i) {
+    h.fnv = (h.fnv ^ data[i]) * 1099511628211ull;
+    h.mix = (h.mix ^ data[i]) * 0xbf58476d1ce4e5b9ull;
+    h.mix ^= h.mix >> 31;
+  }
+  return h;
+}
+
+// With --share-devices, sessions asking for the same device type render with
+// the same device, so that arrays with identical contents are stored once
+struct SharedDevice
+{
+  using ArrayKey = std::tuple<ANARIDataType,
+      ANARIDataType,
+      uint64_t,
+      uint64_t,
+      uint64_t,
+      ContentHash>;
+
+  struct Array
+  {
+    ANARIArray array{nullptr};
+    // Session handles referring to the array
+    uint32_t numHandles{0};
+  };
+
+  std::string type;
+  ANARIDevice device{nullptr};
+  uint32_t numSessions{0};
+
+  // ANARI devices aren't thread safe, so sessions take turns
+  std::mutex mutex;
+
+  // Arrays nobody maps or writes to, by contents
+  std::map<ArrayKey, Array> arrays;
+  std::map<ANARIArray, ArrayKey> arrayKeys;
+
+  static ArrayKey makeKey(const ArrayInfo &info, const ContentHash &hash)
+  {
+    return ArrayKey(info.type,
+        info.elementType,
+        info.numItems1,
+        info.numItems2,
+        info.numItems3,
+        hash);
+  }
+};
+
+struct SharedDevices
+{
+  std::shared_ptr<SharedDevice> acquire(const std::string &type)
+  {
+    std::unique_lock l(mutex);
+    auto &dev = devices[type];
+    if (!dev) {
+      dev = std::make_shared<SharedDevice>();
+      dev->type = type;
+      dev->device = anariNewDevice(g_library, type.c_str());
+    }
+    dev->numSessions++;
+    return dev;
+  }
+
+  void release(std::shared_ptr<SharedDevice> dev)
+  {
+    std::unique_lock l(mutex);
+    if (--dev->numSessions == 0) {
+      anariRelease(dev->device, dev->device);
+      devices.erase(dev->type);
+    }
+  }
+
+  std::mutex mutex;
+  std::map<std::string, std::shared_ptr<SharedDevice>> devices;
+};
+
 struct ResourceManager
 {
   // Device handles are generated by us and returned to the client
@@ -208,126 +349,738 @@ struct ResourceManager
   std::vector<std::vector<ArrayInfo>> registeredArrays;
 };
 
-struct Server
+// Everything the server keeps per client connection. Sessions have their own
+// handle namespace, and their own threads to handle messages and to encode
+// frames, so one client's rendering doesn't hold back the others.
+struct Session
 {
-  // For now only one client:
   struct
   {
     CompressionFeatures compression;
   } client;
 
+  // Block hashes of the color channel last sent for a frame, to only send
+  // what changed in between keyframes
+  struct ColorHistory
+  {
+    uint32_t width{0}, height{0};
+    ANARIDataType type{ANARI_UNKNOWN};
+    std::vector<uint64_t> blockHashes;
+    uint32_t framesSinceKeyframe{0};
+    std::atomic<uint32_t> rectsSent{0};
+  };
+
+  static constexpr uint32_t blockSize = 64;
+
+  uint64_t id;
+  SharedDevices &sharedDevices;
+  std::shared_ptr<SharedDevice> sharedDevice;
+
   ResourceManager resourceManager;
-  async::connection_manager_pointer manager;
   async::connection_pointer conn;
+
+  std::map<ANARIArray, uint8_t *> mappedArrays;
+  std::map<ANARIObject, ColorHistory> colorHistory;
+  std::vector<uint8_t> arrayDataScratch;
+
+  // Shared memory rings of a client on the same host, for array contents and
+  // frames; rectangles are placed in the ring in the order they are sent
+  SharedRing fromClient, toClient;
+  std::mutex toClientMutex;
+
+  // Public references held by the client, released when the session ends
+  std::map<std::pair<Handle, Handle>, uint32_t> refCounts;
+  // Array bytes held, counted against the --session-memory quota
+  uint64_t arrayBytes{0};
+  // Array valued parameters, so that they can be moved over to private
+  // copies of shared arrays: (device, object, name) -> array
+  std::map<std::tuple<Handle, Handle, std::string>, Handle> arrayParams;
+  // Objects with parameter changes the client has not committed yet:
+  // (device, object)
+  std::set<std::pair<Handle, Handle>> uncommittedObjects;
+
+  std::atomic<bool> ended{false};
+
+  // Threads last, so they are joined before what they use is destroyed
   async::work_queue queue;
+  uint32_t encodePoolSize{g_sessionThreads != 0
+          ? g_sessionThreads
+          : std::max(1u, std::thread::hardware_concurrency())};
+  boost::asio::thread_pool encodePool{encodePoolSize};
+  async::work_queue encodeQueue;
+  async::work_queue worker;
+
+  Session(uint64_t id, async::connection_pointer c, SharedDevices &sd)
+      : id(id), sharedDevices(sd), conn(c)
+  {
+    queue.run_in_thread();
+    encodeQueue.run_in_thread();
+    worker.run_in_thread();
 
-  explicit Server(unsigned short port = 31050)
-      : manager(async::make_connection_manager(port))
+    conn->set_handler(std::bind(&Session::handleMessage,
+        this,
+        std::placeholders::_1,
+        std::placeholders::_2,
+        std::placeholders::_3));
+  }
+
+  ~Session()
   {
-    logging::Initialize();
+    // Sessions are destroyed on the connection manager's thread, so this
+    // can't race with the connection still calling the handler
+    conn->remove_handler();
+  }
 
-    g_library = anariLoadLibrary(g_libraryType.c_str(), statusFunc, &g_verbose);
+  void write(unsigned type, std::shared_ptr<Buffer> buf)
+  {
+    queue.post(std::bind(&Session::writeImpl, this, type, buf));
   }
 
-  ~Server()
+  void writeImpl(unsigned type, std::shared_ptr<Buffer> buf)
   {
-    anariUnloadLibrary(g_library);
+    conn->write(type, *buf);
   }
 
-  void accept()
+  std::vector<uint8_t> translateArrayData(
+      Buffer &buf, ANARIDevice dev, ArrayInfo info)
   {
-    LOG(logging::Level::Info) << "Server: accepting...";
+    std::vector<uint8_t> arrayData(info.getSizeInBytes());
+    buf.read((char *)arrayData.data(), arrayData.size());
+    translateArrayHandles(
+        dev, info.elementType, arrayData.data(), arrayData.size());
+    return arrayData;
+  }
 
-    manager->accept(std::bind(&Server::handleNewConnection,
-        this,
-        std::placeholders::_1,
-        std::placeholders::_2));
+  // Translate remote to device handles, in place
+  void translateArrayHandles(ANARIDevice dev,
+      ANARIDataType elementType,
+      uint8_t *arrayData,
+      size_t numBytes)
+  {
+    if (!anari::isObject(elementType))
+      return;
+
+    const auto &registeredObjects =
+        resourceManager.registeredObjects[(uint64_t)dev];
+
+    size_t numObjects = numBytes / sizeof(uint64_t);
+
+    // This only works b/c sizeof(ANARIObject)==sizeof(uint64_t)!
+    // TODO: can this cause issues with alignment on some platforms?!
+    const uint64_t *handles = (const uint64_t *)arrayData;
+    ANARIObject *objects = (ANARIObject *)arrayData;
+
+    for (size_t i = 0; i < numObjects; ++i) {
+      objects[i] = registeredObjects[handles[i]].object;
+    }
   }
 
-  void run()
+  // Arrays stay mapped from the first MapArray or ArrayData message until
+  // the client unmaps them
+  uint8_t *mapArray(ANARIDevice dev, ANARIArray array)
   {
-    manager->run_in_thread();
-    queue.run_in_thread();
+    auto it = mappedArrays.find(array);
+    if (it != mappedArrays.end())
+      return it->second;
+
+    auto *ptr = (uint8_t *)anariMapArray(dev, array);
+    mappedArrays[array] = ptr;
+    return ptr;
   }
 
-  void wait()
+  void unmapArray(ANARIDevice dev, ANARIArray array)
   {
-    manager->wait();
+    auto it = mappedArrays.find(array);
+    if (it == mappedArrays.end())
+      return;
+
+    anariUnmapArray(dev, array);
+    mappedArrays.erase(it);
   }
 
-  void write(unsigned type, std::shared_ptr<Buffer> buf)
+  struct FrameChannel
+  {
+    uint32_t width{0}, height{0};
+    ANARIDataType type{ANARI_UNKNOWN};
+    std::vector<char> data;
+  };
+
+  struct FrameChannels
   {
-    queue.post(std::bind(&Server::writeImpl, this, type, buf));
+    ANARIObject frame{nullptr}; // client handle
+    FrameChannel color, depth;
+  };
+
+  void readChannel(ANARIDevice dev,
+      ANARIFrame frame,
+      const char *name,
+      FrameChannel &channel)
+  {
+    const char *ptr = (const char *)anariMapFrame(
+        dev, frame, name, &channel.width, &channel.height, &channel.type);
+    size_t numBytes = channel.type == ANARI_UNKNOWN
+        ? 0
+        : size_t(channel.width) * channel.height * anari::sizeOf(channel.type);
+    if (ptr != nullptr)
+      channel.data.assign(ptr, ptr + numBytes);
+    anariUnmapFrame(dev, frame, name);
   }
 
-  void writeImpl(unsigned type, std::shared_ptr<Buffer> buf)
+  // Runs on the encode queue, so frames are sent in the order rendered
+  void sendFrame(std::shared_ptr<FrameChannels> channels)
   {
-    conn->write(type, *buf);
+    std::vector<std::future<void>> stripes;
+
+    ColorHistory *history = nullptr;
+    if (g_keyframeInterval > 1 && !channels->color.data.empty()) {
+      history = &colorHistory[channels->frame];
+      sendColorDelta(channels->frame, channels->color, *history, stripes);
+    } else {
+      sendChannel(MessageType::ChannelColor,
+          channels->frame,
+          channels->color,
+          stripes);
+    }
+    sendChannel(MessageType::ChannelDepth,
+        channels->frame,
+        channels->depth,
+        stripes);
+
+    // 'channels' must outlive the stripes encoded from it
+    for (auto &stripe : stripes)
+      stripe.wait();
+
+    // Still tell the client that the frame has a color channel
+    if (history && history->rectsSent == 0) {
+      sendRect(MessageType::ChannelColor,
+          channels->frame,
+          channels->color,
+          0,
+          0,
+          0,
+          0,
+          ChannelFlags::Delta,
+          false);
+    }
+
+    auto outputBuffer = std::make_shared<Buffer>();
+    outputBuffer->write(channels->frame);
+    write(MessageType::FrameIsReady, outputBuffer);
   }
 
-  std::vector<uint8_t> translateArrayData(
-      Buffer &buf, ANARIDevice dev, ArrayInfo info)
+  bool compressChannel(unsigned type, const FrameChannel &channel) const
   {
-    std::vector<uint8_t> arrayData(info.getSizeInBytes());
-    buf.read((char *)arrayData.data(), arrayData.size());
+    // Copying to shared memory is faster than compressing
+    if (toClient.valid())
+      return false;
+
+    CompressionFeatures cf = getCompressionFeatures();
+    return type == MessageType::ChannelColor
+        ? cf.hasTurboJPEG && client.compression.hasTurboJPEG
+            && channel.type == ANARI_UFIXED8_RGBA_SRGB // TODO: more formats..
+        : ((cf.hasFloatDepth && client.compression.hasFloatDepth)
+              || (cf.hasSNAPPY && client.compression.hasSNAPPY))
+            && channel.type == ANARI_FLOAT32;
+  }
 
-    // Translate remote to device handles
-    if (anari::isObject(info.elementType)) {
-      const auto &registeredObjects =
-          resourceManager.registeredObjects[(uint64_t)dev];
+  // Split a channel into horizontal stripes, which the encode pool compresses
+  // and sends concurrently
+  void sendChannel(unsigned type,
+      ANARIObject frame,
+      const FrameChannel &channel,
+      std::vector<std::future<void>> &stripes)
+  {
+    if (channel.data.empty())
+      return;
 
-      size_t numObjects = info.numItems1 * std::max(uint64_t(1), info.numItems2)
-          * std::max(uint64_t(1), info.numItems3);
+    bool compress = compressChannel(type, channel);
+
+    // Raw stripes over the socket would only add messages; keep compressed
+    // stripes a multiple of the JPEG block size and large enough to be worth
+    // a task. Through shared memory, stripes are an eighth of the ring at
+    // most, so that the client copies one while the next one is written
+    constexpr uint32_t minStripeRows = 64;
+    uint32_t numStripes = 1;
+    if (compress) {
+      numStripes =
+          std::clamp(channel.height / minStripeRows, 1u, encodePoolSize);
+    } else if (toClient.valid()) {
+      size_t maxStripeBytes = toClient.capacity() / 8;
+      size_t numBytes = channel.data.size();
+      numStripes = std::clamp(uint32_t(numBytes / maxStripeBytes + 1),
+          1u,
+          std::max(channel.height, 1u));
+    }
+    uint32_t rowsPerStripe = (channel.height + numStripes - 1) / numStripes;
+    rowsPerStripe = (rowsPerStripe + 15) / 16 * 16;
+
+    for (uint32_t firstRow = 0; firstRow < channel.height;
+         firstRow += rowsPerStripe) {
+      uint32_t numRows = std::min(rowsPerStripe, channel.height - firstRow);
+      auto task = std::make_shared<std::packaged_task<void()>>([=, &channel]() {
+        sendRect(type,
+            frame,
+            channel,
+            firstRow,
+            numRows,
+            0,
+            channel.width,
+            0,
+            compress);
+      });
+      stripes.push_back(task->get_future());
+      boost::asio::post(encodePool, [task]() { (*task)(); });
+    }
+  }
+
+  // Hash the color channel in blocks, and send only runs of blocks which
+  // changed since the last frame (everything on keyframes). Rows of blocks
+  // are processed concurrently by the encode pool.
+  void sendColorDelta(ANARIObject frame,
+      const FrameChannel &color,
+      ColorHistory &history,
+      std::vector<std::future<void>> &stripes)
+  {
+    uint32_t blocksX = (color.width + blockSize - 1) / blockSize;
+    uint32_t blocksY = (color.height + blockSize - 1) / blockSize;
+
+    bool keyframe = ++history.framesSinceKeyframe >= g_keyframeInterval
+        || history.width != color.width || history.height != color.height
+        || history.type != color.type;
+    if (keyframe) {
+      history.width = color.width;
+      history.height = color.height;
+      history.type = color.type;
+      history.blockHashes.resize(size_t(blocksX) * blocksY);
+      history.framesSinceKeyframe = 0;
+    }
+    history.rectsSent = 0;
+
+    bool compress = compressChannel(MessageType::ChannelColor, color);
+
+    for (uint32_t by = 0; by < blocksY; ++by) {
+      auto task = std::make_shared<std::packaged_task<void()>>(
+          [=, &color, &history]() {
+            sendColorBlockRow(
+                frame, color, history, by, blocksX, keyframe, compress);
+          });
+      stripes.push_back(task->get_future());
+      boost::asio::post(encodePool, [task]() { (*task)(); });
+    }
+  }
 
-      // This only works b/c sizeof(ANARIObject)==sizeof(uint64_t)!
-      // TODO: can this cause issues with alignment on some platforms?!
-      const uint64_t *handles = (const uint64_t *)arrayData.data();
-      ANARIObject *objects = (ANARIObject *)arrayData.data();
+  void sendColorBlockRow(ANARIObject frame,
+      const FrameChannel &color,
+      ColorHistory &history,
+      uint32_t by,
+      uint32_t blocksX,
+      bool keyframe,
+      bool compress)
+  {
+    size_t pixelSize = anari::sizeOf(color.type);
+    size_t pitch = size_t(color.width) * pixelSize;
+    uint32_t firstRow = by * blockSize;
+    uint32_t numRows = std::min(blockSize, color.height - firstRow);
+
+    std::vector<bool> changed(blocksX);
+    for (uint32_t bx = 0; bx < blocksX; ++bx) {
+      uint32_t firstColumn = bx * blockSize;
+      uint32_t numColumns = std::min(blockSize, color.width - firstColumn);
+      uint64_t hash = hashRect((const uint8_t *)color.data.data()
+              + firstRow * pitch + firstColumn * pixelSize,
+          pitch,
+          numColumns * pixelSize,
+          numRows);
+      uint64_t &lastHash = history.blockHashes[size_t(by) * blocksX + bx];
+      changed[bx] = keyframe || hash != lastHash;
+      lastHash = hash;
+    }
 
-      for (size_t i = 0; i < numObjects; ++i) {
-        objects[i] = registeredObjects[handles[i]].object;
+    for (uint32_t bx = 0; bx < blocksX;) {
+      if (!changed[bx]) {
+        bx++;
+        continue;
       }
+      uint32_t end = bx;
+      while (end < blocksX && changed[end])
+        end++;
+
+      uint32_t firstColumn = bx * blockSize;
+      uint32_t numColumns =
+          std::min(end * blockSize, color.width) - firstColumn;
+      sendRect(MessageType::ChannelColor,
+          frame,
+          color,
+          firstRow,
+          numRows,
+          firstColumn,
+          numColumns,
+          keyframe ? 0u : uint32_t(ChannelFlags::Delta),
+          compress);
+      history.rectsSent++;
+      bx = end;
     }
-    return arrayData;
   }
 
-  bool handleNewConnection(
-      async::connection_pointer new_conn, std::error_code const &e)
+  // Rectangles in shared memory must be sent in the order they were placed
+  // there, so the client releases them in that order
+  void sendRect(unsigned type,
+      ANARIObject frame,
+      const FrameChannel &channel,
+      uint32_t firstRow,
+      uint32_t numRows,
+      uint32_t firstColumn,
+      uint32_t numColumns,
+      uint32_t flags,
+      bool compress)
   {
-    if (e) {
-      LOG(logging::Level::Error)
-          << "Server: could not connect to client: " << e.message();
-      manager->stop();
-      return false;
+    std::unique_lock<std::mutex> l;
+    if (toClient.valid())
+      l = std::unique_lock<std::mutex>(toClientMutex);
+
+    write(type,
+        encodeRect(type,
+            frame,
+            channel,
+            firstRow,
+            numRows,
+            firstColumn,
+            numColumns,
+            flags,
+            compress));
+  }
+
+  std::shared_ptr<Buffer> encodeRect(unsigned type,
+      ANARIObject frame,
+      const FrameChannel &channel,
+      uint32_t firstRow,
+      uint32_t numRows,
+      uint32_t firstColumn,
+      uint32_t numColumns,
+      uint32_t flags,
+      bool compress)
+  {
+    size_t pixelSize = anari::sizeOf(channel.type);
+    size_t pitch = size_t(channel.width) * pixelSize;
+    size_t rowSize = numColumns * pixelSize;
+    const uint8_t *rect = (const uint8_t *)channel.data.data()
+        + firstRow * pitch + firstColumn * pixelSize;
+
+    auto outputBuffer = std::make_shared<Buffer>();
+    outputBuffer->write(frame);
+    outputBuffer->write(channel.width);
+    outputBuffer->write(channel.height);
+    outputBuffer->write(channel.type);
+    outputBuffer->write(firstRow);
+    outputBuffer->write(numRows);
+    outputBuffer->write(firstColumn);
+    outputBuffer->write(numColumns);
+    outputBuffer->write(flags);
+
+    // Reused across frames by each pool thread
+    thread_local std::vector<uint8_t> compressed;
+    size_t compressedSize = 0;
+    uint32_t encoding = ChannelEncoding::Compressed;
+
+    if (compress && numRows * numColumns != 0
+        && type == MessageType::ChannelColor) {
+      TurboJPEGOptions options;
+      options.width = numColumns;
+      options.height = numRows;
+      options.pixelFormat = TurboJPEGOptions::PixelFormat::RGBX;
+      options.quality = 80;
+      options.pitch = pitch;
+
+      compressed.resize(getMaxCompressedBufferSizeTurboJPEG(options));
+      if (!compressTurboJPEG(rect, compressed.data(), compressedSize, options))
+        compressedSize = 0;
+    } else if (compress && numRows * numColumns != 0
+        && numColumns == channel.width
+        && getCompressionFeatures().hasFloatDepth
+        && client.compression.hasFloatDepth) {
+      FloatDepthOptions options;
+      options.width = numColumns;
+      options.height = numRows;
+      options.precisionBits = g_depthPrecision;
+
+      compressed.resize(getMaxCompressedBufferSizeFloatDepth(options));
+      if (compressFloatDepth(
+              (const float *)rect, compressed.data(), compressedSize, options))
+        encoding = ChannelEncoding::FloatDepth;
+      else
+        compressedSize = 0;
+    } else if (compress && numRows * numColumns != 0
+        && numColumns == channel.width) {
+      SNAPPYOptions options;
+      options.inputSize = numRows * rowSize;
+
+      compressed.resize(getMaxCompressedBufferSizeSNAPPY(options));
+      if (!compressSNAPPY(rect, compressed.data(), compressedSize, options))
+        compressedSize = 0;
     }
 
-    LOG(logging::Level::Info) << "server: connected";
+    uint64_t ringPos = 0;
+    if (compressedSize != 0 && compressedSize < numRows * rowSize) {
+      outputBuffer->write(encoding);
+      outputBuffer->write(uint32_t(compressedSize));
+      outputBuffer->write((const char *)compressed.data(), compressedSize);
+    } else if (toClient.reserve(numRows * rowSize, ringPos, ringTimeout)) {
+      uint8_t *dst = toClient.data(ringPos, numRows * rowSize);
+      for (uint32_t y = 0; y < numRows; ++y)
+        memcpy(dst + y * rowSize, rect + y * pitch, rowSize);
+      outputBuffer->write(uint32_t(ChannelEncoding::SharedMemory));
+      outputBuffer->write(ringPos);
+    } else {
+      outputBuffer->write(uint32_t(ChannelEncoding::Raw));
+      for (uint32_t y = 0; y < numRows; ++y)
+        outputBuffer->write((const char *)rect + y * pitch, rowSize);
+    }
 
-    // Accept and save this connection
-    // and set the message handler of the connection
-    conn = new_conn;
-    conn->set_handler(std::bind(&Server::handleMessage,
-        this,
-        std::placeholders::_1,
-        std::placeholders::_2,
-        std::placeholders::_3));
+    return outputBuffer;
+  }
 
-    // Accept new connections (TODO: the new connection
-    // will overwrite the current one, so, store these
-    // in a list of connections)
-    accept();
+  // Drop one of the client's references to an object
+  void releaseObject(Handle deviceHandle, Handle objectHandle)
+  {
+    auto it = refCounts.find({deviceHandle, objectHandle});
+    if (it == refCounts.end())
+      return;
 
-    return true;
+    ObjectDesc obj = resourceManager.getObjectDesc(deviceHandle, objectHandle);
+    if (--it->second == 0) {
+      refCounts.erase(it);
+      forgetArrayParams(deviceHandle, objectHandle);
+      uncommittedObjects.erase({deviceHandle, objectHandle});
+      if (anari::isArray(obj.type)) {
+        unmapArray(obj.device, (ANARIArray)obj.object);
+        arrayBytes -= resourceManager.getArrayInfo(deviceHandle, objectHandle)
+                          .getSizeInBytes();
+        forgetSharedArray(obj.device, (ANARIArray)obj.object);
+      }
+    }
+
+    anariRelease(obj.device, obj.object);
   }
 
+  // Release a device along with all objects the client didn't release
+  void releaseDevice(Handle deviceHandle)
+  {
+    ANARIDevice dev = resourceManager.getDevice(deviceHandle);
+    if (!dev)
+      return;
+
+    while (true) {
+      auto it = refCounts.lower_bound({deviceHandle, 0});
+      if (it == refCounts.end() || it->first.first != deviceHandle)
+        break;
+      releaseObject(deviceHandle, it->first.second);
+    }
+
+    if (sharedDevice && dev == sharedDevice->device)
+      sharedDevices.release(sharedDevice);
+    else
+      anariRelease(dev, dev);
+
+    resourceManager.anariDevices[deviceHandle] = nullptr;
+  }
+
+  // Called on the worker thread once the client disconnected
+  void end()
+  {
+    std::unique_lock<std::mutex> deviceLock;
+    if (sharedDevice)
+      deviceLock = std::unique_lock<std::mutex>(sharedDevice->mutex);
+
+    for (auto &[array, ptr] : mappedArrays) {
+      (void)ptr;
+      anariUnmapArray(arrayDevice(array), array);
+    }
+    mappedArrays.clear();
+
+    for (Handle h = 0; h < resourceManager.anariDevices.size(); ++h)
+      releaseDevice(h);
+
+    LOG(logging::Level::Info) << "Session " << id << ": ended";
+    ended = true;
+  }
+
+  ANARIDevice arrayDevice(ANARIArray array)
+  {
+    for (const auto &objects : resourceManager.registeredObjects) {
+      for (const auto &obj : objects) {
+        if (obj.object == array)
+          return obj.device;
+      }
+    }
+    return nullptr;
+  }
+
+  void forgetArrayParams(Handle deviceHandle, Handle objectHandle)
+  {
+    auto first = arrayParams.lower_bound(
+        std::make_tuple(deviceHandle, objectHandle, std::string()));
+    auto last = first;
+    while (last != arrayParams.end() && std::get<0>(last->first) == deviceHandle
+        && std::get<1>(last->first) == objectHandle)
+      ++last;
+    arrayParams.erase(first, last);
+  }
+
+  // Let a handle refer to another array, moving the client's references
+  void moveHandle(Handle deviceHandle, Handle arrayHandle, ANARIArray array)
+  {
+    ObjectDesc &obj =
+        resourceManager.registeredObjects[deviceHandle][arrayHandle];
+    uint32_t refs = refCounts[{deviceHandle, arrayHandle}];
+    for (uint32_t i = 0; i < refs; ++i) {
+      anariRetain(obj.device, array);
+      anariRelease(obj.device, obj.object);
+    }
+    obj.object = array;
+  }
+
+  // Called once an array of the shared device was written, while it is still
+  // mapped: returns an array with the same contents to move the handle over
+  // to, if one exists. Otherwise this array becomes the one with these
+  // contents. Arrays already used as parameters are left alone, since the
+  // objects using them would keep them alive anyway.
+  ANARIArray findDuplicateArray(
+      Handle deviceHandle, Handle arrayHandle, const uint8_t *contents)
+  {
+    ObjectDesc obj = resourceManager.getObjectDesc(deviceHandle, arrayHandle);
+    ArrayInfo info = resourceManager.getArrayInfo(deviceHandle, arrayHandle);
+    size_t numBytes = info.getSizeInBytes();
+    auto key = SharedDevice::makeKey(info, hashContents(contents, numBytes));
+
+    auto it = sharedDevice->arrays.find(key);
+    if (it == sharedDevice->arrays.end()) {
+      sharedDevice->arrays[key] = {(ANARIArray)obj.object, 1};
+      sharedDevice->arrayKeys[(ANARIArray)obj.object] = key;
+      return nullptr;
+    }
+
+    for (const auto &[param, array] : arrayParams) {
+      if (std::get<0>(param) == deviceHandle && array == arrayHandle)
+        return nullptr;
+    }
+
+    // Equal hashes only make equal contents likely
+    ANARIArray other = it->second.array;
+    auto *otherContents = (const uint8_t *)anariMapArray(obj.device, other);
+    bool equal = otherContents
+        && std::memcmp(contents, otherContents, numBytes) == 0;
+    anariUnmapArray(obj.device, other);
+
+    if (!equal) {
+      LOG(logging::Level::Warning)
+          << "Session " << id << ": array " << arrayHandle
+          << " has the same hash as another array but different contents";
+      return nullptr;
+    }
+
+    return other;
+  }
+
+  // Move the handle of an unmapped array over to an array found by
+  // findDuplicateArray(), freeing the array it referred to
+  void deduplicateArray(Handle deviceHandle, Handle arrayHandle, ANARIArray dup)
+  {
+    ArrayInfo info = resourceManager.getArrayInfo(deviceHandle, arrayHandle);
+
+    moveHandle(deviceHandle, arrayHandle, dup);
+    sharedDevice->arrays[sharedDevice->arrayKeys[dup]].numHandles++;
+
+    LOG(logging::Level::Info)
+        << "Session " << id << ": array " << arrayHandle
+        << " has the same contents as another array, saved "
+        << prettyBytes(info.getSizeInBytes());
+  }
+
+  // Called before an array is mapped or written to: arrays shared with other
+  // handles are copied first (copy on write)
+  ANARIObject makeArrayPrivate(Handle deviceHandle, Handle arrayHandle)
+  {
+    ObjectDesc obj = resourceManager.getObjectDesc(deviceHandle, arrayHandle);
+    if (!sharedDevice || obj.device != sharedDevice->device)
+      return obj.object;
+
+    auto keyIt = sharedDevice->arrayKeys.find((ANARIArray)obj.object);
+    if (keyIt == sharedDevice->arrayKeys.end())
+      return obj.object;
+
+    auto it = sharedDevice->arrays.find(keyIt->second);
+    if (it->second.numHandles == 1) {
+      sharedDevice->arrays.erase(it);
+      sharedDevice->arrayKeys.erase(keyIt);
+      return obj.object;
+    }
+    it->second.numHandles--;
+
+    ArrayInfo info = resourceManager.getArrayInfo(deviceHandle, arrayHandle);
+    auto *contents =
+        (const uint8_t *)anariMapArray(obj.device, (ANARIArray)obj.object);
+    ANARIArray copy = newArray(obj.device, info, contents);
+    anariUnmapArray(obj.device, (ANARIArray)obj.object);
+
+    moveHandle(deviceHandle, arrayHandle, copy);
+    anariRelease(obj.device, copy);
+
+    // Objects of this session using the array see the copy from now on. They
+    // are committed for that, unless the client has other changes pending on
+    // them, which must wait for the client's commit; that commit then applies
+    // the copy as well.
+    for (const auto &[param, array] : arrayParams) {
+      if (std::get<0>(param) != deviceHandle || array != arrayHandle)
+        continue;
+      ObjectDesc user =
+          resourceManager.getObjectDesc(deviceHandle, std::get<1>(param));
+      anariSetParameter(user.device,
+          user.object,
+          std::get<2>(param).c_str(),
+          info.type,
+          &copy);
+      if (!uncommittedObjects.count({deviceHandle, std::get<1>(param)}))
+        anariCommitParameters(user.device, user.object);
+    }
+
+    return copy;
+  }
+
+  void forgetSharedArray(ANARIDevice dev, ANARIArray array)
+  {
+    if (!sharedDevice || dev != sharedDevice->device)
+      return;
+
+    auto keyIt = sharedDevice->arrayKeys.find(array);
+    if (keyIt == sharedDevice->arrayKeys.end())
+      return;
+
+    auto it = sharedDevice->arrays.find(keyIt->second);
+    if (--it->second.numHandles == 0) {
+      sharedDevice->arrays.erase(it);
+      sharedDevice->arrayKeys.erase(keyIt);
+    }
+  }
+
+  // Called on the connection manager's thread, messages are processed in
+  // order on the session's worker thread
   void handleMessage(async::connection::reason reason,
       async::message_pointer message,
       std::error_code const &e)
+  {
+    if (reason != async::connection::Read)
+      return;
+
+    worker.post([this, message, e]() { processMessage(message, e); });
+  }
+
+  void processMessage(async::message_pointer message, std::error_code e)
   {
     if (e) {
-      LOG(logging::Level::Error) << "Server: error: " << e.message();
+      LOG(logging::Level::Info)
+          << "Session " << id << ": connection closed: " << e.message();
 
-      manager->stop();
+      end();
       return;
     }
 
@@ -335,524 +1088,685 @@ struct Server
         << "Message: " << toString(message->type())
         << ", message size: " << prettyBytes(message->size());
 
+    // Sessions sharing a device take turns
+    std::unique_lock<std::mutex> deviceLock;
+    if (sharedDevice)
+      deviceLock = std::unique_lock<std::mutex>(sharedDevice->mutex);
+
+    if (message->type() != MessageType::Batch) {
+      handleRequest(message->type(), message->data(), message->size());
+      return;
+    }
+
+    Buffer batch(message->data(), message->size());
+    while (batch.pos < batch.size()) {
+      uint32_t type = 0, size = 0;
+      if (!batch.read(type) || !batch.read(size)
+          || batch.pos + size > batch.size()) {
+        LOG(logging::Level::Error)
+            << "Session " << id << ": malformed batch message";
+        return;
+      }
+      handleRequest(type, batch.data() + batch.pos, size);
+      batch.seek(batch.pos + size);
+    }
+  }
+
+  // Handles a single client message, either received on its own or as part
+  // of a batch
+  void handleRequest(unsigned messageType, const char *data, size_t numBytes)
+  {
 #define CHECK(obj, errorMessage)                                               \
   if (!obj) {                                                                  \
     LOG(logging::Level::Error) << errorMessage;                                \
     return;                                                                    \
   }
 
-    if (reason == async::connection::Read) {
-      // Buffer with all the inputs
-      auto inputBuffer =
-          std::make_shared<Buffer>(message->data(), message->size());
-
-      // Receive common object information:
-      ObjectDesc remoteObj, serverObj;
-      inputBuffer->read(remoteObj);
-
-      // Translate to handles compatible with the underlying device:
-      serverObj = resourceManager.getObjectDesc(
-          (Handle)remoteObj.device, (Handle)remoteObj.object);
-      // Bring these in sync, in case the object wasn't registered yet:
-      serverObj.type = remoteObj.type;
-      serverObj.subtype = remoteObj.subtype;
+    // Buffer with all the inputs
+    auto inputBuffer = std::make_shared<Buffer>(data, numBytes);
+
+    // Receive common object information:
+    ObjectDesc remoteObj, serverObj;
+    inputBuffer->read(remoteObj);
+
+    // Translate to handles compatible with the underlying device:
+    serverObj = resourceManager.getObjectDesc(
+        (Handle)remoteObj.device, (Handle)remoteObj.object);
+    // Bring these in sync, in case the object wasn't registered yet:
+    serverObj.type = remoteObj.type;
+    serverObj.subtype = remoteObj.subtype;
+
+    if (messageType == MessageType::NewDevice) {
+      std::string deviceType;
+      inputBuffer->read(deviceType);
+      inputBuffer->read(client.compression);
+
+      // Map the client's shared memory rings if it runs on this host
+      std::string ringName;
+      uint64_t ringToken = 0;
+      if (inputBuffer->pos < numBytes) {
+        inputBuffer->read(ringName);
+        inputBuffer->read(ringToken);
+      }
+      int32_t sharedMemory = !ringName.empty() && conn->is_local()
+          && fromClient.open(ringName + ".srv", ringToken)
+          && toClient.open(ringName + ".cli", ringToken);
+      if (!sharedMemory) {
+        fromClient.reset();
+        toClient.reset();
+      }
 
-      if (message->type() == MessageType::NewDevice) {
-        std::string deviceType;
-        inputBuffer->read(deviceType);
-        inputBuffer->read(client.compression);
+      ANARIDevice dev = nullptr;
+      if (g_shareDevices && !sharedDevice) {
+        sharedDevice = sharedDevices.acquire(deviceType);
+        dev = sharedDevice->device;
+      } else {
+        dev = anariNewDevice(g_library, deviceType.c_str());
+      }
+      Handle deviceHandle = resourceManager.registerDevice(dev);
+      CompressionFeatures cf = getCompressionFeatures();
+
+      // return device handle and other info to client
+      auto outputBuffer = std::make_shared<Buffer>();
+      outputBuffer->write(deviceHandle);
+      outputBuffer->write(cf);
+      outputBuffer->write(sharedMemory);
+      write(MessageType::DeviceHandle, outputBuffer);
+
+      LOG(logging::Level::Info)
+          << "Creating new device, type: " << deviceType
+          << ", device ID: " << deviceHandle << ", ANARI handle: " << dev;
+      LOG(logging::Level::Info)
+          << "Client has TurboJPEG: " << client.compression.hasTurboJPEG;
+      LOG(logging::Level::Info)
+          << "Client has SNAPPY: " << client.compression.hasSNAPPY;
+      LOG(logging::Level::Info)
+          << "Client has float depth: " << client.compression.hasFloatDepth;
+      LOG(logging::Level::Info) << "Using shared memory: " << sharedMemory;
+    } else if (messageType == MessageType::NewObject) {
+      CHECK(serverObj.device, "Error on anariNewObject: invalid device");
+
+      ANARIObject anariObj =
+          newObject(serverObj.device, serverObj.type, serverObj.subtype);
+
+      resourceManager.registerObject((Handle)remoteObj.device,
+          (Handle)remoteObj.object,
+          anariObj,
+          remoteObj.type);
+      refCounts[{(Handle)remoteObj.device, (Handle)remoteObj.object}] = 1;
+
+      LOG(logging::Level::Info)
+          << "Creating new object, objectID: " << remoteObj.object
+          << ", ANARI handle: " << anariObj;
+    } else if (messageType == MessageType::NewArray) {
+      CHECK(serverObj.device, "Error on anariNewArray: invalid device");
+
+      ArrayInfo info;
+      info.type = serverObj.type;
+
+      inputBuffer->read(info.elementType);
+      inputBuffer->read(info.numItems1);
+      inputBuffer->read(info.numItems2);
+      inputBuffer->read(info.numItems3);
+
+      if (g_sessionMemory != 0
+          && arrayBytes + info.getSizeInBytes() > g_sessionMemory) {
+        LOG(logging::Level::Error)
+            << "Session " << id << ": array memory quota of "
+            << prettyBytes(g_sessionMemory) << " exceeded, array "
+            << remoteObj.object << " not created";
+        return;
+      }
+      arrayBytes += info.getSizeInBytes();
 
-        ANARIDevice dev = anariNewDevice(g_library, deviceType.c_str());
-        Handle deviceHandle = resourceManager.registerDevice(dev);
-        CompressionFeatures cf = getCompressionFeatures();
+      std::vector<uint8_t> arrayData;
+      if (inputBuffer->pos < numBytes) {
+        arrayData = translateArrayData(*inputBuffer, remoteObj.device, info);
+      }
 
-        // return device handle and other info to client
-        auto outputBuffer = std::make_shared<Buffer>();
-        outputBuffer->write(deviceHandle);
-        outputBuffer->write(cf);
-        write(MessageType::DeviceHandle, outputBuffer);
+      ANARIArray anariArr = newArray(serverObj.device, info, arrayData.data());
+      resourceManager.registerArray((uint64_t)remoteObj.device,
+          (uint64_t)remoteObj.object,
+          anariArr,
+          info);
+      refCounts[{(Handle)remoteObj.device, (Handle)remoteObj.object}] = 1;
+
+      LOG(logging::Level::Info)
+          << "Creating new array, objectID: " << remoteObj.object
+          << ", ANARI handle: " << anariArr;
+    } else if (messageType == MessageType::SetParam) {
+      CHECK(serverObj.device, "Error on anariSetParameter: invalid device");
+      CHECK(serverObj.object, "Error on anariSetParameter: invalid object");
+
+      std::string name;
+      inputBuffer->read(name);
+
+      ANARIDataType parmType;
+      inputBuffer->read(parmType);
+
+      auto param = std::make_tuple(
+          (Handle)remoteObj.device, (Handle)remoteObj.object, name);
+      arrayParams.erase(param);
+      uncommittedObjects.insert(
+          {(Handle)remoteObj.device, (Handle)remoteObj.object});
+
+      if (anari::isObject(parmType)) {
+        Handle hnd;
+        inputBuffer->read((char *)&hnd, sizeof(hnd));
+
+        if (anari::isArray(parmType))
+          arrayParams[param] = hnd;
+
+        const auto &registeredObjects =
+            resourceManager.registeredObjects[(uint64_t)remoteObj.device];
+        anariSetParameter(serverObj.device,
+            serverObj.object,
+            name.c_str(),
+            parmType,
+            &registeredObjects[hnd].object);
 
         LOG(logging::Level::Info)
-            << "Creating new device, type: " << deviceType
-            << ", device ID: " << deviceHandle << ", ANARI handle: " << dev;
-        LOG(logging::Level::Info)
-            << "Client has TurboJPEG: " << client.compression.hasTurboJPEG;
-        LOG(logging::Level::Info)
-            << "Client has SNAPPY: " << client.compression.hasSNAPPY;
-      } else if (message->type() == MessageType::NewObject) {
-        CHECK(serverObj.device, "Error on anariNewObject: invalid device");
-
-        ANARIObject anariObj =
-            newObject(serverObj.device, serverObj.type, serverObj.subtype);
-
-        resourceManager.registerObject((Handle)remoteObj.device,
-            (Handle)remoteObj.object,
-            anariObj,
-            remoteObj.type);
+            << "Set param \"" << name << "\" on object: " << remoteObj.object
+            << ", param is an object. Handle: " << hnd
+            << ", ANARI handle: " << registeredObjects[hnd].object;
+      } else if (parmType == ANARI_STRING) {
+        std::string parmValue;
+        inputBuffer->read(parmValue);
+
+        anariSetParameter(serverObj.device,
+            serverObj.object,
+            name.c_str(),
+            parmType,
+            parmValue.c_str());
 
         LOG(logging::Level::Info)
-            << "Creating new object, objectID: " << remoteObj.object
-            << ", ANARI handle: " << anariObj;
-      } else if (message->type() == MessageType::NewArray) {
-        CHECK(serverObj.device, "Error on anariNewArray: invalid device");
-
-        ArrayInfo info;
-        info.type = serverObj.type;
-
-        inputBuffer->read(info.elementType);
-        inputBuffer->read(info.numItems1);
-        inputBuffer->read(info.numItems2);
-        inputBuffer->read(info.numItems3);
-
-        std::vector<uint8_t> arrayData;
-        if (inputBuffer->pos < message->size()) {
-          arrayData = translateArrayData(*inputBuffer, remoteObj.device, info);
-        }
+            << "Set param \"" << name << "\" on object: " << remoteObj.object;
+      } else {
+        std::vector<char> parmValue(anari::sizeOf(parmType));
+        inputBuffer->read((char *)parmValue.data(), anari::sizeOf(parmType));
 
-        ANARIArray anariArr =
-            newArray(serverObj.device, info, arrayData.data());
-        resourceManager.registerArray((uint64_t)remoteObj.device,
-            (uint64_t)remoteObj.object,
-            anariArr,
-            info);
+        anariSetParameter(serverObj.device,
+            serverObj.object,
+            name.c_str(),
+            parmType,
+            parmValue.data());
 
         LOG(logging::Level::Info)
-            << "Creating new array, objectID: " << remoteObj.object
-            << ", ANARI handle: " << anariArr;
-      } else if (message->type() == MessageType::SetParam) {
-        CHECK(serverObj.device, "Error on anariSetParameter: invalid device");
-        CHECK(serverObj.object, "Error on anariSetParameter: invalid object");
-
-        std::string name;
-        inputBuffer->read(name);
-
-        ANARIDataType parmType;
-        inputBuffer->read(parmType);
-
-        if (anari::isObject(parmType)) {
-          Handle hnd;
-          inputBuffer->read((char *)&hnd, sizeof(hnd));
-
-          const auto &registeredObjects =
-              resourceManager.registeredObjects[(uint64_t)remoteObj.device];
-          anariSetParameter(serverObj.device,
-              serverObj.object,
-              name.c_str(),
-              parmType,
-              &registeredObjects[hnd].object);
-
-          LOG(logging::Level::Info)
-              << "Set param \"" << name << "\" on object: " << remoteObj.object
-              << ", param is an object. Handle: " << hnd
-              << ", ANARI handle: " << registeredObjects[hnd].object;
-        } else if (parmType == ANARI_STRING) {
-          std::string parmValue;
-          inputBuffer->read(parmValue);
-
-          anariSetParameter(serverObj.device,
-              serverObj.object,
-              name.c_str(),
-              parmType,
-              parmValue.c_str());
-
-          LOG(logging::Level::Info)
-              << "Set param \"" << name << "\" on object: " << remoteObj.object;
-        } else {
-          std::vector<char> parmValue(anari::sizeOf(parmType));
-          inputBuffer->read((char *)parmValue.data(), anari::sizeOf(parmType));
+            << "Set param \"" << name << "\" on object: " << remoteObj.object;
+      }
+    } else if (messageType == MessageType::UnsetParam) {
+      CHECK(serverObj.device, "Error on anariUnsetParameter: invalid device");
+      CHECK(serverObj.object, "Error on anariUnsetParameter: invalid object");
+
+      std::string name;
+      inputBuffer->read(name);
+
+      anariUnsetParameter(serverObj.device, serverObj.object, name.c_str());
+      arrayParams.erase(std::make_tuple(
+          (Handle)remoteObj.device, (Handle)remoteObj.object, name));
+      uncommittedObjects.insert(
+          {(Handle)remoteObj.device, (Handle)remoteObj.object});
+    } else if (messageType == MessageType::UnsetAllParams) {
+      CHECK(serverObj.device,
+          "Error on anariUnsetAllParameters: invalid device");
+      CHECK(serverObj.device,
+          "Error on anariUnsetAllParameters: invalid object");
+
+      anariUnsetAllParameters(serverObj.device, serverObj.object);
+      forgetArrayParams((Handle)remoteObj.device, (Handle)remoteObj.object);
+      uncommittedObjects.insert(
+          {(Handle)remoteObj.device, (Handle)remoteObj.object});
+    } else if (messageType == MessageType::CommitParams) {
+      CHECK(serverObj.device, "Error on anariCommitParameters: invalid device");
+      CHECK(serverObj.object, "Error on anariCommitParameters: invalid object");
+
+      anariCommitParameters(serverObj.device, serverObj.object);
+      uncommittedObjects.erase(
+          {(Handle)remoteObj.device, (Handle)remoteObj.object});
+
+      LOG(logging::Level::Info)
+          << "Committed object. Handle: " << remoteObj.object;
+    } else if (messageType == MessageType::Release) {
+      CHECK(serverObj.device, "Error on anariRelease: invalid device");
+      CHECK(serverObj.object, "Error on anariRelease: invalid object");
+
+      // Releasing a device the client retained only undoes the retain
+      bool retained = refCounts.count(
+          {(Handle)remoteObj.device, (Handle)remoteObj.object});
+      if (serverObj.object == serverObj.device && !retained)
+        releaseDevice((Handle)remoteObj.device);
+      else
+        releaseObject((Handle)remoteObj.device, (Handle)remoteObj.object);
+
+      // Histories are keyed by the client's frame handle, which is never
+      // reused, so this only keeps the map from growing with every frame
+      encodeQueue.post([this, object = remoteObj.object]() {
+        colorHistory.erase(object);
+      });
+
+      LOG(logging::Level::Info)
+          << "Released object. Handle: " << remoteObj.object;
+    } else if (messageType == MessageType::Retain) {
+      CHECK(serverObj.device, "Error on anariRetain: invalid device");
+      CHECK(serverObj.object, "Error on anariRetain: invalid object");
+
+      anariRetain(serverObj.device, serverObj.object);
+      refCounts[{(Handle)remoteObj.device, (Handle)remoteObj.object}]++;
+
+      LOG(logging::Level::Info)
+          << "Retained object. Handle: " << remoteObj.object;
+    } else if (messageType == MessageType::MapArray) {
+      CHECK(serverObj.device, "Error on anariMapArray: invalid device");
+
+      // E.g., the array exceeded the memory quota; reply anyway so the
+      // client does not wait forever (it maps a null pointer)
+      if (!serverObj.object) {
+        LOG(logging::Level::Error) << "Error on anariMapArray: invalid object";
+        auto outputBuffer = std::make_shared<Buffer>();
+        outputBuffer->write(remoteObj.object);
+        outputBuffer->write(uint64_t(0));
+        write(MessageType::ArrayMapped, outputBuffer);
+        return;
+      }
 
-          anariSetParameter(serverObj.device,
-              serverObj.object,
-              name.c_str(),
-              parmType,
-              parmValue.data());
+      serverObj.object =
+          makeArrayPrivate((Handle)remoteObj.device, (Handle)remoteObj.object);
+      void *ptr = mapArray(serverObj.device, (ANARIArray)serverObj.object);
 
-          LOG(logging::Level::Info)
-              << "Set param \"" << name << "\" on object: " << remoteObj.object;
-        }
-      } else if (message->type() == MessageType::UnsetParam) {
-        CHECK(serverObj.device, "Error on anariUnsetParameter: invalid device");
-        CHECK(serverObj.object, "Error on anariUnsetParameter: invalid object");
+      const ArrayInfo &info = resourceManager.getArrayInfo(
+          (Handle)remoteObj.device, (Handle)remoteObj.object);
 
-        std::string name;
-        inputBuffer->read(name);
+      uint64_t numBytes = info.getSizeInBytes();
 
-        anariUnsetParameter(serverObj.device, serverObj.object, name.c_str());
-      } else if (message->type() == MessageType::UnsetAllParams) {
-        CHECK(serverObj.device,
-            "Error on anariUnsetAllParameters: invalid device");
-        CHECK(serverObj.device,
-            "Error on anariUnsetAllParameters: invalid object");
+      auto outputBuffer = std::make_shared<Buffer>();
+      outputBuffer->write(remoteObj.object);
+      outputBuffer->write(numBytes);
+      outputBuffer->write((const char *)ptr, numBytes);
+      write(MessageType::ArrayMapped, outputBuffer);
 
-        anariUnsetAllParameters(serverObj.device, serverObj.object);
-      } else if (message->type() == MessageType::CommitParams) {
-        CHECK(
-            serverObj.device, "Error on anariCommitParameters: invalid device");
-        CHECK(
-            serverObj.object, "Error on anariCommitParameters: invalid object");
+      LOG(logging::Level::Info) << "Mapped array. Handle: " << remoteObj.object;
+    } else if (messageType == MessageType::ArrayData) {
+      CHECK(serverObj.device, "Error on array data: invalid device");
+      CHECK(serverObj.object, "Error on array data: invalid object");
 
-        anariCommitParameters(serverObj.device, serverObj.object);
+      uint64_t offset = 0, numBytes = 0;
+      uint32_t encoding = ArrayDataEncoding::Raw;
+      inputBuffer->read(offset);
+      inputBuffer->read(numBytes);
+      inputBuffer->read(encoding);
 
-        LOG(logging::Level::Info)
-            << "Committed object. Handle: " << remoteObj.object;
-      } else if (message->type() == MessageType::Release) {
-        CHECK(serverObj.device, "Error on anariRelease: invalid device");
-        CHECK(serverObj.object, "Error on anariRelease: invalid object");
+      ArrayInfo info = resourceManager.getArrayInfo(
+          (Handle)remoteObj.device, (Handle)remoteObj.object);
+      if (offset + numBytes > info.getSizeInBytes()) {
+        LOG(logging::Level::Error)
+            << "Error on array data: chunk exceeds array size";
+        return;
+      }
 
-        anariRelease(serverObj.device, serverObj.object);
+      serverObj.object =
+          makeArrayPrivate((Handle)remoteObj.device, (Handle)remoteObj.object);
+      uint8_t *ptr =
+          mapArray(serverObj.device, (ANARIArray)serverObj.object) + offset;
+
+      // XOR deltas need the payload in a scratch buffer first
+      bool isDelta = encoding & ArrayDataEncoding::XOR;
+      if (isDelta)
+        arrayDataScratch.resize(numBytes);
+      uint8_t *dst = isDelta ? arrayDataScratch.data() : ptr;
+
+      if (encoding & ArrayDataEncoding::SharedMemory) {
+        uint64_t ringPos = 0;
+        inputBuffer->read(ringPos);
+        if (!fromClient.valid()) {
+          LOG(logging::Level::Error)
+              << "Error on array data: shared memory is not mapped";
+          return;
+        }
+        const uint8_t *src = fromClient.data(ringPos, numBytes);
+        if (!src) {
+          LOG(logging::Level::Error)
+              << "Error on array data: invalid shared memory range";
+          return;
+        }
+        memcpy(dst, src, numBytes);
+        fromClient.release(ringPos, numBytes);
+      } else if (encoding & ArrayDataEncoding::SNAPPY) {
+        uint64_t compressedSize = 0;
+        inputBuffer->read(compressedSize);
+        if (inputBuffer->pos + compressedSize > inputBuffer->size()) {
+          LOG(logging::Level::Error)
+              << "Error on array data: chunk exceeds message size";
+          return;
+        }
+        SNAPPYOptions options;
+        options.inputSize = numBytes;
+        if (!uncompressSNAPPY(
+                (const uint8_t *)inputBuffer->data() + inputBuffer->pos,
+                dst,
+                compressedSize,
+                options)) {
+          LOG(logging::Level::Error)
+              << "Error on array data: snappy::RawUncompress failed";
+          return;
+        }
+      } else {
+        inputBuffer->read((char *)dst, numBytes);
+      }
 
-        LOG(logging::Level::Info)
-            << "Released object. Handle: " << remoteObj.object;
-      } else if (message->type() == MessageType::Retain) {
-        CHECK(serverObj.device, "Error on anariRetain: invalid device");
-        CHECK(serverObj.object, "Error on anariRetain: invalid object");
+      if (isDelta) {
+        for (size_t i = 0; i < numBytes; ++i)
+          ptr[i] ^= dst[i];
+      }
 
-        anariRetain(serverObj.device, serverObj.object);
+      translateArrayHandles(remoteObj.device, info.elementType, ptr, numBytes);
 
-        LOG(logging::Level::Info)
-            << "Retained object. Handle: " << remoteObj.object;
-      } else if (message->type() == MessageType::MapArray) {
-        CHECK(serverObj.device, "Error on anariMapArray: invalid device");
-        CHECK(serverObj.object, "Error on anariMapArray: invalid object");
+      LOG(logging::Level::Info)
+          << "Array data received. Handle: " << remoteObj.object
+          << ", offset: " << offset << ", bytes: " << prettyBytes(numBytes);
+    } else if (messageType == MessageType::UnmapArray) {
+      CHECK(serverObj.device, "Error on anariUnmapArray: invalid device");
+      CHECK(serverObj.object, "Error on anariUnmapArray: invalid object");
 
-        void *ptr =
-            anariMapArray(serverObj.device, (ANARIArray)serverObj.object);
+      // Contents arrived with the preceding ArrayData messages; arrays of
+      // shared devices are compared while still mapped to find duplicates
+      ArrayInfo info = resourceManager.getArrayInfo(
+          (Handle)remoteObj.device, (Handle)remoteObj.object);
+      auto mapped = mappedArrays.find((ANARIArray)serverObj.object);
+      ANARIArray dup = nullptr;
+      if (sharedDevice && serverObj.device == sharedDevice->device
+          && mapped != mappedArrays.end()
+          && !anari::isObject(info.elementType)) {
+        dup = findDuplicateArray(
+            (Handle)remoteObj.device, (Handle)remoteObj.object, mapped->second);
+      }
 
-        const ArrayInfo &info = resourceManager.getArrayInfo(
-            (Handle)remoteObj.device, (Handle)remoteObj.object);
+      unmapArray(serverObj.device, (ANARIArray)serverObj.object);
 
-        uint64_t numBytes = info.getSizeInBytes();
+      if (dup) {
+        deduplicateArray(
+            (Handle)remoteObj.device, (Handle)remoteObj.object, dup);
+      }
 
-        auto outputBuffer = std::make_shared<Buffer>();
-        outputBuffer->write(remoteObj.object);
-        outputBuffer->write(numBytes);
-        outputBuffer->write((const char *)ptr, numBytes);
-        write(MessageType::ArrayMapped, outputBuffer);
+      LOG(logging::Level::Info)
+          << "Unmapped array. Handle: " << remoteObj.object;
+    } else if (messageType == MessageType::RenderFrame) {
+      CHECK(serverObj.device, "Error on anariRenderFrame: invalid device");
+      CHECK(serverObj.object, "Error on anariRenderFrame: invalid object");
 
-        LOG(logging::Level::Info)
-            << "Mapped array. Handle: " << remoteObj.object;
-      } else if (message->type() == MessageType::UnmapArray) {
-        CHECK(serverObj.device, "Error on anariUnmapArray: invalid device");
-        CHECK(serverObj.object, "Error on anariUnmapArray: invalid object");
-
-        // Array is currently mapped - unmap
-        anariUnmapArray(serverObj.device, (ANARIArray)serverObj.object);
-
-        // Now map so we can write to it
-        void *ptr =
-            anariMapArray(serverObj.device, (ANARIArray)serverObj.object);
-
-        // Fetch data into separate buffer and copy
-        std::vector<uint8_t> arrayData;
-        if (inputBuffer->pos < message->size()) {
-          ArrayInfo info = resourceManager.getArrayInfo(
-              (Handle)remoteObj.device, (Handle)remoteObj.object);
-          arrayData = translateArrayData(*inputBuffer, remoteObj.device, info);
-          memcpy(ptr, arrayData.data(), arrayData.size());
-        }
+      ANARIFrame frame = (ANARIFrame)serverObj.object;
 
-        // Unmap again..
-        anariUnmapArray(serverObj.device, (ANARIArray)serverObj.object);
+      anariRenderFrame(serverObj.device, frame);
+      anariFrameReady(serverObj.device, frame, ANARI_WAIT);
 
-        auto outputBuffer = std::make_shared<Buffer>();
-        outputBuffer->write(remoteObj.object);
-        write(MessageType::ArrayUnmapped, outputBuffer);
+      // Copy the channels out so the device can render the next frame (and
+      // we can process the next messages) while this one is encoded
+      auto channels = std::make_shared<FrameChannels>();
+      channels->frame = remoteObj.object;
+      readChannel(serverObj.device, frame, "channel.color", channels->color);
+      readChannel(serverObj.device, frame, "channel.depth", channels->depth);
 
-        LOG(logging::Level::Info)
-            << "Unmapped array. Handle: " << remoteObj.object;
-      } else if (message->type() == MessageType::RenderFrame) {
-        CHECK(serverObj.device, "Error on anariRenderFrame: invalid device");
-        CHECK(serverObj.object, "Error on anariRenderFrame: invalid object");
-
-        ANARIFrame frame = (ANARIFrame)serverObj.object;
-
-        anariRenderFrame(serverObj.device, frame);
-
-        // Block and send image over the wire
-        anariFrameReady(serverObj.device, frame, ANARI_WAIT);
-
-        CompressionFeatures cf = getCompressionFeatures();
-
-        uint32_t width, height;
-        ANARIDataType type;
-        const char *color = (const char *)anariMapFrame(
-            serverObj.device, frame, "channel.color", &width, &height, &type);
-        size_t colorSize =
-            type == ANARI_UNKNOWN ? 0 : width * height * anari::sizeOf(type);
-        if (color != nullptr && colorSize != 0) {
-          auto outputBuffer = std::make_shared<Buffer>();
-          outputBuffer->write(remoteObj.object);
-          outputBuffer->write(width);
-          outputBuffer->write(height);
-          outputBuffer->write(type);
-
-          bool compressionTurboJPEG =
-              cf.hasTurboJPEG && client.compression.hasTurboJPEG;
-
-          if (compressionTurboJPEG
-              && type == ANARI_UFIXED8_RGBA_SRGB) { // TODO: more formats..
-            TurboJPEGOptions options;
-            options.width = width;
-            options.height = height;
-            options.pixelFormat = TurboJPEGOptions::PixelFormat::RGBX;
-            options.quality = 80;
-
-            std::vector<uint8_t> compressed(
-                getMaxCompressedBufferSizeTurboJPEG(options));
-
-            if (compressed.size() != 0) {
-              size_t compressedSize;
-              if (compressTurboJPEG((const uint8_t *)color,
-                      compressed.data(),
-                      compressedSize,
-                      options)) {
-                uint32_t compressedSize32(compressedSize);
-                outputBuffer->write(compressedSize32);
-                outputBuffer->write(
-                    (const char *)compressed.data(), compressedSize);
-
-                LOG(logging::Level::Info) << "turbojpeg compression size: "
-                                          << prettyBytes(compressedSize);
-              }
-            }
-          } else {
-            outputBuffer->write(color, colorSize);
-          }
-          write(MessageType::ChannelColor, outputBuffer);
-        }
+      encodeQueue.post(std::bind(&Session::sendFrame, this, channels));
 
-        const char *depth = (const char *)anariMapFrame(
-            serverObj.device, frame, "channel.depth", &width, &height, &type);
-        size_t depthSize =
-            type == ANARI_UNKNOWN ? 0 : width * height * anari::sizeOf(type);
-        if (depth != nullptr && depthSize != 0) {
-          auto outputBuffer = std::make_shared<Buffer>();
-          outputBuffer->write(remoteObj.object);
-          outputBuffer->write(width);
-          outputBuffer->write(height);
-          outputBuffer->write(type);
+      LOG(logging::Level::Info)
+          << "Frame rendered. Object handle: " << remoteObj.object;
+    } else if (messageType == MessageType::GetProperty) {
+      CHECK(serverObj.device, "Error on anariGetProperty: invalid device");
+      CHECK(serverObj.object, "Error on anariGetProperty: invalid object");
 
-          bool compressionSNAPPY = cf.hasSNAPPY && client.compression.hasSNAPPY;
+      std::string name;
+      inputBuffer->read(name);
 
-          if (compressionSNAPPY && type == ANARI_FLOAT32) {
-            SNAPPYOptions options;
-            options.inputSize = depthSize;
+      ANARIDataType type;
+      inputBuffer->read(type);
 
-            std::vector<uint8_t> compressed(
-                getMaxCompressedBufferSizeSNAPPY(options));
+      uint64_t size;
+      inputBuffer->read(size);
 
-            size_t compressedSize = 0;
+      ANARIWaitMask mask;
+      inputBuffer->read(mask);
 
-            compressSNAPPY((const uint8_t *)depth,
-                compressed.data(),
-                compressedSize,
-                options);
-
-            uint32_t compressedSize32(compressedSize);
-            outputBuffer->write(compressedSize32);
-            outputBuffer->write(
-                (const char *)compressed.data(), compressedSize);
-          } else {
-            outputBuffer->write(depth, depthSize);
-          }
-          write(MessageType::ChannelDepth, outputBuffer);
-        }
+      auto outputBuffer = std::make_shared<Buffer>();
 
-        LOG(logging::Level::Info)
-            << "Frame rendered. Object handle: " << remoteObj.object;
-      } else if (message->type() == MessageType::FrameReady) {
-        CHECK(serverObj.device, "Error on anariFrameReady: invalid device");
-        CHECK(serverObj.object, "Error on anariFrameReady: invalid object");
+      if (type == ANARI_STRING_LIST) {
+        const char *const *value = nullptr;
+        int result = anariGetProperty(serverObj.device,
+            serverObj.object,
+            name.data(),
+            type,
+            &value,
+            size,
+            mask);
 
-        ANARIWaitMask waitMask;
-        inputBuffer->read(waitMask);
+        outputBuffer->write(remoteObj.object);
+        outputBuffer->write(name);
+        outputBuffer->write(type);
+        outputBuffer->write(size);
+        outputBuffer->write(result);
 
-        ANARIFrame frame = (ANARIFrame)serverObj.object;
-        anariFrameReady(serverObj.device, frame, waitMask);
+        StringList stringList((const char **)value);
+        outputBuffer->write(stringList);
+      } else if (type == ANARI_DATA_TYPE_LIST) {
+        throw std::runtime_error(
+            "getProperty with ANARI_DATA_TYPE_LIST not implemented yet!");
+      } else { // POD!
+        std::vector<char> mem(size);
+
+        int result = anariGetProperty(serverObj.device,
+            serverObj.object,
+            name.data(),
+            type,
+            mem.data(),
+            size,
+            mask);
 
-        auto outputBuffer = std::make_shared<Buffer>();
         outputBuffer->write(remoteObj.object);
-        write(MessageType::FrameIsReady, outputBuffer);
+        outputBuffer->write(name);
+        outputBuffer->write(type);
+        outputBuffer->write(size);
+        outputBuffer->write(result);
+        outputBuffer->write((const char *)mem.data(), size);
+      }
+      write(MessageType::Property, outputBuffer);
+    } else if (messageType == MessageType::GetObjectSubtypes) {
+      CHECK(serverObj.device,
+          "Error on anariGetObjectSubtypes: invalid device");
 
-        LOG(logging::Level::Info) << "Signal frame is ready to client";
-      } else if (message->type() == MessageType::GetProperty) {
-        CHECK(serverObj.device, "Error on anariGetProperty: invalid device");
-        CHECK(serverObj.object, "Error on anariGetProperty: invalid object");
+      ANARIDataType objectType;
+      inputBuffer->read(objectType);
 
-        std::string name;
-        inputBuffer->read(name);
+      auto outputBuffer = std::make_shared<Buffer>();
+      outputBuffer->write(objectType);
 
-        ANARIDataType type;
-        inputBuffer->read(type);
+      const char **subtypes =
+          anariGetObjectSubtypes(serverObj.device, objectType);
 
-        uint64_t size;
-        inputBuffer->read(size);
+      StringList stringList(subtypes);
+      outputBuffer->write(stringList);
 
-        ANARIWaitMask mask;
-        inputBuffer->read(mask);
+      write(MessageType::ObjectSubtypes, outputBuffer);
+    } else if (messageType == MessageType::GetObjectInfo) {
+      CHECK(serverObj.device, "Error on anariGetObjectInfo: invalid device");
 
-        auto outputBuffer = std::make_shared<Buffer>();
+      ANARIDataType objectType;
+      inputBuffer->read(objectType);
 
-        if (type == ANARI_STRING_LIST) {
-          const char *const *value = nullptr;
-          int result = anariGetProperty(serverObj.device,
-              serverObj.object,
-              name.data(),
-              type,
-              &value,
-              size,
-              mask);
-
-          outputBuffer->write(remoteObj.object);
-          outputBuffer->write(name);
-          outputBuffer->write(type);
-          outputBuffer->write(size);
-          outputBuffer->write(result);
-
-          StringList stringList((const char **)value);
-          outputBuffer->write(stringList);
-        } else if (type == ANARI_DATA_TYPE_LIST) {
-          throw std::runtime_error(
-              "getProperty with ANARI_DATA_TYPE_LIST not implemented yet!");
-        } else { // POD!
-          std::vector<char> mem(size);
-
-          int result = anariGetProperty(serverObj.device,
-              serverObj.object,
-              name.data(),
-              type,
-              mem.data(),
-              size,
-              mask);
-
-          outputBuffer->write(remoteObj.object);
-          outputBuffer->write(name);
-          outputBuffer->write(type);
-          outputBuffer->write(size);
-          outputBuffer->write(result);
-          outputBuffer->write((const char *)mem.data(), size);
-        }
-        write(MessageType::Property, outputBuffer);
-      } else if (message->type() == MessageType::GetObjectSubtypes) {
-        CHECK(serverObj.device,
-            "Error on anariGetObjectSubtypes: invalid device");
+      std::string objectSubtype;
+      inputBuffer->read(objectSubtype);
 
-        ANARIDataType objectType;
-        inputBuffer->read(objectType);
+      std::string infoName;
+      inputBuffer->read(infoName);
 
-        auto outputBuffer = std::make_shared<Buffer>();
-        outputBuffer->write(objectType);
+      ANARIDataType infoType;
+      inputBuffer->read(infoType);
 
-        const char **subtypes =
-            anariGetObjectSubtypes(serverObj.device, objectType);
+      auto outputBuffer = std::make_shared<Buffer>();
+      outputBuffer->write(objectType);
+      outputBuffer->write(std::string(objectSubtype));
+      outputBuffer->write(std::string(infoName));
+      outputBuffer->write(infoType);
 
-        StringList stringList(subtypes);
-        outputBuffer->write(stringList);
+      const void *info = anariGetObjectInfo(serverObj.device,
+          objectType,
+          objectSubtype.data(),
+          infoName.data(),
+          infoType);
 
-        write(MessageType::ObjectSubtypes, outputBuffer);
-      } else if (message->type() == MessageType::GetObjectInfo) {
-        CHECK(serverObj.device, "Error on anariGetObjectInfo: invalid device");
+      if (info != nullptr) {
+        if (infoType == ANARI_STRING) {
+          auto *str = (const char *)info;
+          outputBuffer->write(std::string(str));
+        } else if (infoType == ANARI_STRING_LIST) {
+          StringList stringList((const char **)info);
+          outputBuffer->write(stringList);
+        } else if (infoType == ANARI_PARAMETER_LIST) {
+          ParameterList parameterList((const Parameter *)info);
+          outputBuffer->write(parameterList);
+        } else {
+          outputBuffer->write((const char *)info, anari::sizeOf(infoType));
+        }
+      }
+      write(MessageType::ObjectInfo, outputBuffer);
+    } else if (messageType == MessageType::GetParameterInfo) {
+      CHECK(serverObj.device, "Error on anariGetParameterInfo: invalid device");
+
+      ANARIDataType objectType;
+      inputBuffer->read(objectType);
+
+      std::string objectSubtype;
+      inputBuffer->read(objectSubtype);
+
+      std::string parameterName;
+      inputBuffer->read(parameterName);
+
+      ANARIDataType parameterType;
+      inputBuffer->read(parameterType);
+
+      std::string infoName;
+      inputBuffer->read(infoName);
+
+      ANARIDataType infoType;
+      inputBuffer->read(infoType);
+
+      auto outputBuffer = std::make_shared<Buffer>();
+      outputBuffer->write(objectType);
+      outputBuffer->write(objectSubtype);
+      outputBuffer->write(parameterName);
+      outputBuffer->write(parameterType);
+      outputBuffer->write(infoName);
+      outputBuffer->write(infoType);
+
+      const void *info = anariGetParameterInfo(serverObj.device,
+          objectType,
+          objectSubtype.data(),
+          parameterName.data(),
+          parameterType,
+          infoName.data(),
+          infoType);
+
+      if (info != nullptr) {
+        if (infoType == ANARI_STRING) {
+          auto *str = (const char *)info;
+          outputBuffer->write(std::string(str));
+        } else if (infoType == ANARI_STRING_LIST) {
+          StringList stringList((const char **)info);
+          outputBuffer->write(stringList);
+        } else if (infoType == ANARI_PARAMETER_LIST) {
+          ParameterList parameterList((const Parameter *)info);
+          outputBuffer->write(parameterList);
+        } else {
+          outputBuffer->write((const char *)info, anari::sizeOf(infoType));
+        }
+      }
+      write(MessageType::ParameterInfo, outputBuffer);
+    } else {
+      LOG(logging::Level::Warning) << "Unhandled message of size: " << numBytes;
+    }
+  }
+};
 
-        ANARIDataType objectType;
-        inputBuffer->read(objectType);
+struct Server
+{
+  explicit Server(unsigned short port = 31050)
+      : manager(async::make_connection_manager(port))
+  {
+    logging::Initialize();
 
-        std::string objectSubtype;
-        inputBuffer->read(objectSubtype);
+    g_library = anariLoadLibrary(g_libraryType.c_str(), statusFunc, &g_verbose);
+  }
 
-        std::string infoName;
-        inputBuffer->read(infoName);
+  ~Server()
+  {
+    sessions.clear();
+    anariUnloadLibrary(g_library);
+  }
 
-        ANARIDataType infoType;
-        inputBuffer->read(infoType);
+  void accept()
+  {
+    LOG(logging::Level::Info) << "Server: accepting...";
 
-        auto outputBuffer = std::make_shared<Buffer>();
-        outputBuffer->write(objectType);
-        outputBuffer->write(std::string(objectSubtype));
-        outputBuffer->write(std::string(infoName));
-        outputBuffer->write(infoType);
-
-        const void *info = anariGetObjectInfo(serverObj.device,
-            objectType,
-            objectSubtype.data(),
-            infoName.data(),
-            infoType);
-
-        if (info != nullptr) {
-          if (infoType == ANARI_STRING) {
-            auto *str = (const char *)info;
-            outputBuffer->write(std::string(str));
-          } else if (infoType == ANARI_STRING_LIST) {
-            StringList stringList((const char **)info);
-            outputBuffer->write(stringList);
-          } else if (infoType == ANARI_PARAMETER_LIST) {
-            ParameterList parameterList((const Parameter *)info);
-            outputBuffer->write(parameterList);
-          } else {
-            outputBuffer->write((const char *)info, anari::sizeOf(infoType));
-          }
-        }
-        write(MessageType::ObjectInfo, outputBuffer);
-      } else if (message->type() == MessageType::GetParameterInfo) {
-        CHECK(
-            serverObj.device, "Error on anariGetParameterInfo: invalid device");
+    manager->accept(std::bind(&Server::handleNewConnection,
+        this,
+        std::placeholders::_1,
+        std::placeholders::_2));
+  }
 
-        ANARIDataType objectType;
-        inputBuffer->read(objectType);
+  void run()
+  {
+    manager->run_in_thread();
+  }
 
-        std::string objectSubtype;
-        inputBuffer->read(objectSubtype);
+  void wait()
+  {
+    manager->wait();
+  }
 
-        std::string parameterName;
-        inputBuffer->read(parameterName);
+  bool handleNewConnection(
+      async::connection_pointer new_conn, std::error_code const &e)
+  {
+    if (e) {
+      LOG(logging::Level::Error)
+          << "Server: could not connect to client: " << e.message();
+      manager->stop();
+      return false;
+    }
 
-        ANARIDataType parameterType;
-        inputBuffer->read(parameterType);
+    // Clean up after clients that disconnected
+    sessions.remove_if(
+        [](const auto &session) { return session->ended.load(); });
+
+    if (g_maxSessions != 0 && sessions.size() >= g_maxSessions) {
+      LOG(logging::Level::Warning) << "Server: rejecting connection, already "
+                                   << sessions.size() << " session(s)";
+      // Answer with a null device handle so the client reports the error
+      // rather than waiting for one; the connection isn't kept, so it's
+      // closed once this is sent
+      auto outputBuffer = std::make_shared<Buffer>();
+      outputBuffer->write(Handle(0));
+      outputBuffer->write(CompressionFeatures{});
+      outputBuffer->write(int32_t(false));
+      new_conn->write(MessageType::DeviceHandle, *outputBuffer);
+      accept();
+      return false;
+    }
 
-        std::string infoName;
-        inputBuffer->read(infoName);
+    // Accept and save this connection, the session sets the message handler
+    auto session =
+        std::make_unique<Session>(nextSessionID++, new_conn, sharedDevices);
+    LOG(logging::Level::Info) << "Server: session " << session->id
+                              << " connected, " << sessions.size() + 1
+                              << " session(s)";
+    sessions.push_back(std::move(session));
 
-        ANARIDataType infoType;
-        inputBuffer->read(infoType);
+    // Accept new connections
+    accept();
 
-        auto outputBuffer = std::make_shared<Buffer>();
-        outputBuffer->write(objectType);
-        outputBuffer->write(objectSubtype);
-        outputBuffer->write(parameterName);
-        outputBuffer->write(parameterType);
-        outputBuffer->write(infoName);
-        outputBuffer->write(infoType);
-
-        const void *info = anariGetParameterInfo(serverObj.device,
-            objectType,
-            objectSubtype.data(),
-            parameterName.data(),
-            parameterType,
-            infoName.data(),
-            infoType);
-
-        if (info != nullptr) {
-          if (infoType == ANARI_STRING) {
-            auto *str = (const char *)info;
-            outputBuffer->write(std::string(str));
-          } else if (infoType == ANARI_STRING_LIST) {
-            StringList stringList((const char **)info);
-            outputBuffer->write(stringList);
-          } else if (infoType == ANARI_PARAMETER_LIST) {
-            ParameterList parameterList((const Parameter *)info);
-            outputBuffer->write(parameterList);
-          } else {
-            outputBuffer->write((const char *)info, anari::sizeOf(infoType));
-          }
-        }
-        write(MessageType::ParameterInfo, outputBuffer);
-      } else {
-        LOG(logging::Level::Warning)
-            << "Unhandled message of size: " << message->size();
-      }
-    } else {
-      // LOG(logging::Level::Info) << "written";
-    }
+    return true;
   }
+
+  async::connection_manager_pointer manager;
+  SharedDevices sharedDevices;
+  std::list<std::unique_ptr<Session>> sessions;
+  uint64_t nextSessionID{1};
 };
 
 } // namespace remote
@@ -864,7 +1778,13 @@ static void printUsage()
   std::cout << "./anari-remote-server [{--help|-h}]\n"
             << "   [{--verbose|-v}]\n"
             << "   [{--library|-l} <ANARI library>]\n"
-            << "   [{--port|-p} <N>]\n";
+            << "   [{--port|-p} <N>]\n"
+            << "   [{--keyframe-interval|-k} <N>]\n"
+            << "   [{--depth-precision|-d} <N>]\n"
+            << "   [{--max-sessions|-m} <N>]\n"
+            << "   [{--session-threads|-t} <N>]\n"
+            << "   [{--session-memory|-M} <MiB>]\n"
+            << "   [{--share-devices|-s}]\n";
 }
 
 static void parseCommandLine(int argc, char *argv[])
@@ -880,6 +1800,18 @@ static void parseCommandLine(int argc, char *argv[])
       g_libraryType = argv[++i];
     else if (arg == "-p" || arg == "--port")
       g_port = std::stoi(argv[++i]);
+    else if (arg == "-k" || arg == "--keyframe-interval")
+      g_keyframeInterval = std::stoi(argv[++i]);
+    else if (arg == "-d" || arg == "--depth-precision")
+      g_depthPrecision = std::min(std::stoi(argv[++i]), 23);
+    else if (arg == "-m" || arg == "--max-sessions")
+      g_maxSessions = std::stoi(argv[++i]);
+    else if (arg == "-t" || arg == "--session-threads")
+      g_sessionThreads = std::stoi(argv[++i]);
+    else if (arg == "-M" || arg == "--session-memory")
+      g_sessionMemory = std::stoull(argv[++i]) << 20;
+    else if (arg == "-s" || arg == "--share-devices")
+      g_shareDevices = true;
   }
 }
 
@@ -887,6 +1819,9 @@ int main(int argc, char *argv[])
 {
   parseCommandLine(argc, argv);
   remote::Server srv(g_port);
+  // The status callback reported why
+  if (!g_library)
+    return 1;
   srv.accept();
   srv.run();
   srv.wait();
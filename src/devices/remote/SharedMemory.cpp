@@ -0,0 +1,208 @@
+// Copyright 2023-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SharedMemory.h"
+
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace remote {
+
+// The producer and consumer are different processes, so the tail has to be
+// updated without locks
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+struct SharedRing::Header
+{
+  uint64_t token;
+  uint64_t capacity;
+  // Consumer: end of the last range released
+  alignas(64) std::atomic<uint64_t> tail;
+};
+
+// Ring data starts on its own cache line
+static constexpr size_t dataOffset = 128;
+
+SharedRing::~SharedRing()
+{
+  reset();
+}
+
+bool SharedRing::create(
+    const std::string &segmentName, size_t segmentCapacity, uint64_t token)
+{
+  static_assert(sizeof(Header) <= dataOffset);
+
+  reset();
+#ifndef _WIN32
+  int fd = shm_open(segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+    return false;
+
+  size_t size = dataOffset + segmentCapacity;
+#ifdef __APPLE__
+  // No posix_fallocate() here, and segments can only be sized once, by
+  // ftruncate(); they aren't backed by a tmpfs that could run full
+  bool allocated = ftruncate(fd, size) == 0;
+#else
+  // Allocate the pages now: a tmpfs that runs full would otherwise raise
+  // SIGBUS on first write
+  bool allocated = posix_fallocate(fd, 0, size) == 0;
+#endif
+  void *ptr = MAP_FAILED;
+  if (allocated)
+    ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  name = segmentName;
+  owner = true;
+
+  if (ptr == MAP_FAILED) {
+    reset();
+    return false;
+  }
+
+  mappedSize = size;
+  header = new (ptr) Header;
+  header->token = token;
+  header->capacity = segmentCapacity;
+  header->tail.store(0);
+  ringData = (uint8_t *)ptr + dataOffset;
+  ringCapacity = segmentCapacity;
+  head = 0;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool SharedRing::open(const std::string &segmentName, uint64_t token)
+{
+  reset();
+#ifndef _WIN32
+  int fd = shm_open(segmentName.c_str(), O_RDWR, 0);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  void *ptr = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && size_t(st.st_size) > dataOffset)
+    ptr = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (ptr == MAP_FAILED)
+    return false;
+
+  auto *hdr = (Header *)ptr;
+  const uint64_t cap = hdr->capacity;
+  if (hdr->token != token || cap == 0
+      || cap > size_t(st.st_size) - dataOffset) {
+    munmap(ptr, st.st_size);
+    return false;
+  }
+
+  name = segmentName;
+  mappedSize = st.st_size;
+  header = hdr;
+  ringData = (uint8_t *)ptr + dataOffset;
+  ringCapacity = cap;
+  head = header->tail.load();
+  return true;
+#else
+  return false;
+#endif
+}
+
+void SharedRing::unlink()
+{
+#ifndef _WIN32
+  if (owner)
+    shm_unlink(name.c_str());
+#endif
+  owner = false;
+}
+
+void SharedRing::reset()
+{
+  unlink();
+#ifndef _WIN32
+  if (header)
+    munmap(header, mappedSize);
+#endif
+  header = nullptr;
+  ringData = nullptr;
+  mappedSize = 0;
+  ringCapacity = 0;
+  name.clear();
+}
+
+bool SharedRing::reserve(size_t numBytes, uint64_t &pos, double timeout)
+{
+  size_t cap = capacity();
+  if (numBytes == 0 || numBytes > cap)
+    return false;
+
+  // Ranges are contiguous; skip the rest of the ring if it's too short
+  pos = head;
+  size_t offset = pos % cap;
+  if (offset + numBytes > cap)
+    pos += cap - offset;
+
+  auto start = std::chrono::steady_clock::now();
+  while (pos + numBytes - header->tail.load(std::memory_order_acquire) > cap) {
+    std::chrono::duration<double> waited =
+        std::chrono::steady_clock::now() - start;
+    if (waited.count() > timeout)
+      return false;
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+
+  head = pos + numBytes;
+  return true;
+}
+
+uint8_t *SharedRing::data(uint64_t pos, size_t numBytes) const
+{
+  // Ranges never wrap around the end of the ring
+  size_t cap = ringCapacity;
+  if (!ringData || numBytes > cap || pos % cap + numBytes > cap)
+    return nullptr;
+  return ringData + pos % cap;
+}
+
+bool SharedRing::release(uint64_t pos, size_t numBytes)
+{
+  if (!data(pos, numBytes))
+    return false;
+
+  // A range that was never released (e.g., its message was dropped) is
+  // released along with the next one
+  uint64_t end = pos + numBytes;
+  if (end > header->tail.load(std::memory_order_relaxed))
+    header->tail.store(end, std::memory_order_release);
+  return true;
+}
+
+std::string makeSharedMemoryName()
+{
+  static std::atomic<uint32_t> counter{0};
+#ifndef _WIN32
+  int pid = getpid();
+#else
+  int pid = 0;
+#endif
+  // Kept short: macOS limits names to 31 characters, and callers append a
+  // suffix such as ".srv"
+  return "/anari-" + std::to_string(pid) + "-" + std::to_string(counter++);
+}
+
+} // namespace remote
@@ -0,0 +1,79 @@
+// Copyright 2023-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace remote {
+
+// Byte ring in a POSIX shared memory segment, to pass bulk data between a
+// client and a server on the same host without going through the socket.
+// There is one producer and one consumer: the producer reserves contiguous
+// ranges, fills them, and sends their position in a (small) message; the
+// consumer releases them in the order they were reserved.
+struct SharedRing
+{
+  SharedRing() = default;
+  ~SharedRing();
+
+  SharedRing(const SharedRing &) = delete;
+  SharedRing &operator=(const SharedRing &) = delete;
+
+  // Create and map a new segment; 'token' lets the other side check that it
+  // opened the right one
+  bool create(const std::string &name, size_t capacity, uint64_t token);
+
+  // Map a segment the other side created
+  bool open(const std::string &name, uint64_t token);
+
+  // Remove the segment's name once both sides mapped it, so that it can't
+  // outlive them
+  void unlink();
+
+  // Unmap (and unlink) the segment
+  void reset();
+
+  bool valid() const
+  {
+    return header != nullptr;
+  }
+
+  size_t capacity() const
+  {
+    return ringCapacity;
+  }
+
+  // Producer: reserve numBytes contiguous bytes, waiting up to 'timeout'
+  // seconds for the consumer to release enough of them (false if they don't
+  // fit, or the ring is not mapped)
+  bool reserve(size_t numBytes, uint64_t &pos, double timeout);
+
+  // Memory of the range of numBytes at 'pos', or null if the range is not one
+  // reserve() could have returned (positions come from the other process)
+  uint8_t *data(uint64_t pos, size_t numBytes) const;
+
+  // Consumer: done with the range at 'pos' and all ranges before it (false,
+  // and nothing is released, if the range is not valid)
+  bool release(uint64_t pos, size_t numBytes);
+
+ private:
+  struct Header;
+
+  Header *header{nullptr};
+  uint8_t *ringData{nullptr};
+  size_t mappedSize{0};
+  // Copy of the header's capacity, which the other process could overwrite
+  size_t ringCapacity{0};
+  std::string name;
+  bool owner{false};
+  // Producer only: end of the last range reserved
+  uint64_t head{0};
+};
+
+// Unique name for new segments of this process
+std::string makeSharedMemoryName();
+
+} // namespace remote
@@ -67,6 +67,20 @@ void connection::close()
   manager_.close(shared_from_this());
 }
 
+bool connection::is_local() const
+{
+  boost::system::error_code ec;
+  auto remote = socket_.remote_endpoint(ec);
+  if (ec)
+    return false;
+  auto local = socket_.local_endpoint(ec);
+  if (ec)
+    return false;
+
+  return remote.address().is_loopback()
+      || remote.address() == local.address();
+}
+
 void connection::write(message_pointer message)
 {
   manager_.write(message, shared_from_this());
@@ -71,6 +71,9 @@ class connection : public std::enable_shared_from_this<connection>
   // Close the connection
   void close();
 
+  // Returns whether the other side runs on the same host
+  bool is_local() const;
+
   // Sends a message to the other side.
   void write(message_pointer message);
 
@@ -39,7 +39,7 @@ connection_manager::connection_manager()
       acceptor_(io_context_),
       work_(boost::asio::make_work_guard(io_context_)),
       connections_(),
-      write_queue_()
+      write_queues_()
 {}
 
 connection_manager::connection_manager(unsigned short port)
@@ -47,7 +47,7 @@ connection_manager::connection_manager(unsigned short port)
       acceptor_(io_context_, tcp::endpoint(tcp::v6(), port)),
       work_(boost::asio::make_work_guard(io_context_)),
       connections_(),
-      write_queue_()
+      write_queues_()
 {}
 
 connection_manager::~connection_manager()
@@ -350,42 +350,45 @@ void connection_manager::write(message_pointer msg, connection_pointer conn)
 
 void connection_manager::do_write(message_pointer msg, connection_pointer conn)
 {
-  write_queue_.push_back(std::make_pair(conn, msg));
+  // Every connection has its own queue, so a slow peer doesn't hold back
+  // the others
+  messages &queue = write_queues_[conn];
+  queue.push_back(msg);
 
-  if (write_queue_.size() == 1) {
-    do_write_0();
+  if (queue.size() == 1) {
+    do_write_0(conn);
   }
 }
 
-void connection_manager::do_write_0()
+void connection_manager::do_write_0(connection_pointer conn)
 {
   // Get the next message from the queue
-  std::pair<connection_pointer, message_pointer> msg = write_queue_.front();
+  message_pointer msg = write_queues_[conn].front();
 
   //
   // TODO:
   // Need to serialize the message-header!
   //
 
-  assert(msg.second->header_.size_ != 0);
-  assert(msg.second->header_.size_ == msg.second->data_.size());
+  assert(msg->header_.size_ != 0);
+  assert(msg->header_.size_ == msg->data_.size());
 
   // Send the header and the data in a single write operation.
   std::vector<boost::asio::const_buffer> buffers;
 
-  buffers.push_back(boost::asio::const_buffer(
-      &msg.second->header_, sizeof(msg.second->header_)));
-  buffers.push_back(boost::asio::const_buffer(
-      &msg.second->data_[0], msg.second->data_.size()));
+  buffers.push_back(
+      boost::asio::const_buffer(&msg->header_, sizeof(msg->header_)));
+  buffers.push_back(
+      boost::asio::const_buffer(&msg->data_[0], msg->data_.size()));
 
   // Start the write operation.
-  boost::asio::async_write(msg.first->socket_,
+  boost::asio::async_write(conn->socket_,
       buffers,
       boost::bind(&connection_manager::handle_write,
           this,
           boost::asio::placeholders::error,
-          msg.second,
-          msg.first));
+          msg,
+          conn));
 }
 
 void connection_manager::handle_write(boost::system::error_code const &e,
@@ -396,25 +399,34 @@ void connection_manager::handle_write(boost::system::error_code const &e,
   conn->signal_(connection::Write, message, e);
 
   // Remove the message from the queue
-  write_queue_.pop_front();
+  auto it = write_queues_.find(conn);
+  it->second.pop_front();
 
   if (!e) {
     // Message successfully sent.
     // Send the next one -- if any.
-    if (!write_queue_.empty()) {
-      do_write_0();
+    if (!it->second.empty()) {
+      do_write_0(conn);
+    } else {
+      write_queues_.erase(it);
     }
   } else {
 #ifndef NDEBUG
     printf("connection_manager::handle_write: %s", e.message().c_str());
 #endif
 
+    write_queues_.erase(it);
     remove_connection(conn);
   }
 }
 
 void connection_manager::add_connection(connection_pointer conn)
 {
+  // Messages are small and often answered right away; don't hold them back
+  // waiting for the ACK of the previous one (Nagle's algorithm)
+  boost::system::error_code ignored;
+  conn->socket_.set_option(tcp::no_delay(true), ignored);
+
   // Save the connection
   connections_.insert(conn);
 
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <deque>
+#include <map>
 #include <set>
 #include <thread>
 #include <vector>
@@ -105,8 +106,8 @@ class connection_manager
   // Starts a new write operation.
   void do_write(message_pointer msg, connection_pointer conn);
 
-  // Write the next message
-  void do_write_0();
+  // Write the next message of the given connection
+  void do_write_0(connection_pointer conn);
 
   // Called when a complete message is written.
   void handle_write(boost::system::error_code const &e,
@@ -121,7 +122,7 @@ class connection_manager
 
  private:
   using connections = std::set<connection_pointer>;
-  using messages = std::deque<std::pair<connection_pointer, message_pointer>>;
+  using messages = std::deque<message_pointer>;
 
   // The IO context
   boost::asio::io_context io_context_;
@@ -131,8 +132,8 @@ class connection_manager
   boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
   // The list of active connections
   connections connections_;
-  // List of messages to be written
-  messages write_queue_;
+  // Lists of messages to be written, per connection
+  std::map<connection_pointer, messages> write_queues_;
   // A thread to process the message queue
   std::thread runner_;
 };
@@ -49,6 +49,62 @@ struct MessageType
     ParameterInfo,
     ChannelColor,
     ChannelDepth,
+    Batch,
+  };
+};
+
+// Batch messages carry several small messages (setting parameters, commits,
+// releases, ...) the client sent without waiting for a reply, to be handled
+// in order, each one as:
+//   uint32 type, uint32 size, payload
+
+// Payload encoding of ArrayData messages, which stream array contents
+// from client to server in chunks of whole elements:
+//   ObjectDesc, uint64 offset, uint64 numBytes, uint32 encoding,
+//   [uint64 compressedSize,] payload
+struct ArrayDataEncoding
+{
+  enum : uint32_t
+  {
+    Raw = 0,
+    SNAPPY = (1 << 0),
+    // Payload is XOR'ed against the contents the server array already holds
+    XOR = (1 << 1),
+    // Payload is the uint64 position of the numBytes bytes in the client's
+    // shared memory ring (see SharedRing)
+    SharedMemory = (1 << 2),
+  };
+};
+
+// ChannelColor and ChannelDepth messages each carry a rectangle (usually a
+// horizontal stripe) of the image, so rectangles can be encoded in parallel
+// and decoded on arrival:
+//   Handle frame, uint32 width, uint32 height, ANARIDataType type,
+//   uint32 firstRow, uint32 numRows, uint32 firstColumn, uint32 numColumns,
+//   uint32 flags, uint32 encoding, [uint32 compressedSize,] payload
+struct ChannelEncoding
+{
+  enum : uint32_t
+  {
+    Raw,
+    // TurboJPEG for color, SNAPPY for depth
+    Compressed,
+    // compressFloatDepth(), for depth
+    FloatDepth,
+    // Payload is the uint64 position of the (tightly packed) rectangle in the
+    // server's shared memory ring
+    SharedMemory,
+  };
+};
+
+struct ChannelFlags
+{
+  enum : uint32_t
+  {
+    // The rectangle updates the previous frame; pixels of that frame not
+    // covered by any rectangle are unchanged (an empty rectangle can be sent
+    // if nothing changed at all)
+    Delta = (1 << 0),
   };
 };
 
@@ -111,6 +167,8 @@ inline const char *toString(unsigned mt)
     return "CannelColor";
   case MessageType::ChannelDepth:
     return "ChannelDepth";
+  case MessageType::Batch:
+    return "Batch";
   default:
     return "Unknown";
   }
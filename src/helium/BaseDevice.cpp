@@ -6,9 +6,48 @@
 #include "array/Array.h"
 // anari
 #include "anari/backend/LibraryImpl.h"
+#include "anari/ext/anari_batch.h"
+// std
+#include <algorithm>
+#include <string_view>
+#include <vector>
 
 namespace helium {
 
+// Entry points returned by getProcAddress() //////////////////////////////////
+
+static BaseDevice &deviceFromHandle(ANARIDevice d)
+{
+  return static_cast<BaseDevice &>(*(anari::DeviceImpl *)d);
+}
+
+static void batchNewObjects(ANARIDevice d,
+    ANARIDataType type,
+    const char *subtype,
+    uint64_t count,
+    ANARIObject *objects)
+{
+  deviceFromHandle(d).newObjects(type, subtype, count, objects);
+}
+
+static void batchSetParameter(ANARIDevice d,
+    const ANARIObject *objects,
+    uint64_t count,
+    const char *name,
+    ANARIDataType type,
+    const void *mem,
+    uint64_t byteStride)
+{
+  deviceFromHandle(d).setParameterBatch(
+      objects, count, name, type, mem, byteStride);
+}
+
+static void batchCommitParameters(
+    ANARIDevice d, const ANARIObject *objects, uint64_t count)
+{
+  deviceFromHandle(d).commitParametersBatch(objects, count);
+}
+
 // Data Arrays ////////////////////////////////////////////////////////////////
 
 void *BaseDevice::mapArray(ANARIArray a)
@@ -48,26 +87,42 @@ int BaseDevice::getProperty(ANARIObject object,
 void BaseDevice::setParameter(
     ANARIObject object, const char *name, ANARIDataType type, const void *mem)
 {
-  auto lock = getObjectLock(object);
-
   if (handleIsDevice(object)) {
+    auto lock = getObjectLock(object);
     deviceSetParameter(name, type, mem);
-    return;
-  }
-
-  bool valueChanged = false;
-  auto &o = referenceFromHandle(object);
-  if (anari::isObject(type) && mem == nullptr)
-    valueChanged = o.removeParam(name);
-  else
-    valueChanged = o.setParam(name, type, mem);
+  } else
+    setObjectParameter(object, StringAtom(name), type, mem);
+}
 
-  if (valueChanged)
-    o.markParameterChanged();
+void BaseDevice::setParameterBatch(const ANARIObject *objects,
+    uint64_t count,
+    const char *name,
+    ANARIDataType type,
+    const void *mem,
+    uint64_t byteStride)
+{
+  // The name is only looked up once for the whole batch
+  const StringAtom atom(name);
+
+  for (uint64_t i = 0; i < count; i++) {
+    const void *value = (const uint8_t *)mem + i * byteStride;
+    if (type == ANARI_STRING)
+      value = *(const char *const *)value;
+
+    if (handleIsDevice(objects[i]))
+      setParameter(objects[i], name, type, value);
+    else
+      setObjectParameter(objects[i], atom, type, value);
+  }
 }
 
 void BaseDevice::unsetParameter(ANARIObject o, const char *name)
 {
+  if (auto *log = stagedParameterLog(o); log) {
+    log->removeParam(&referenceFromHandle(o), StringAtom(name));
+    return;
+  }
+
   auto lock = getObjectLock(o);
 
   if (handleIsDevice(o))
@@ -81,6 +136,11 @@ void BaseDevice::unsetParameter(ANARIObject o, const char *name)
 
 void BaseDevice::unsetAllParameters(ANARIObject o)
 {
+  if (auto *log = stagedParameterLog(o); log) {
+    log->removeAllParams(&referenceFromHandle(o));
+    return;
+  }
+
   auto lock = getObjectLock(o);
 
   if (handleIsDevice(o))
@@ -143,6 +203,10 @@ void *BaseDevice::mapParameterArray3D(ANARIObject o,
 
 void BaseDevice::unmapParameterArray(ANARIObject o, const char *name)
 {
+  // The array may have only been staged as a parameter so far
+  if (stagedParameterLog(o))
+    m_state->commitBuffer.applyStagedParameters();
+
   auto lock = getObjectLock(o);
 
   auto *obj = (BaseObject *)o;
@@ -161,6 +225,21 @@ void BaseDevice::commitParameters(ANARIObject o)
   }
 }
 
+void BaseDevice::commitParametersBatch(
+    const ANARIObject *objects, uint64_t count)
+{
+  std::vector<BaseObject *> toCommit;
+  toCommit.reserve(count);
+  for (uint64_t i = 0; i < count; i++) {
+    if (handleIsDevice(objects[i]))
+      commitParameters(objects[i]);
+    else if (objects[i] != nullptr)
+      toCommit.push_back((BaseObject *)objects[i]);
+  }
+
+  m_state->commitBuffer.addObjectsToCommit(toCommit.data(), toCommit.size());
+}
+
 void BaseDevice::release(ANARIObject o)
 {
   if (o == nullptr)
@@ -232,6 +311,79 @@ void BaseDevice::discardFrame(ANARIFrame f)
   referenceFromHandle<BaseFrame>(f).discard();
 }
 
+// Extensions /////////////////////////////////////////////////////////////////
+
+void (*BaseDevice::getProcAddress(const char *name))(void)
+{
+  const std::string_view fcn = name ? name : "";
+  if (fcn == "anariNewObjects")
+    return (void (*)(void))batchNewObjects;
+  else if (fcn == "anariSetParameterBatch")
+    return (void (*)(void))batchSetParameter;
+  else if (fcn == "anariCommitParametersBatch")
+    return (void (*)(void))batchCommitParameters;
+  return nullptr;
+}
+
+void BaseDevice::newObjects(ANARIDataType type,
+    const char *subtype,
+    uint64_t count,
+    ANARIObject *objects)
+{
+  auto create = [&](auto newObject) {
+    for (uint64_t i = 0; i < count; i++)
+      objects[i] = newObject();
+  };
+
+  switch (type) {
+  case ANARI_CAMERA:
+    create([&]() { return newCamera(subtype); });
+    break;
+  case ANARI_FRAME:
+    create([&]() { return newFrame(); });
+    break;
+  case ANARI_GEOMETRY:
+    create([&]() { return newGeometry(subtype); });
+    break;
+  case ANARI_GROUP:
+    create([&]() { return newGroup(); });
+    break;
+  case ANARI_INSTANCE:
+    create([&]() { return newInstance(subtype); });
+    break;
+  case ANARI_LIGHT:
+    create([&]() { return newLight(subtype); });
+    break;
+  case ANARI_MATERIAL:
+    create([&]() { return newMaterial(subtype); });
+    break;
+  case ANARI_RENDERER:
+    create([&]() { return newRenderer(subtype); });
+    break;
+  case ANARI_SAMPLER:
+    create([&]() { return newSampler(subtype); });
+    break;
+  case ANARI_SPATIAL_FIELD:
+    create([&]() { return newSpatialField(subtype); });
+    break;
+  case ANARI_SURFACE:
+    create([&]() { return newSurface(); });
+    break;
+  case ANARI_VOLUME:
+    create([&]() { return newVolume(subtype); });
+    break;
+  case ANARI_WORLD:
+    create([&]() { return newWorld(); });
+    break;
+  default:
+    reportMessage(ANARI_SEVERITY_ERROR,
+        "anariNewObjects() cannot create objects of type %s",
+        anari::toString(type));
+    std::fill(objects, objects + count, nullptr);
+    break;
+  }
+}
+
 // Other BaseDevice definitions ///////////////////////////////////////////////
 
 BaseDevice::BaseDevice(ANARIStatusCallback defaultCallback, const void *userPtr)
@@ -311,6 +463,39 @@ void BaseDevice::deviceUnsetAllParameters()
   removeAllParams();
 }
 
+void BaseDevice::setObjectParameter(
+    ANARIObject object, StringAtom name, ANARIDataType type, const void *mem)
+{
+  auto &o = referenceFromHandle(object);
+  const bool remove = anari::isObject(type) && mem == nullptr;
+
+  if (auto *log = stagedParameterLog(object); log) {
+    if (remove)
+      log->removeParam(&o, name);
+    else
+      log->setParam(&o, name, type, mem);
+    return;
+  }
+
+  auto lock = getObjectLock(object);
+
+  bool valueChanged = false;
+  if (remove)
+    valueChanged = o.removeParam(name);
+  else
+    valueChanged = o.setParam(name, type, mem);
+
+  if (valueChanged)
+    o.markParameterChanged();
+}
+
+StagedParameterLog *BaseDevice::stagedParameterLog(ANARIObject object)
+{
+  if (handleIsDevice(object) || !m_state->commitBuffer.parameterStaging())
+    return nullptr;
+  return &m_state->commitBuffer.stagedParameters();
+}
+
 std::scoped_lock<std::mutex> BaseDevice::getObjectLock(ANARIObject object)
 {
   if (handleIsDevice(object))
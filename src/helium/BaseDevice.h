@@ -35,6 +35,14 @@ struct BaseDevice : public anari::DeviceImpl,
       ANARIDataType type,
       const void *mem) override;
 
+  // anariSetParameterBatch() from anari/ext/anari_batch.h
+  void setParameterBatch(const ANARIObject *objects,
+      uint64_t count,
+      const char *name,
+      ANARIDataType type,
+      const void *mem,
+      uint64_t byteStride);
+
   void unsetParameter(ANARIObject o, const char *name) override;
   void unsetAllParameters(ANARIObject o) override;
 
@@ -59,6 +67,8 @@ struct BaseDevice : public anari::DeviceImpl,
   void unmapParameterArray(ANARIObject o, const char *name) override;
 
   void commitParameters(ANARIObject o) override;
+  // anariCommitParametersBatch() from anari/ext/anari_batch.h
+  void commitParametersBatch(const ANARIObject *objects, uint64_t count);
 
   void release(ANARIObject o) override;
   void retain(ANARIObject o) override;
@@ -79,6 +89,18 @@ struct BaseDevice : public anari::DeviceImpl,
   int frameReady(ANARIFrame f, ANARIWaitMask m) override;
   void discardFrame(ANARIFrame f) override;
 
+  // Extensions ///////////////////////////////////////////////////////////////
+
+  // Return the functions of anari/ext/anari_batch.h
+  void (*getProcAddress(const char *name))(void) override;
+
+  // anariNewObjects() from anari/ext/anari_batch.h, which picks the function
+  // creating 'type' objects once for the whole batch
+  virtual void newObjects(ANARIDataType type,
+      const char *subtype,
+      uint64_t count,
+      ANARIObject *objects);
+
   /////////////////////////////////////////////////////////////////////////////
   // Helper/other functions and data members
   /////////////////////////////////////////////////////////////////////////////
@@ -101,6 +123,14 @@ struct BaseDevice : public anari::DeviceImpl,
  private:
   std::scoped_lock<std::mutex> getObjectLock(ANARIObject object);
 
+  // Set a parameter on an object which is not the device
+  void setObjectParameter(
+      ANARIObject object, StringAtom name, ANARIDataType type, const void *mem);
+
+  // Return where to stage parameter writes to 'object', or null if they are
+  // applied immediately
+  StagedParameterLog *stagedParameterLog(ANARIObject object);
+
   void deviceGetProperty(const char *id, ANARIDataType type, const void *mem);
   void deviceSetParameter(const char *id, ANARIDataType type, const void *mem);
   void deviceUnsetParameter(const char *id);
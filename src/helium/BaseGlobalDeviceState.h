@@ -4,12 +4,14 @@
 #pragma once
 
 #include "utility/DeferredCommitBuffer.h"
+#include "utility/ObjectArena.h"
 // anari
 #include <anari/anari_cpp/ext/linalg.h>
 #include <anari/anari_cpp.hpp>
 // std
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -18,15 +20,38 @@ namespace helium {
 using namespace linalg::aliases;
 using mat4 = anari::math::float4x4;
 
+// How shared arrays (memory owned by the application) are handled when the
+// application releases them while they are still in use by other objects
+enum class SharedArrayPrivatization
+{
+  // Copy the part of the array which is in use (default)
+  COPY_ON_RELEASE,
+  // Never copy, as the application guarantees that the memory of every shared
+  // array stays valid and unmodified until the device is released
+  NEVER
+};
+
 struct BaseGlobalDeviceState
 {
+  // Memory for objects created with 'new (state) T(...)', which is plain heap
+  // memory when not set. Set this before creating any objects: it is declared
+  // first so it outlives every object released when the state is destroyed.
+  std::unique_ptr<ObjectArena> objectArena;
+
   DeferredCommitBuffer commitBuffer;
 
   // Data //
 
+  SharedArrayPrivatization sharedArrayPrivatization{
+      SharedArrayPrivatization::COPY_ON_RELEASE};
+
   ANARIStatusCallback statusCB{nullptr};
   const void *statusCBUserPtr{nullptr};
 
+  // NOTE: called from several threads at once while objects are finalized in
+  //       parallel (see DeferredCommitBuffer::setNumFinalizationThreads()).
+  //       No helium lock is held, so the status callback may call back into
+  //       the device.
   std::function<void(int, const std::string &, anari::DataType, const void *)>
       messageFunction;
 
@@ -34,7 +59,6 @@ struct BaseGlobalDeviceState
   virtual ~BaseGlobalDeviceState() = default;
 
  private:
-
   friend struct BaseObject;
   friend struct BaseDevice;
   friend struct Array;
@@ -3,30 +3,72 @@
 
 #include "BaseObject.h"
 // std
+#include <algorithm>
 #include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 
 namespace helium {
 
 // Helper functions ///////////////////////////////////////////////////////////
 
+// Placed right in front of every object to find where to return its memory
+struct alignas(std::max_align_t) ObjectAllocationHeader
+{
+  ObjectArena *arena{nullptr};
+  uint32_t size{0}; // of the whole allocation
+  uint32_t offset{0}; // from the start of the allocation to the object
+};
+
+static void *allocateObject(
+    size_t size, size_t alignment, BaseGlobalDeviceState *state)
+{
+  // Allocations are aligned at least as strictly as the header, so stricter
+  // alignments are reached by moving the object (and header) further in
+  alignment = std::max(alignment, alignof(ObjectAllocationHeader));
+  const size_t headerSpace =
+      (sizeof(ObjectAllocationHeader) + alignment - 1) & ~(alignment - 1);
+  const size_t allocationSize =
+      headerSpace + size + (alignment - alignof(ObjectAllocationHeader));
+
+  auto *arena = state ? state->objectArena.get() : nullptr;
+  void *block = arena ? arena->allocate(allocationSize)
+                      : ::operator new(allocationSize);
+
+  auto object = (uintptr_t(block) + headerSpace + alignment - 1)
+      & ~uintptr_t(alignment - 1);
+  auto *header = new ((ObjectAllocationHeader *)object - 1)
+      ObjectAllocationHeader;
+  header->arena = arena;
+  header->size = uint32_t(allocationSize);
+  header->offset = uint32_t(object - uintptr_t(block));
+  return (void *)object;
+}
+
 int commitPriority(ANARIDataType type)
 {
   switch (type) {
   case ANARI_FRAME:
-    return 6;
+    return 7;
   case ANARI_WORLD:
-    return 5;
+    return 6;
   case ANARI_INSTANCE:
-    return 4;
+    return 5;
   case ANARI_GROUP:
-    return 3;
+    return 4;
   case ANARI_SURFACE:
   case ANARI_VOLUME:
-    return 2;
+    return 3;
   case ANARI_MATERIAL:
-    return 1;
-  default:
+    return 2;
+  case ANARI_ARRAY:
+  case ANARI_ARRAY1D:
+  case ANARI_ARRAY2D:
+  case ANARI_ARRAY3D:
     return 0;
+  default:
+    return 1;
   }
 }
 
@@ -47,6 +89,55 @@ std::string string_printf(const char *fmt, ...)
 
 // BaseObject definitions /////////////////////////////////////////////////////
 
+void *BaseObject::operator new(size_t size)
+{
+  return allocateObject(size, alignof(std::max_align_t), nullptr);
+}
+
+void *BaseObject::operator new(size_t size, BaseGlobalDeviceState *state)
+{
+  return allocateObject(size, alignof(std::max_align_t), state);
+}
+
+void *BaseObject::operator new(size_t size, std::align_val_t alignment)
+{
+  return allocateObject(size, size_t(alignment), nullptr);
+}
+
+void *BaseObject::operator new(
+    size_t size, std::align_val_t alignment, BaseGlobalDeviceState *state)
+{
+  return allocateObject(size, size_t(alignment), state);
+}
+
+void BaseObject::operator delete(void *ptr)
+{
+  if (!ptr)
+    return;
+  auto *header = (ObjectAllocationHeader *)ptr - 1;
+  void *block = (std::byte *)ptr - header->offset;
+  if (header->arena)
+    header->arena->deallocate(block, header->size);
+  else
+    ::operator delete(block);
+}
+
+void BaseObject::operator delete(void *ptr, BaseGlobalDeviceState *)
+{
+  operator delete(ptr);
+}
+
+void BaseObject::operator delete(void *ptr, std::align_val_t)
+{
+  operator delete(ptr);
+}
+
+void BaseObject::operator delete(
+    void *ptr, std::align_val_t, BaseGlobalDeviceState *)
+{
+  operator delete(ptr);
+}
+
 BaseObject::BaseObject(ANARIDataType type, BaseGlobalDeviceState *state)
     : m_type(type), m_state(state)
 {
@@ -108,23 +199,52 @@ void BaseObject::markFinalized()
   m_lastFinalized = newTimeStamp();
 }
 
-void BaseObject::addChangeObserver(BaseObject *obj)
+void BaseObject::addChangeObserver(BaseObject *obj, ObserverMode mode)
 {
-  m_changeObservers.push_back(obj);
+  std::lock_guard<std::mutex> guard(m_changeObserversMutex);
+  m_changeObservers.push_back({obj, mode});
 }
 
 void BaseObject::removeChangeObserver(BaseObject *obj)
 {
+  std::lock_guard<std::mutex> guard(m_changeObserversMutex);
   m_changeObservers.erase(std::remove_if(m_changeObservers.begin(),
                               m_changeObservers.end(),
-                              [&](BaseObject *o) -> bool { return o == obj; }),
+                              [&](const ChangeObserver &o) -> bool {
+                                return o.obj == obj;
+                              }),
       m_changeObservers.end());
 }
 
 void BaseObject::notifyChangeObservers() const
 {
-  for (auto o : m_changeObservers)
-    notifyChangeObserver(o);
+  // Observers run device code which may add or remove observers, or take
+  // other locks, so they are called without holding the list's lock
+  for (auto &o : changeObservers()) {
+    if (o.mode == ObserverMode::FINALIZE)
+      notifyChangeObserver(o.obj);
+  }
+}
+
+void BaseObject::markDirty(uint32_t flags)
+{
+  if (flags == 0)
+    return;
+
+  m_dirtyFlags.fetch_or(flags);
+
+  for (auto &o : changeObservers())
+    o.obj->on_DependencyDirty(this, flags);
+}
+
+uint32_t BaseObject::dirtyFlags() const
+{
+  return m_dirtyFlags.load();
+}
+
+uint32_t BaseObject::clearDirtyFlags(uint32_t flags)
+{
+  return m_dirtyFlags.fetch_and(~flags) & flags;
 }
 
 BaseGlobalDeviceState *BaseObject::deviceState() const
@@ -132,6 +252,12 @@ BaseGlobalDeviceState *BaseObject::deviceState() const
   return m_state;
 }
 
+std::vector<BaseObject::ChangeObserver> BaseObject::changeObservers() const
+{
+  std::lock_guard<std::mutex> guard(m_changeObserversMutex);
+  return m_changeObservers;
+}
+
 void BaseObject::notifyChangeObserver(BaseObject *o) const
 {
   o->markUpdated();
@@ -139,6 +265,11 @@ void BaseObject::notifyChangeObserver(BaseObject *o) const
     ds->commitBuffer.addObjectToFinalize(o);
 }
 
+void BaseObject::on_DependencyDirty(BaseObject *, uint32_t)
+{
+  // no-op
+}
+
 void BaseObject::incrementObjectCount()
 {
   auto *s = deviceState();
@@ -8,6 +8,9 @@
 // anari_cpp
 #include <anari/anari_cpp.hpp>
 // std
+#include <atomic>
+#include <mutex>
+#include <new>
 #include <string_view>
 
 #include "BaseGlobalDeviceState.h"
@@ -16,12 +19,38 @@
 
 namespace helium {
 
+// How an object added with BaseObject::addChangeObserver() follows changes
+enum class ObserverMode
+{
+  // Finalized again whenever the observed object changes, and told about
+  // dirty flags raised on it
+  FINALIZE,
+  // Only told about dirty flags raised on the observed object
+  DIRTY_FLAGS
+};
+
 struct BaseObject : public RefCounted, ParameterizedObject, LockableObject
 {
   // Construct
   BaseObject(ANARIDataType type, BaseGlobalDeviceState *state);
   virtual ~BaseObject();
 
+  // Allocate objects from the state's object arena with 'new (state) T(...)',
+  // plain 'new T(...)' always uses the heap. Over-aligned subclasses get
+  // memory aligned as they require either way.
+  static void *operator new(size_t size);
+  static void *operator new(size_t size, BaseGlobalDeviceState *state);
+  static void *operator new(size_t size, std::align_val_t alignment);
+  static void *operator new(size_t size,
+      std::align_val_t alignment,
+      BaseGlobalDeviceState *state);
+  static void operator delete(void *ptr);
+  static void operator delete(void *ptr, BaseGlobalDeviceState *state);
+  static void operator delete(void *ptr, std::align_val_t alignment);
+  static void operator delete(void *ptr,
+      std::align_val_t alignment,
+      BaseGlobalDeviceState *state);
+
   // Base hook for devices to check if the object is valid to use, whatever that
   // means. Devices must be able to handle object subtypes that it does not
   // implement, or handle cases when objects are ill-formed. This gives a
@@ -76,10 +105,22 @@ struct BaseObject : public RefCounted, ParameterizedObject, LockableObject
   // Allow other objects to "listen" for when this object changes. By default
   // listening objects are put into the commit buffer so they are committed
   // again next frame.
-  void addChangeObserver(BaseObject *obj);
+  void addChangeObserver(
+      BaseObject *obj, ObserverMode mode = ObserverMode::FINALIZE);
   void removeChangeObserver(BaseObject *obj);
   void notifyChangeObservers() const;
 
+  // Raise device-defined 'flags' describing what about this object changed.
+  // Every change observer is handed the flags through on_DependencyDirty(),
+  // where it can raise flags of its own to pass the change further up. This
+  // lets devices follow a change to exactly the objects it affects, so the
+  // cost of an update follows the size of the change rather than the scene.
+  void markDirty(uint32_t flags);
+  uint32_t dirtyFlags() const;
+
+  // Clear 'flags', returning which of them were set
+  uint32_t clearDirtyFlags(uint32_t flags = ~0u);
+
   BaseGlobalDeviceState *deviceState() const;
 
  protected:
@@ -89,21 +130,45 @@ struct BaseObject : public RefCounted, ParameterizedObject, LockableObject
   // frame).
   virtual void notifyChangeObserver(BaseObject *obj) const;
 
+  // Handle 'flags' being raised on 'dependency', which this object observes.
+  // Default behavior is to ignore them.
+  virtual void on_DependencyDirty(BaseObject *dependency, uint32_t flags);
+
   BaseGlobalDeviceState *m_state{nullptr};
 
  private:
   void incrementObjectCount();
   void decrementObjectCount();
 
-  std::vector<BaseObject *> m_changeObservers;
+  // NOTE: observers may be notified from several threads while the commit
+  //       buffer finalizes objects in parallel
+  struct ChangeObserver
+  {
+    BaseObject *obj{nullptr};
+    ObserverMode mode{ObserverMode::FINALIZE};
+  };
+  // Copy of the observer list, taken under its lock
+  std::vector<ChangeObserver> changeObservers() const;
+
+  std::vector<ChangeObserver> m_changeObservers;
+  mutable std::mutex m_changeObserversMutex;
+  std::atomic<uint32_t> m_dirtyFlags{0};
   TimeStamp m_lastParameterChanged{0};
-  TimeStamp m_lastUpdated{0};
+  std::atomic<TimeStamp> m_lastUpdated{0};
   TimeStamp m_lastCommitted{0};
   TimeStamp m_lastFinalized{0};
   ANARIDataType m_type{ANARI_OBJECT};
+
+  // Bookkeeping owned by the commit buffer and guarded by its locks: the
+  // buffer epoch in which this object was last referenced by the buffer, and
+  // whether it is queued for commit and/or finalization in that epoch
+  friend struct DeferredCommitBuffer;
+  uint64_t m_commitBufferState{0};
 };
 
-// Return a value to correctly order object by type in the commit buffer
+// Return a value to correctly order object by type in the commit buffer.
+// Objects only read objects of a lower priority when they are finalized
+// (e.g. geometries read their arrays), so arrays have a level of their own.
 int commitPriority(ANARIDataType type);
 
 std::string string_printf(const char *fmt, ...);
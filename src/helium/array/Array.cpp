@@ -145,20 +145,41 @@ void Array::finalize()
 }
 
 void Array::makePrivatizedCopy(size_t numElements)
+{
+  makePrivatizedCopy(numElements, 0, numElements);
+}
+
+void Array::makePrivatizedCopy(
+    size_t numElements, size_t beginElement, size_t endElement)
 {
   if (ownership() != ArrayDataOwnership::SHARED)
     return;
 
   if (!anari::isObject(elementType())) {
+    const size_t elementSize = anari::sizeOf(elementType());
+    const size_t numCopiedBytes = (endElement - beginElement) * elementSize;
+
     reportMessage(ANARI_SEVERITY_PERFORMANCE_WARNING,
-        "making private copy of shared array (type '%s') | ownership: (%i:%i)",
+        "making private copy of shared array (type '%s', %zu bytes) | "
+        "ownership: (%i:%i)",
         anari::toString(elementType()),
+        numCopiedBytes,
         this->useCount(helium::RefType::PUBLIC),
         this->useCount(helium::RefType::INTERNAL));
 
-    size_t numBytes = numElements * anari::sizeOf(elementType());
-    m_hostData.privatized.mem = malloc(numBytes);
-    std::memcpy(m_hostData.privatized.mem, m_hostData.shared.mem, numBytes);
+    // Elements outside of the copied range are zeroed rather than left
+    // uninitialized
+    const size_t offset = beginElement * elementSize;
+    const size_t numBytes = numElements * elementSize;
+    auto *mem = (uint8_t *)malloc(numBytes);
+    std::memset(mem, 0, offset);
+    std::memcpy(mem + offset,
+        (const uint8_t *)m_hostData.shared.mem + offset,
+        numCopiedBytes);
+    std::memset(mem + offset + numCopiedBytes,
+        0,
+        numBytes - offset - numCopiedBytes);
+    m_hostData.privatized.mem = mem;
   }
 
   m_privatized = true;
@@ -197,9 +218,19 @@ void Array::initManagedMemory()
 
 void Array::on_NoPublicReferences()
 {
+  if (wasPrivatized() || ownership() == ArrayDataOwnership::MANAGED)
+    return;
+
+  auto *s = deviceState();
+  if (ownership() == ArrayDataOwnership::SHARED && s
+      && s->sharedArrayPrivatization == SharedArrayPrivatization::NEVER) {
+    reportMessage(ANARI_SEVERITY_DEBUG,
+        "keeping released shared array in application memory");
+    return;
+  }
+
   reportMessage(ANARI_SEVERITY_DEBUG, "privatizing array");
-  if (!wasPrivatized() && ownership() != ArrayDataOwnership::MANAGED)
-    privatize();
+  privatize();
 }
 
 } // namespace helium
@@ -86,7 +86,12 @@ struct Array : public BaseArray
  protected:
   virtual void privatize() override = 0;
 
+  // Copy the array into device memory, where only the elements in
+  // [beginElement, endElement) are copied when a range is given -- elements
+  // outside of it are zeroed
   void makePrivatizedCopy(size_t numElements);
+  void makePrivatizedCopy(
+      size_t numElements, size_t beginElement, size_t endElement);
   void freeAppMemory();
   void initManagedMemory();
 
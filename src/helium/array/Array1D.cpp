@@ -5,19 +5,43 @@
 
 namespace helium {
 
+namespace param {
+static const StringAtom begin("begin");
+static const StringAtom end("end");
+static const StringAtom modifiedRegion("modifiedRegion");
+static const StringAtom region("region");
+} // namespace param
+
 Array1D::Array1D(BaseGlobalDeviceState *state, const Array1DMemoryDescriptor &d)
     : Array(ANARI_ARRAY1D, state, d), m_capacity(d.numItems), m_end(d.numItems)
 {
   initManagedMemory();
+  m_modified.end = m_capacity;
 }
 
 void Array1D::commitParameters()
 {
-  m_begin = getParam<size_t>("begin", 0);
+  const auto lastBegin = m_begin;
+  const auto lastEnd = m_end;
+
+  uint64_t region[2];
+  if (getParam(param::region, ANARI_UINT64_REGION1, region)) {
+    m_begin = region[0];
+    m_end = region[1];
+  } else {
+    m_begin = getParam<size_t>(param::begin, 0);
+    m_end = getParam<size_t>(param::end, m_capacity);
+  }
   m_begin = std::clamp(m_begin, size_t(0), m_capacity - 1);
-  m_end = getParam<size_t>("end", m_capacity);
   m_end = std::clamp(m_end, size_t(1), m_capacity);
 
+  // 'modifiedRegion' only describes writes made since the last commit, so it
+  // is consumed here rather than kept for later commits
+  m_hasModifiedRegionParam = getParam(
+      param::modifiedRegion, ANARI_UINT64_REGION1, m_modifiedRegionParam);
+  if (m_hasModifiedRegionParam)
+    removeParam(param::modifiedRegion);
+
   if (size() == 0) {
     reportMessage(ANARI_SEVERITY_ERROR, "array size must be greater than zero");
     return;
@@ -28,12 +52,64 @@ void Array1D::commitParameters()
         "array 'begin' is not less than 'end', swapping values");
     std::swap(m_begin, m_end);
   }
+
+  // Only the region in use when the array was privatized was copied
+  if (wasPrivatized()
+      && (m_begin < m_privatizedBegin || m_end > m_privatizedEnd)) {
+    reportMessage(ANARI_SEVERITY_ERROR,
+        "cannot move the region of a privatized array past [%zu, %zu), "
+        "keeping [%zu, %zu)",
+        m_privatizedBegin,
+        m_privatizedEnd,
+        lastBegin,
+        lastEnd);
+    m_begin = lastBegin;
+    m_end = lastEnd;
+  }
+
+  m_activeRegionChanged = m_begin != lastBegin || m_end != lastEnd;
 }
 
 void Array1D::finalize()
 {
-  markDataModified();
-  notifyChangeObservers();
+  if (!m_hasModifiedRegionParam || m_activeRegionChanged)
+    markRegionModified(0, m_capacity);
+  else {
+    const auto begin = std::min(size_t(m_modifiedRegionParam[0]), m_capacity);
+    const auto end = std::clamp(
+        size_t(m_modifiedRegionParam[1]), begin, m_capacity);
+    if (m_unmappedSinceFinalize) {
+      // Observers were already notified when the array was unmapped, so only
+      // narrow down what that unmap marked as modified
+      m_modified.since = m_lastModifiedBeforeUnmap;
+      m_modified.begin = begin;
+      m_modified.end = end;
+    } else
+      markRegionModified(begin, end);
+  }
+
+  m_hasModifiedRegionParam = false;
+  m_activeRegionChanged = false;
+  m_unmappedSinceFinalize = false;
+}
+
+void Array1D::unmap()
+{
+  if (!isMapped()) {
+    Array::unmap();
+    return;
+  }
+
+  if (!m_unmappedSinceFinalize) {
+    m_lastModifiedBeforeUnmap = m_lastDataModified;
+    m_unmappedSinceFinalize = true;
+  }
+
+  const auto lastModified = m_lastDataModified;
+  Array::unmap();
+  m_modified.since = lastModified;
+  m_modified.begin = 0;
+  m_modified.end = m_capacity;
 }
 
 size_t Array1D::totalSize() const
@@ -65,6 +141,18 @@ size_t Array1D::size() const
   return m_end - m_begin;
 }
 
+std::pair<size_t, size_t> Array1D::modifiedRangeSince(TimeStamp since) const
+{
+  if (since >= m_lastDataModified)
+    return {0, 0};
+  else if (since < m_modified.since)
+    return {0, size()};
+
+  const auto begin = std::clamp(m_modified.begin, m_begin, m_end);
+  const auto end = std::clamp(m_modified.end, begin, m_end);
+  return {begin - m_begin, end - m_begin};
+}
+
 float4 Array1D::readAsAttributeValue(int32_t i, WrapMode wrap) const
 {
   const auto idx = calculateWrapIndex(i, size(), wrap);
@@ -73,7 +161,20 @@ float4 Array1D::readAsAttributeValue(int32_t i, WrapMode wrap) const
 
 void Array1D::privatize()
 {
-  makePrivatizedCopy(size());
+  // Only the [begin, end) region can be read through this array, but element
+  // indices stay relative to the whole capacity
+  makePrivatizedCopy(m_capacity, m_begin, m_end);
+  m_privatizedBegin = m_begin;
+  m_privatizedEnd = m_end;
+}
+
+void Array1D::markRegionModified(size_t begin, size_t end)
+{
+  m_modified.since = m_lastDataModified;
+  markDataModified();
+  m_modified.begin = begin;
+  m_modified.end = end;
+  notifyChangeObservers();
 }
 
 float4 readAttributeValue(const Array1D *arr, uint32_t i, const float4 &d)
@@ -4,6 +4,8 @@
 #pragma once
 
 #include "Array.h"
+// std
+#include <utility>
 
 namespace helium {
 
@@ -19,6 +21,8 @@ struct Array1D : public Array
   void commitParameters() override;
   void finalize() override;
 
+  void unmap() override;
+
   size_t totalSize() const override;
   size_t totalCapacity() const override;
 
@@ -32,6 +36,12 @@ struct Array1D : public Array
 
   size_t size() const;
 
+  // Return the range of elements in [begin(), end()) which may have been
+  // modified since 'since', as indices relative to begin(). The range is empty
+  // if nothing changed and covers the whole array if changes since 'since'
+  // are not known more precisely.
+  std::pair<size_t, size_t> modifiedRangeSince(TimeStamp since) const;
+
   template <typename T>
   const T *valueAt(size_t i) const;
 
@@ -49,6 +59,28 @@ struct Array1D : public Array
 
  private:
   void privatize() override;
+  void markRegionModified(size_t begin, size_t end);
+
+  // Region copied by privatize(), which later regions must stay within
+  size_t m_privatizedBegin{0};
+  size_t m_privatizedEnd{0};
+
+  // Every change made to the data after 'since' lies in [begin, end), given
+  // as indices into the whole capacity
+  struct ModifiedRegion
+  {
+    TimeStamp since{0};
+    size_t begin{0};
+    size_t end{0};
+  } m_modified;
+
+  // State gathered by commitParameters() and consumed by finalize()
+  bool m_activeRegionChanged{false};
+  bool m_hasModifiedRegionParam{false};
+  uint64_t m_modifiedRegionParam[2]{0, 0};
+
+  bool m_unmappedSinceFinalize{false};
+  TimeStamp m_lastModifiedBeforeUnmap{0};
 };
 
 anari::math::float4 readAttributeValue(const Array1D *arr,
@@ -5,6 +5,12 @@
 
 namespace helium {
 
+namespace param {
+static const StringAtom begin("begin");
+static const StringAtom end("end");
+static const StringAtom region("region");
+} // namespace param
+
 // Helper functions ///////////////////////////////////////////////////////////
 
 static void refIncObject(BaseObject *obj)
@@ -39,9 +45,15 @@ ObjectArray::~ObjectArray()
 
 void ObjectArray::commitParameters()
 {
-  m_begin = getParam<size_t>("begin", 0);
+  uint64_t region[2];
+  if (getParam(param::region, ANARI_UINT64_REGION1, region)) {
+    m_begin = region[0];
+    m_end = region[1];
+  } else {
+    m_begin = getParam<size_t>(param::begin, 0);
+    m_end = getParam<size_t>(param::end, m_capacity);
+  }
   m_begin = std::clamp(m_begin, size_t(0), m_capacity - 1);
-  m_end = getParam<size_t>("end", m_capacity);
   m_end = std::clamp(m_end, size_t(1), m_capacity);
 
   if (size() == 0) {
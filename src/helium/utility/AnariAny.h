@@ -197,6 +197,8 @@ inline AnariAny::~AnariAny()
 
 inline AnariAny &AnariAny::operator=(const AnariAny &rhs)
 {
+  if (this == &rhs)
+    return *this;
   reset();
   std::memcpy(m_storage.data(), rhs.m_storage.data(), m_storage.size());
   m_string = rhs.m_string;
@@ -209,6 +211,8 @@ inline AnariAny &AnariAny::operator=(const AnariAny &rhs)
 
 inline AnariAny &AnariAny::operator=(AnariAny &&rhs)
 {
+  if (this == &rhs)
+    return *this;
   reset();
   std::memcpy(m_storage.data(), rhs.m_storage.data(), m_storage.size());
   m_string = std::move(rhs.m_string);
@@ -14,10 +14,13 @@ namespace helium {
 //   class is to pass the observing object's 'this' pointer as the 'observer'
 //   parameter in the constructor, then all assignments to it will use that
 //   object as the observer it manages on the incoming object being pointed to.
+//   The observer is installed with ObserverMode::FINALIZE unless another 'mode'
+//   is given.
 template <typename T = BaseObject>
 struct ChangeObserverPtr
 {
   ChangeObserverPtr(BaseObject *observer, T *initialPointee = nullptr);
+  ChangeObserverPtr(BaseObject *observer, ObserverMode mode);
   ~ChangeObserverPtr();
 
   ChangeObserverPtr(ChangeObserverPtr &&input);
@@ -47,6 +50,7 @@ struct ChangeObserverPtr
 
   IntrusivePtr<T> ptr;
   BaseObject *observer{nullptr};
+  ObserverMode mode{ObserverMode::FINALIZE};
 };
 
 // Inlined definitions //
@@ -58,6 +62,11 @@ inline ChangeObserverPtr<T>::ChangeObserverPtr(BaseObject *o, T *p)
   installObserver();
 }
 
+template <typename T>
+inline ChangeObserverPtr<T>::ChangeObserverPtr(BaseObject *o, ObserverMode m)
+    : observer(o), mode(m)
+{}
+
 template <typename T>
 inline ChangeObserverPtr<T>::~ChangeObserverPtr()
 {
@@ -66,7 +75,7 @@ inline ChangeObserverPtr<T>::~ChangeObserverPtr()
 
 template <typename T>
 inline ChangeObserverPtr<T>::ChangeObserverPtr(ChangeObserverPtr<T> &&input)
-    : ptr(input.ptr), observer(input.observer)
+    : ptr(input.ptr), observer(input.observer), mode(input.mode)
 {
   input.ptr = nullptr;
   input.observer = nullptr;
@@ -76,8 +85,13 @@ template <typename T>
 inline ChangeObserverPtr<T> &ChangeObserverPtr<T>::operator=(
     ChangeObserverPtr &&input)
 {
+  if (this == &input)
+    return *this;
+
+  removeObserver();
   ptr = input.ptr;
   observer = input.observer;
+  mode = input.mode;
 
   input.ptr = nullptr;
   input.observer = nullptr;
@@ -134,7 +148,7 @@ template <typename T>
 inline void ChangeObserverPtr<T>::installObserver()
 {
   if (observer && ptr)
-    ptr->addChangeObserver(observer);
+    ptr->addChangeObserver(observer, mode);
 }
 
 template <typename T>
@@ -5,11 +5,25 @@
 #include "BaseObject.h"
 // std
 #include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <thread>
 
 namespace helium {
 
 // Helper functions ///////////////////////////////////////////////////////////
 
+// Flags kept in the low bits of BaseObject::m_commitBufferState, below the
+// epoch in which they were set
+constexpr uint64_t QUEUED_FOR_COMMIT = 1;
+constexpr uint64_t QUEUED_FOR_FINALIZE = 2;
+constexpr uint64_t QUEUED_FLAGS = QUEUED_FOR_COMMIT | QUEUED_FOR_FINALIZE;
+constexpr uint64_t QUEUED_FLAG_BITS = 2;
+
+// Levels smaller than this are not worth waking up threads for
+constexpr size_t MIN_PARALLEL_LEVEL_SIZE = 128;
+constexpr size_t PARALLEL_CHUNK_SIZE = 16;
+
 template <typename T, typename FCN_T>
 static void dynamic_foreach(std::vector<T> &buffer, FCN_T &&fcn)
 {
@@ -22,6 +36,104 @@ static void dynamic_foreach(std::vector<T> &buffer, FCN_T &&fcn)
   }
 }
 
+// FinalizationThreads definitions ////////////////////////////////////////////
+
+// Worker threads kept alive across flushes, which all run the same job
+// alongside the flushing thread whenever a level is finalized in parallel
+struct FinalizationThreads
+{
+  FinalizationThreads(uint32_t numThreads);
+  ~FinalizationThreads();
+
+  // Call 'fcn(i)' for every i in [0, size) on the workers and the calling
+  // thread, returning once all calls have returned
+  template <typename FCN_T>
+  void parallel_for(size_t size, FCN_T &&fcn);
+
+ private:
+  void run(const std::function<void()> &job);
+  void workerLoop();
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_jobReady;
+  std::condition_variable m_jobDone;
+  const std::function<void()> *m_job{nullptr};
+  uint64_t m_jobCount{0};
+  uint32_t m_numRunning{0};
+  bool m_quit{false};
+};
+
+FinalizationThreads::FinalizationThreads(uint32_t numThreads)
+{
+  m_workers.reserve(numThreads - 1);
+  for (uint32_t t = 1; t < numThreads; t++)
+    m_workers.emplace_back([this]() { workerLoop(); });
+}
+
+FinalizationThreads::~FinalizationThreads()
+{
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_quit = true;
+  }
+  m_jobReady.notify_all();
+  for (auto &t : m_workers)
+    t.join();
+}
+
+template <typename FCN_T>
+void FinalizationThreads::parallel_for(size_t size, FCN_T &&fcn)
+{
+  std::atomic<size_t> next{0};
+  const std::function<void()> job = [&]() {
+    for (size_t begin = next.fetch_add(PARALLEL_CHUNK_SIZE); begin < size;
+         begin = next.fetch_add(PARALLEL_CHUNK_SIZE)) {
+      const size_t end = std::min(begin + PARALLEL_CHUNK_SIZE, size);
+      for (size_t i = begin; i < end; i++)
+        fcn(i);
+    }
+  };
+  run(job);
+}
+
+void FinalizationThreads::run(const std::function<void()> &job)
+{
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_job = &job;
+    m_jobCount++;
+    m_numRunning = uint32_t(m_workers.size());
+  }
+  m_jobReady.notify_all();
+
+  job();
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_jobDone.wait(lock, [&]() { return m_numRunning == 0; });
+  m_job = nullptr;
+}
+
+void FinalizationThreads::workerLoop()
+{
+  uint64_t lastJob = 0;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_jobReady.wait(lock, [&]() { return m_quit || m_jobCount != lastJob; });
+    if (m_quit)
+      return;
+
+    lastJob = m_jobCount;
+    auto *job = m_job;
+    lock.unlock();
+    (*job)();
+    lock.lock();
+
+    if (--m_numRunning == 0)
+      m_jobDone.notify_one();
+  }
+}
+
 // DeferredCommitBuffer definitions ///////////////////////////////////////////
 
 DeferredCommitBuffer::DeferredCommitBuffer()
@@ -32,6 +144,7 @@ DeferredCommitBuffer::DeferredCommitBuffer()
 
 DeferredCommitBuffer::~DeferredCommitBuffer()
 {
+  m_stagedParameters.clear();
   clearImpl();
 }
 
@@ -41,17 +154,73 @@ void DeferredCommitBuffer::addObjectToCommit(BaseObject *obj)
   addObjectToCommitImpl(obj);
 }
 
+void DeferredCommitBuffer::addObjectsToCommit(
+    BaseObject *const *objs, size_t count)
+{
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  for (size_t i = 0; i < count; i++)
+    addObjectToCommitImpl(objs[i]);
+}
+
 void DeferredCommitBuffer::addObjectToFinalize(BaseObject *obj)
 {
+  if (m_finalizingInParallel) {
+    std::lock_guard<std::mutex> guard(m_parallelMutex);
+    // Checked again under the lock, as the flushing thread takes it to
+    // collect these objects once the level is done
+    if (m_finalizingInParallel) {
+      if (markQueued(obj, QUEUED_FOR_FINALIZE))
+        m_parallelFinalizations.push_back(obj);
+      return;
+    }
+  }
+
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
   addObjectToFinalizeImpl(obj);
 }
 
+void DeferredCommitBuffer::setNumFinalizationThreads(uint32_t numThreads)
+{
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  numThreads = std::max(numThreads, 1u);
+  if (numThreads == m_numFinalizationThreads)
+    return;
+  m_numFinalizationThreads = numThreads;
+  m_finalizationThreads.reset();
+}
+
+void DeferredCommitBuffer::setParameterStaging(bool enabled)
+{
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  if (!enabled)
+    m_stagedParameters.apply();
+  m_parameterStaging = enabled;
+}
+
+bool DeferredCommitBuffer::parameterStaging() const
+{
+  return m_parameterStaging;
+}
+
+StagedParameterLog &DeferredCommitBuffer::stagedParameters()
+{
+  return m_stagedParameters;
+}
+
+void DeferredCommitBuffer::applyStagedParameters()
+{
+  if (m_stagedParameters.empty())
+    return;
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  m_stagedParameters.apply();
+}
+
 void DeferredCommitBuffer::flush()
 {
-  if (empty())
+  if (empty() && m_stagedParameters.empty())
     return;
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  m_stagedParameters.apply();
   flushCommits();
   flushFinalizations();
   clearImpl();
@@ -80,23 +249,49 @@ bool DeferredCommitBuffer::empty() const
 
 void DeferredCommitBuffer::addObjectToCommitImpl(BaseObject *obj)
 {
-  obj->refInc(RefType::INTERNAL);
-  m_commitBuffer.push_back(obj);
+  if (markQueued(obj, QUEUED_FOR_COMMIT))
+    m_commitBuffer.push_back(obj);
 }
 
 void DeferredCommitBuffer::addObjectToFinalizeImpl(BaseObject *obj)
 {
-  obj->refInc(RefType::INTERNAL);
+  if (!markQueued(obj, QUEUED_FOR_FINALIZE))
+    return;
   if (commitPriority(obj->type()) != commitPriority(ANARI_OBJECT))
     m_needToSortFinalizations = true;
   m_finalizationBuffer.push_back(obj);
 }
 
+bool DeferredCommitBuffer::markQueued(BaseObject *obj, uint64_t flag)
+{
+  auto &state = obj->m_commitBufferState;
+  const uint64_t epochBits = m_epoch << QUEUED_FLAG_BITS;
+
+  // First time this object is queued since the buffer was last cleared
+  if ((state & ~QUEUED_FLAGS) != epochBits) {
+    state = epochBits | flag;
+    obj->refInc(RefType::INTERNAL);
+    m_referencedObjects.push_back(obj);
+    return true;
+  }
+
+  if (state & flag)
+    return false;
+  state |= flag;
+  return true;
+}
+
+void DeferredCommitBuffer::markDequeued(BaseObject *obj, uint64_t flag)
+{
+  obj->m_commitBufferState &= ~flag;
+}
+
 void DeferredCommitBuffer::flushCommits()
 {
   bool didCommit = false;
   dynamic_foreach(m_commitBuffer, [&](size_t i) {
     auto obj = m_commitBuffer[i];
+    markDequeued(obj, QUEUED_FOR_COMMIT);
     if (obj->lastParameterChanged() > obj->lastCommitted()) {
       didCommit = true;
       obj->commitParameters();
@@ -112,40 +307,103 @@ void DeferredCommitBuffer::flushCommits()
 
 void DeferredCommitBuffer::flushFinalizations()
 {
-  if (m_needToSortFinalizations) {
-    std::sort(m_finalizationBuffer.begin(),
-        m_finalizationBuffer.end(),
-        [](BaseObject *o1, BaseObject *o2) {
-          return commitPriority(o1->type()) < commitPriority(o2->type());
-        });
-  }
+  auto byPriority = [](BaseObject *o1, BaseObject *o2) {
+    return commitPriority(o1->type()) < commitPriority(o2->type());
+  };
 
-  m_needToSortFinalizations = false;
+  auto &level = m_finalizationLevel;
 
   bool didFinalize = false;
-  dynamic_foreach(m_finalizationBuffer, [&](size_t i) {
-    auto obj = m_finalizationBuffer[i];
-    if (obj->lastUpdated() > obj->lastFinalized()) {
+  while (!m_finalizationBuffer.empty()) {
+    if (m_needToSortFinalizations) {
+      std::stable_sort(m_finalizationBuffer.begin(),
+          m_finalizationBuffer.end(),
+          byPriority);
+    }
+    m_needToSortFinalizations = false;
+
+    // Take every object of the lowest pending priority level
+    const int priority = commitPriority(m_finalizationBuffer.front()->type());
+    auto levelEnd = std::find_if(m_finalizationBuffer.begin(),
+        m_finalizationBuffer.end(),
+        [&](BaseObject *o) { return commitPriority(o->type()) != priority; });
+
+    level.clear();
+    for (auto it = m_finalizationBuffer.begin(); it != levelEnd; ++it) {
+      auto *obj = *it;
+      // Taken out of the queue, so it may be queued again from here on
+      markDequeued(obj, QUEUED_FOR_FINALIZE);
+      if (obj->lastUpdated() > obj->lastFinalized())
+        level.push_back(obj);
+    }
+    m_finalizationBuffer.erase(m_finalizationBuffer.begin(), levelEnd);
+    m_needToSortFinalizations = !m_finalizationBuffer.empty();
+
+    if (!level.empty()) {
       didFinalize = true;
+      finalizeLevel(level);
+    }
+  }
+
+  level.clear();
+
+  if (didFinalize)
+    m_lastFinalization = newTimeStamp();
+}
+
+void DeferredCommitBuffer::finalizeLevel(std::vector<BaseObject *> &level)
+{
+  // The level holds each object at most once, as objects are queued at most
+  // once until they are taken out of the queue, and only objects which were
+  // updated since they were last finalized
+
+  if (m_numFinalizationThreads <= 1
+      || level.size() < MIN_PARALLEL_LEVEL_SIZE) {
+    for (auto *obj : level) {
       obj->finalize();
       obj->markFinalized();
       obj->notifyChangeObservers();
     }
-  });
+    return;
+  }
 
-  if (didFinalize)
-    m_lastFinalization = newTimeStamp();
+  // Threads are started on first use and then kept until the buffer goes away
+  if (!m_finalizationThreads) {
+    m_finalizationThreads =
+        std::make_unique<FinalizationThreads>(m_numFinalizationThreads);
+  }
+
+  m_finalizingInParallel = true;
+  m_finalizationThreads->parallel_for(
+      level.size(), [&](size_t i) { level[i]->finalize(); });
+  m_finalizingInParallel = false;
+
+  for (auto *obj : level) {
+    obj->markFinalized();
+    obj->notifyChangeObservers();
+  }
+
+  // Objects notified while the level was finalizing may have been finalized
+  // concurrently with the change, so make sure they get finalized again
+  std::lock_guard<std::mutex> guard(m_parallelMutex);
+  for (auto *obj : m_parallelFinalizations) {
+    obj->markUpdated();
+    m_finalizationBuffer.push_back(obj);
+  }
+  if (!m_parallelFinalizations.empty())
+    m_needToSortFinalizations = true;
+  m_parallelFinalizations.clear();
 }
 
 void DeferredCommitBuffer::clearImpl()
 {
-  for (auto &obj : m_commitBuffer)
-    obj->refDec(RefType::INTERNAL);
-  for (auto &obj : m_finalizationBuffer)
+  for (auto &obj : m_referencedObjects)
     obj->refDec(RefType::INTERNAL);
+  m_referencedObjects.clear();
   m_commitBuffer.clear();
   m_finalizationBuffer.clear();
   m_needToSortFinalizations = false;
+  m_epoch++; // anything still marked as queued is now stale
 }
 
 } // namespace helium
\ No newline at end of file
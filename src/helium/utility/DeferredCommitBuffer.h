@@ -3,14 +3,19 @@
 
 #pragma once
 
+#include "StagedParameterLog.h"
 #include "TimeStamp.h"
 // std
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <vector>
 
 namespace helium {
 
 struct BaseObject;
+struct FinalizationThreads;
 
 struct DeferredCommitBuffer
 {
@@ -19,16 +24,48 @@ struct DeferredCommitBuffer
 
   // Add an object to be committed. Object ref counts are incremented by 1 while
   // objects are in this buffer. This will put the object into the finalization
-  // buffer if-needed (don't do this at the call site).
+  // buffer if-needed (don't do this at the call site). Adding an object which
+  // is already queued is a no-op.
   void addObjectToCommit(BaseObject *obj);
 
-  // Add an object to be finalized only.
+  // Add several objects to be committed, only locking the buffer once
+  void addObjectsToCommit(BaseObject *const *objs, size_t count);
+
+  // Add an object to be finalized only, which is a no-op if already queued.
   void addObjectToFinalize(BaseObject *obj);
 
   // Sort objects by priority and call BaseObject::commitParameters() and
   // BaseObject::finalize() on each object.
+  //
+  // Finalization proceeds one commitPriority() level at a time: objects within
+  // a level are assumed independent and are finalized concurrently when more
+  // than one finalization thread is allowed. Change observers notified while a
+  // level is finalizing are finalized in a later level.
   void flush();
 
+  // Set how many threads may call BaseObject::finalize() concurrently during
+  // flush(), where 1 (the default) finalizes everything on the flushing
+  // thread. Devices must only raise this if finalize() of distinct objects
+  // with the same commitPriority() is thread safe. The extra threads are
+  // started on the first parallel flush and kept until the buffer is
+  // destroyed or the number of threads changes.
+  void setNumFinalizationThreads(uint32_t numThreads);
+
+  // Enable staging of parameter writes made through BaseDevice (off by
+  // default). Writes are then appended to stagedParameters() without locking
+  // the object, and are applied in the order they were made at the start of
+  // flush(): a flush sees every write which completed before it started, and
+  // none of the writes which started after it. Devices must only enable this
+  // if objects read their parameters in commitParameters() exclusively.
+  void setParameterStaging(bool enabled);
+  bool parameterStaging() const;
+
+  // Parameter writes waiting to be applied by the next flush()
+  StagedParameterLog &stagedParameters();
+
+  // Apply staged parameter writes without committing anything
+  void applyStagedParameters();
+
   // Return when this buffer was last committed any object
   TimeStamp lastObjectCommit() const;
 
@@ -44,12 +81,35 @@ struct DeferredCommitBuffer
  private:
   void addObjectToCommitImpl(BaseObject *obj);
   void addObjectToFinalizeImpl(BaseObject *obj);
+  bool markQueued(BaseObject *obj, uint64_t flag);
+  void markDequeued(BaseObject *obj, uint64_t flag);
   void flushCommits();
   void flushFinalizations();
+  void finalizeLevel(std::vector<BaseObject *> &level);
   void clearImpl();
 
+  // Objects are queued at most once per epoch (tracked intrusively on each
+  // object, see markQueued()), and each object is referenced once until the
+  // buffer is cleared, which starts a new epoch. Queueing the same object
+  // many times between flushes thus costs neither memory nor ref counting.
+  // All vectors keep their storage across flushes.
+  uint64_t m_epoch{1};
+  std::vector<BaseObject *> m_referencedObjects;
   std::vector<BaseObject *> m_commitBuffer;
   std::vector<BaseObject *> m_finalizationBuffer;
+  std::vector<BaseObject *> m_finalizationLevel;
+  uint32_t m_numFinalizationThreads{1};
+  std::unique_ptr<FinalizationThreads> m_finalizationThreads;
+
+  std::atomic<bool> m_parameterStaging{false};
+  StagedParameterLog m_stagedParameters;
+
+  // Objects added for finalization while a level is being finalized in
+  // parallel (the flushing thread holds m_mutex at that point)
+  std::atomic<bool> m_finalizingInParallel{false};
+  std::vector<BaseObject *> m_parallelFinalizations;
+  std::mutex m_parallelMutex;
+
   bool m_needToSortFinalizations{false};
   TimeStamp m_lastCommit{0};
   TimeStamp m_lastFinalization{0};
@@ -0,0 +1,10 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "IntrusivePtr.h"
+
+namespace helium {
+
+RefCounted::~RefCounted() = default;
+
+} // namespace helium
@@ -22,7 +22,10 @@ class RefCounted
 {
  public:
   RefCounted() = default;
-  virtual ~RefCounted() = default;
+  // Not inline: refDec() would otherwise inline this class's own deleting
+  // destructor as a guess at the object's type, pairing the global operator
+  // delete with objects which bring their own allocator (see BaseObject)
+  virtual ~RefCounted();
 
   RefCounted(const RefCounted &) = delete;
   RefCounted(RefCounted &&) = delete;
@@ -50,14 +53,18 @@ inline void RefCounted::refInc(RefType type)
 {
   assert(type == RefType::PUBLIC || type == RefType::INTERNAL);
 
-  m_count += type;
+  // Taking a new reference requires already holding one, so nothing needs to
+  // be ordered with it
+  m_count.fetch_add(type, std::memory_order_relaxed);
 }
 
 inline void RefCounted::refDec(RefType type)
 {
   assert(type == RefType::PUBLIC || type == RefType::INTERNAL);
 
-  std::uint64_t prev = m_count.fetch_sub(type);
+  // Release this thread's writes to the object, and acquire everyone else's
+  // before the object can be destroyed or notified
+  std::uint64_t prev = m_count.fetch_sub(type, std::memory_order_acq_rel);
   // if the previous value was type it has to be 0 now
   if (prev == type) {
     delete this;
@@ -112,12 +119,18 @@ class IntrusivePtr
 
   template <typename O>
   IntrusivePtr(const IntrusivePtr<O> &input);
+  template <typename O>
+  IntrusivePtr(IntrusivePtr<O> &&input);
   IntrusivePtr(T *const input);
 
   IntrusivePtr &operator=(const IntrusivePtr &input);
   IntrusivePtr &operator=(IntrusivePtr &&input);
   IntrusivePtr &operator=(T *input);
 
+  // Return the pointee without taking a reference: it stays valid only for as
+  // long as this pointer (or another reference) keeps it alive
+  T *get() const;
+
   operator bool() const;
 
   const T &operator*() const;
@@ -159,6 +172,13 @@ inline IntrusivePtr<T>::IntrusivePtr(const IntrusivePtr<O> &input)
     ptr->refInc(RefType::INTERNAL);
 }
 
+template <typename T>
+template <typename O>
+inline IntrusivePtr<T>::IntrusivePtr(IntrusivePtr<O> &&input) : ptr(input.ptr)
+{
+  input.ptr = nullptr;
+}
+
 template <typename T>
 inline IntrusivePtr<T>::IntrusivePtr(T *const input) : ptr(input)
 {
@@ -180,8 +200,10 @@ inline IntrusivePtr<T> &IntrusivePtr<T>::operator=(const IntrusivePtr &input)
 template <typename T>
 inline IntrusivePtr<T> &IntrusivePtr<T>::operator=(IntrusivePtr &&input)
 {
+  if (this == &input)
+    return *this;
   if (ptr)
-    ptr->refDec();
+    ptr->refDec(RefType::INTERNAL);
   ptr = input.ptr;
   input.ptr = nullptr;
   return *this;
@@ -198,6 +220,12 @@ inline IntrusivePtr<T> &IntrusivePtr<T>::operator=(T *input)
   return *this;
 }
 
+template <typename T>
+inline T *IntrusivePtr<T>::get() const
+{
+  return ptr;
+}
+
 template <typename T>
 inline IntrusivePtr<T>::operator bool() const
 {
@@ -0,0 +1,87 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ObjectArena.h"
+// std
+#include <algorithm>
+
+namespace helium {
+
+// Helper functions ///////////////////////////////////////////////////////////
+
+constexpr size_t BLOCK_ALIGNMENT = alignof(std::max_align_t);
+constexpr size_t SLAB_SIZE = 64 * 1024;
+constexpr size_t MIN_SLAB_BLOCKS = 8;
+
+// ObjectArena definitions ////////////////////////////////////////////////////
+
+ObjectArena::~ObjectArena() = default;
+
+void *ObjectArena::allocate(size_t size)
+{
+  const size_t blockSize = blockSizeFor(size);
+
+  std::lock_guard<std::mutex> guard(m_mutex);
+
+  auto &pool = m_pools[blockSize];
+  if (pool.blockSize == 0) {
+    pool.blockSize = blockSize;
+    pool.numSlabBlocks = std::max(SLAB_SIZE / blockSize, MIN_SLAB_BLOCKS);
+  }
+
+  if (!pool.freeList)
+    addSlab(pool);
+
+  void *block = pool.freeList;
+  pool.freeList = *(void **)block;
+  m_numAllocations++;
+  return block;
+}
+
+void ObjectArena::deallocate(void *block, size_t size)
+{
+  if (!block)
+    return;
+
+  std::lock_guard<std::mutex> guard(m_mutex);
+
+  auto &pool = m_pools[blockSizeFor(size)];
+  *(void **)block = pool.freeList;
+  pool.freeList = block;
+  m_numAllocations--;
+}
+
+size_t ObjectArena::numAllocations() const
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+  return m_numAllocations;
+}
+
+size_t ObjectArena::bytesReserved() const
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+  return m_bytesReserved;
+}
+
+size_t ObjectArena::blockSizeFor(size_t size)
+{
+  size = std::max(size, sizeof(void *));
+  return (size + BLOCK_ALIGNMENT - 1) & ~(BLOCK_ALIGNMENT - 1);
+}
+
+void ObjectArena::addSlab(Pool &pool)
+{
+  const size_t slabSize = pool.blockSize * pool.numSlabBlocks;
+  auto &slab = m_slabs.emplace_back(new std::byte[slabSize]);
+  m_bytesReserved += slabSize;
+
+  // Thread the new blocks onto the free list in address order
+  std::byte *begin = slab.get();
+  for (size_t i = pool.numSlabBlocks; i-- > 0;) {
+    void *block = begin + i * pool.blockSize;
+    *(void **)block = pool.freeList;
+    pool.freeList = block;
+  }
+}
+
+} // namespace helium
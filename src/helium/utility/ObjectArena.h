@@ -0,0 +1,66 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace helium {
+
+// Allocator for the memory of BaseObject instances, which devices opt into by
+// setting BaseGlobalDeviceState::objectArena and creating objects with
+// 'new (state) T(...)'. Blocks are carved from large slabs, with a separate
+// pool per block size so every concrete object type gets its own pool, and
+// freed blocks are reused by the next object of the same size. Slabs are only
+// returned to the system when the arena is destroyed.
+//
+// NOTE: objects leaked by the application (which BaseDevice reports when it is
+//       destroyed) lose their memory along with the slabs, but their
+//       destructors never run: whatever they own outside of their block stays
+//       leaked, just like without an arena.
+//
+// Devices can derive from this to provide their own allocation scheme.
+struct ObjectArena
+{
+  ObjectArena() = default;
+  virtual ~ObjectArena();
+
+  ObjectArena(const ObjectArena &) = delete;
+  ObjectArena &operator=(const ObjectArena &) = delete;
+
+  // Allocate/free a block of at least 'size' bytes, aligned to
+  // alignof(std::max_align_t) (BaseObject handles stricter alignments)
+  virtual void *allocate(size_t size);
+  virtual void deallocate(void *block, size_t size);
+
+  // Return the number of live allocations
+  size_t numAllocations() const;
+
+  // Return the number of bytes held in slabs
+  size_t bytesReserved() const;
+
+ private:
+  struct Pool
+  {
+    size_t blockSize{0};
+    size_t numSlabBlocks{0};
+    void *freeList{nullptr};
+  };
+
+  static size_t blockSizeFor(size_t size);
+  void addSlab(Pool &pool);
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<size_t, Pool> m_pools;
+  std::vector<std::unique_ptr<std::byte[]>> m_slabs;
+  size_t m_numAllocations{0};
+  size_t m_bytesReserved{0};
+};
+
+} // namespace helium
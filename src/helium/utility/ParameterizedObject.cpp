@@ -4,35 +4,69 @@
 #include "ParameterizedObject.h"
 // std
 #include <cstring>
+#include <utility>
 
 namespace helium {
 
-bool ParameterizedObject::hasParam(const std::string &name) const
+// Helper functions ///////////////////////////////////////////////////////////
+
+static uint32_t slotHash(StringAtom name, uint32_t numBits)
+{
+  // Fibonacci hashing: the top bits of the product spread the sequential atom
+  // ids over the table
+  return (name.id() * 2654435769u) >> (32 - numBits);
+}
+
+// ParameterizedObject definitions ////////////////////////////////////////////
+
+bool ParameterizedObject::hasParam(std::string_view name) const
+{
+  return hasParam(StringAtom::find(name));
+}
+
+bool ParameterizedObject::hasParam(StringAtom name) const
 {
   return findParam(name) != nullptr;
 }
 
 bool ParameterizedObject::hasParam(
-    const std::string &name, ANARIDataType type) const
+    std::string_view name, ANARIDataType type) const
+{
+  return hasParam(StringAtom::find(name), type);
+}
+
+bool ParameterizedObject::hasParam(StringAtom name, ANARIDataType type) const
 {
   auto *p = findParam(name);
   return p ? p->second.type() == type : false;
 }
 
 bool ParameterizedObject::setParam(
-    const std::string &name, ANARIDataType type, const void *v)
+    std::string_view name, ANARIDataType type, const void *v)
+{
+  return setParam(StringAtom(name), type, v);
+}
+
+bool ParameterizedObject::setParam(
+    StringAtom name, ANARIDataType type, const void *v)
 {
   AnariAny value(type, v);
-  auto *p = findParam(name);
+  auto *p = findOrAddParam(name);
   if (p->second != value) {
-    p->second = value;
+    p->second = std::move(value);
     return true;
   } else
     return false;
 }
 
 bool ParameterizedObject::getParam(
-    const std::string &name, ANARIDataType type, void *v) const
+    std::string_view name, ANARIDataType type, void *v) const
+{
+  return getParam(StringAtom::find(name), type, v);
+}
+
+bool ParameterizedObject::getParam(
+    StringAtom name, ANARIDataType type, void *v) const
 {
   if (type == ANARI_STRING || anari::isObject(type))
     return false;
@@ -46,41 +80,96 @@ bool ParameterizedObject::getParam(
 }
 
 std::string ParameterizedObject::getParamString(
-    const std::string &name, const std::string &valIfNotFound) const
+    std::string_view name, const std::string &valIfNotFound) const
+{
+  return getParamString(StringAtom::find(name), valIfNotFound);
+}
+
+std::string ParameterizedObject::getParamString(
+    StringAtom name, const std::string &valIfNotFound) const
 {
   auto *p = findParam(name);
   return p ? p->second.getString() : valIfNotFound;
 }
 
-AnariAny ParameterizedObject::getParamDirect(const std::string &name) const
+AnariAny ParameterizedObject::getParamDirect(std::string_view name) const
+{
+  return getParamDirect(StringAtom::find(name));
+}
+
+AnariAny ParameterizedObject::getParamDirect(StringAtom name) const
 {
   auto *p = findParam(name);
   return p ? p->second : AnariAny();
 }
 
-void ParameterizedObject::setParamDirect(
-    const std::string &name, const AnariAny &v)
+bool ParameterizedObject::setParamDirect(
+    std::string_view name, const AnariAny &v)
+{
+  return setParamDirect(StringAtom(name), v);
+}
+
+bool ParameterizedObject::setParamDirect(StringAtom name, const AnariAny &v)
 {
-  findParam(name)->second = v;
+  auto *p = findOrAddParam(name);
+  if (p->second != v) {
+    p->second = v;
+    return true;
+  } else
+    return false;
 }
 
-bool ParameterizedObject::removeParam(const std::string &name)
+bool ParameterizedObject::setParamDirect(std::string_view name, AnariAny &&v)
 {
-  auto foundParam = std::find_if(m_params.begin(),
-      m_params.end(),
-      [&](const Param &p) { return p.first == name; });
+  return setParamDirect(StringAtom(name), std::move(v));
+}
 
-  if (foundParam != m_params.end()) {
-    m_params.erase(foundParam);
+bool ParameterizedObject::setParamDirect(StringAtom name, AnariAny &&v)
+{
+  auto *p = findOrAddParam(name);
+  if (p->second != v) {
+    p->second = std::move(v);
     return true;
   } else
     return false;
 }
 
+const AnariAny &ParameterizedObject::borrowParamDirect(
+    std::string_view name) const
+{
+  return borrowParamDirect(StringAtom::find(name));
+}
+
+const AnariAny &ParameterizedObject::borrowParamDirect(StringAtom name) const
+{
+  static const AnariAny empty;
+  auto *p = findParam(name);
+  return p ? p->second : empty;
+}
+
+bool ParameterizedObject::removeParam(std::string_view name)
+{
+  return removeParam(StringAtom::find(name));
+}
+
+bool ParameterizedObject::removeParam(StringAtom name)
+{
+  const int slot = findSlot(name);
+  if (slot < 0)
+    return false;
+
+  const auto pos = m_index[slot] - 1;
+  m_params.erase(m_params.begin() + pos);
+  rebuildIndex();
+  return true;
+}
+
 bool ParameterizedObject::removeAllParams()
 {
   if (!m_params.empty()) {
     m_params.clear();
+    m_index.clear();
+    m_indexBits = 0;
     return true;
   } else
     return false;
@@ -97,29 +186,67 @@ ParameterizedObject::ParameterList::iterator ParameterizedObject::params_end()
 }
 
 const ParameterizedObject::Param *ParameterizedObject::findParam(
-    const std::string &name) const
+    StringAtom name) const
 {
-  auto foundParam = std::find_if(m_params.begin(),
-      m_params.end(),
-      [&](const Param &p) { return p.first == name; });
+  const int slot = findSlot(name);
+  return slot < 0 ? nullptr : &m_params[m_index[slot] - 1];
+}
 
-  if (foundParam != m_params.end())
-    return &(*foundParam);
-  return nullptr;
+ParameterizedObject::Param *ParameterizedObject::findParam(StringAtom name)
+{
+  const int slot = findSlot(name);
+  return slot < 0 ? nullptr : &m_params[m_index[slot] - 1];
 }
 
-ParameterizedObject::Param *ParameterizedObject::findParam(
-    const std::string &name)
+ParameterizedObject::Param *ParameterizedObject::findOrAddParam(
+    StringAtom name)
 {
-  auto foundParam = std::find_if(m_params.begin(),
-      m_params.end(),
-      [&](const Param &p) { return p.first == name; });
+  if (auto *p = findParam(name); p)
+    return p;
+
+  m_params.emplace_back(name, AnariAny());
 
-  if (foundParam != m_params.end())
-    return &(*foundParam);
+  // Keep the table at most half full so probe sequences stay short
+  if (m_params.size() * 2 > m_index.size())
+    rebuildIndex();
   else {
-    m_params.emplace_back(name, AnariAny());
-    return &m_params[m_params.size() - 1];
+    auto slot = slotHash(name, m_indexBits);
+    while (m_index[slot] != 0)
+      slot = (slot + 1) & (m_index.size() - 1);
+    m_index[slot] = uint32_t(m_params.size());
+  }
+
+  return &m_params.back();
+}
+
+int ParameterizedObject::findSlot(StringAtom name) const
+{
+  if (!name.valid() || m_index.empty())
+    return -1;
+
+  const auto mask = m_index.size() - 1;
+  for (auto slot = slotHash(name, m_indexBits); m_index[slot] != 0;
+       slot = (slot + 1) & mask) {
+    if (m_params[m_index[slot] - 1].first == name)
+      return int(slot);
+  }
+
+  return -1;
+}
+
+void ParameterizedObject::rebuildIndex()
+{
+  m_indexBits = 3;
+  while ((size_t(1) << m_indexBits) < m_params.size() * 2)
+    m_indexBits++;
+
+  const size_t numSlots = size_t(1) << m_indexBits;
+  m_index.assign(numSlots, 0);
+  for (size_t i = 0; i < m_params.size(); i++) {
+    auto slot = slotHash(m_params[i].first, m_indexBits);
+    while (m_index[slot] != 0)
+      slot = (slot + 1) & (numSlots - 1);
+    m_index[slot] = uint32_t(i + 1);
   }
 }
 
@@ -4,38 +4,49 @@
 #pragma once
 
 #include "AnariAny.h"
+#include "StringAtom.h"
 // anari
 #include "anari/anari_cpp/Traits.h"
 // stl
 #include <cstring>
 #include <memory>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 namespace helium {
 
+// NOTE: every method taking a parameter name has an overload taking a
+//       StringAtom, which skips looking up the name in the global atom table.
+//       Names passed as strings never allocate on lookup.
+
 struct ParameterizedObject
 {
   ParameterizedObject() = default;
   virtual ~ParameterizedObject() = default;
 
   // Return true if there was a parameter set with the corresponding 'name'
-  bool hasParam(const std::string &name) const;
+  bool hasParam(std::string_view name) const;
+  bool hasParam(StringAtom name) const;
 
   // Return true if there was a parameter set with the corresponding 'name' and
   // if it matches the corresponding type
-  bool hasParam(const std::string &name, ANARIDataType type) const;
+  bool hasParam(std::string_view name, ANARIDataType type) const;
+  bool hasParam(StringAtom name, ANARIDataType type) const;
 
   // Set the value of the parameter 'name', or add it if it doesn't exist yet
   //
   // Returns 'true' if the value for that parameter actually changed
-  bool setParam(const std::string &name, ANARIDataType type, const void *v);
+  bool setParam(std::string_view name, ANARIDataType type, const void *v);
+  bool setParam(StringAtom name, ANARIDataType type, const void *v);
 
   // Set the value of the parameter 'name', or add it if it doesn't exist yet
   //
   // Returns 'true' if the value for that parameter actually changed
   template <typename T>
-  bool setParam(const std::string &name, const T &v);
+  bool setParam(std::string_view name, const T &v);
+  template <typename T>
+  bool setParam(StringAtom name, const T &v);
 
   // Get the value of the parameter associated with 'name', or return
   // 'valueIfNotFound' if the parameter isn't set. This is strongly typed by
@@ -45,13 +56,16 @@ struct ParameterizedObject
   // access ANARIObject or ANARIString parameters, see special methods for
   // getting parameters of those types.
   template <typename T>
-  T getParam(const std::string &name, T valIfNotFound) const;
+  T getParam(std::string_view name, T valIfNotFound) const;
+  template <typename T>
+  T getParam(StringAtom name, T valIfNotFound) const;
 
   // Get the value of the parameter associated with 'name' and write it to
   // location 'v', returning whether the was actually read. Just like the
   // templated version above, this requires that 'type' exactly match what the
   // application set. This function also cannot get objects or strings.
-  bool getParam(const std::string &name, ANARIDataType type, void *v) const;
+  bool getParam(std::string_view name, ANARIDataType type, void *v) const;
+  bool getParam(StringAtom name, ANARIDataType type, void *v) const;
 
   // Get the pointer to an object parameter (returns null if not present). While
   // ParameterizedObject will track object lifetime appropriately, accessing
@@ -59,23 +73,41 @@ struct ParameterizedObject
   // should consider using `helium::IntrusivePtr<>` to guarantee correct
   // lifetime handling.
   template <typename T>
-  T *getParamObject(const std::string &name) const;
+  T *getParamObject(std::string_view name) const;
+  template <typename T>
+  T *getParamObject(StringAtom name) const;
 
   // Get a string parameter value
   std::string getParamString(
-      const std::string &name, const std::string &valIfNotFound) const;
+      std::string_view name, const std::string &valIfNotFound) const;
+  std::string getParamString(
+      StringAtom name, const std::string &valIfNotFound) const;
 
   // Get/Set the container holding the value of a parameter (default constructed
   // AnariAny if not present). Getting this container will create a copy of the
   // parameter value, which for objects will incur the correct ref count changes
-  // accordingly (handled by AnariAny).
-  AnariAny getParamDirect(const std::string &name) const;
-  void setParamDirect(const std::string &name, const AnariAny &v);
+  // accordingly (handled by AnariAny). Setting from a temporary moves it in,
+  // which leaves object ref counts alone.
+  //
+  // Setting returns 'true' if the value for that parameter actually changed
+  AnariAny getParamDirect(std::string_view name) const;
+  AnariAny getParamDirect(StringAtom name) const;
+  bool setParamDirect(std::string_view name, const AnariAny &v);
+  bool setParamDirect(StringAtom name, const AnariAny &v);
+  bool setParamDirect(std::string_view name, AnariAny &&v);
+  bool setParamDirect(StringAtom name, AnariAny &&v);
+
+  // Get the container holding the value of a parameter without copying it, so
+  // no ref counts are touched (an empty AnariAny if not present). The
+  // reference is only valid until the parameter is next set or removed.
+  const AnariAny &borrowParamDirect(std::string_view name) const;
+  const AnariAny &borrowParamDirect(StringAtom name) const;
 
   // Remove the value of the parameter associated with 'name'.
   //
   // Returns 'true' if anything actually happened
-  bool removeParam(const std::string &name);
+  bool removeParam(std::string_view name);
+  bool removeParam(StringAtom name);
 
   // Remove all set parameters
   //
@@ -83,7 +115,7 @@ struct ParameterizedObject
   bool removeAllParams();
 
  protected:
-  using Param = std::pair<std::string, AnariAny>;
+  using Param = std::pair<StringAtom, AnariAny>;
   using ParameterList = std::vector<Param>;
 
   ParameterList::iterator params_begin();
@@ -92,16 +124,33 @@ struct ParameterizedObject
  private:
   // Data members //
 
-  const Param *findParam(const std::string &name) const;
-  Param *findParam(const std::string &name);
+  const Param *findParam(StringAtom name) const;
+  Param *findParam(StringAtom name);
+  Param *findOrAddParam(StringAtom name);
 
+  int findSlot(StringAtom name) const;
+  void rebuildIndex();
+
+  // Parameters in the order they were first set
   ParameterList m_params;
+
+  // Open-addressing (linear probing) table from atom to position in m_params,
+  // where each slot holds 'position + 1' and 0 marks an empty slot. The table
+  // has 2^m_indexBits slots.
+  std::vector<uint32_t> m_index;
+  uint32_t m_indexBits{0};
 };
 
 // Inlined ParameterizedObject definitions ////////////////////////////////////
 
 template <typename T>
-inline bool ParameterizedObject::setParam(const std::string &name, const T &v)
+inline bool ParameterizedObject::setParam(std::string_view name, const T &v)
+{
+  return setParam<T>(StringAtom(name), v);
+}
+
+template <typename T>
+inline bool ParameterizedObject::setParam(StringAtom name, const T &v)
 {
   constexpr ANARIDataType type = anari::ANARITypeFor<T>::value;
   return setParam(name, type, &v);
@@ -109,14 +158,13 @@ inline bool ParameterizedObject::setParam(const std::string &name, const T &v)
 
 template <>
 inline bool ParameterizedObject::setParam(
-    const std::string &name, const std::string &v)
+    StringAtom name, const std::string &v)
 {
   return setParam(name, ANARI_STRING, v.c_str());
 }
 
 template <>
-inline bool ParameterizedObject::setParam(
-    const std::string &name, const bool &v)
+inline bool ParameterizedObject::setParam(StringAtom name, const bool &v)
 {
   uint8_t b = v;
   return setParam(name, ANARI_BOOL, &b);
@@ -124,7 +172,13 @@ inline bool ParameterizedObject::setParam(
 
 template <typename T>
 inline T ParameterizedObject::getParam(
-    const std::string &name, T valIfNotFound) const
+    std::string_view name, T valIfNotFound) const
+{
+  return getParam<T>(StringAtom::find(name), valIfNotFound);
+}
+
+template <typename T>
+inline T ParameterizedObject::getParam(StringAtom name, T valIfNotFound) const
 {
   constexpr ANARIDataType type = anari::ANARITypeFor<T>::value;
   static_assert(!anari::isObject(type),
@@ -137,14 +191,20 @@ inline T ParameterizedObject::getParam(
 
 template <>
 inline bool ParameterizedObject::getParam(
-    const std::string &name, bool valIfNotFound) const
+    StringAtom name, bool valIfNotFound) const
 {
   auto *p = findParam(name);
   return p && p->second.is(ANARI_BOOL) ? p->second.get<bool>() : valIfNotFound;
 }
 
 template <typename T>
-inline T *ParameterizedObject::getParamObject(const std::string &name) const
+inline T *ParameterizedObject::getParamObject(std::string_view name) const
+{
+  return getParamObject<T>(StringAtom::find(name));
+}
+
+template <typename T>
+inline T *ParameterizedObject::getParamObject(StringAtom name) const
 {
   auto *p = findParam(name);
   return p ? p->second.getObject<T>() : nullptr;
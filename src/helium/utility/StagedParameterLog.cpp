@@ -0,0 +1,222 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "StagedParameterLog.h"
+#include "BaseObject.h"
+// std
+#include <algorithm>
+#include <utility>
+
+namespace helium {
+
+// Helper functions ///////////////////////////////////////////////////////////
+
+static uint64_t nextLogID()
+{
+  static std::atomic<uint64_t> nextID{0};
+  return nextID++;
+}
+
+// Per-thread list of the logs the thread writes to, letting the logs know
+// when the thread exits
+struct StagedParameterLog::ThreadLogCache
+{
+  ~ThreadLogCache()
+  {
+    for (auto &l : logs)
+      l.second->threadExited = true;
+  }
+
+  std::vector<std::pair<uint64_t, std::shared_ptr<ThreadLog>>> logs;
+};
+
+// StagedParameterLog definitions /////////////////////////////////////////////
+
+StagedParameterLog::StagedParameterLog() : m_id(nextLogID()) {}
+
+StagedParameterLog::~StagedParameterLog()
+{
+  clear();
+
+  std::lock_guard<std::mutex> guard(m_threadLogsMutex);
+  for (auto &log : m_threadLogs)
+    log->logDestroyed = true;
+}
+
+void StagedParameterLog::setParam(
+    BaseObject *obj, StringAtom name, ANARIDataType type, const void *mem)
+{
+  stage(obj, Op::SET, name, AnariAny(type, mem));
+}
+
+void StagedParameterLog::removeParam(BaseObject *obj, StringAtom name)
+{
+  stage(obj, Op::REMOVE, name, AnariAny());
+}
+
+void StagedParameterLog::removeAllParams(BaseObject *obj)
+{
+  stage(obj, Op::REMOVE_ALL, StringAtom(), AnariAny());
+}
+
+void StagedParameterLog::apply()
+{
+  const uint64_t end = m_nextSequence.load();
+  if (end == m_appliedSequence)
+    return;
+
+  takeWrites(end);
+
+  for (auto &w : m_taken) {
+    auto *obj = w.obj;
+
+    bool changed = false;
+    switch (w.op) {
+    case Op::SET:
+      changed = obj->setParamDirect(w.name, std::move(w.value));
+      break;
+    case Op::REMOVE:
+      changed = obj->removeParam(w.name);
+      break;
+    case Op::REMOVE_ALL:
+      changed = obj->removeAllParams();
+      break;
+    }
+
+    if (changed)
+      obj->markParameterChanged();
+  }
+
+  releaseTaken();
+  m_appliedSequence = end;
+}
+
+void StagedParameterLog::clear()
+{
+  const uint64_t end = m_nextSequence.load();
+  takeWrites(end);
+  releaseTaken();
+  m_appliedSequence = end;
+}
+
+bool StagedParameterLog::empty() const
+{
+  return m_nextSequence.load() == m_appliedSequence.load();
+}
+
+void StagedParameterLog::stage(
+    BaseObject *obj, Op op, StringAtom name, AnariAny &&value)
+{
+  auto &log = threadLog();
+  std::lock_guard<std::mutex> guard(log.mutex);
+
+  if (log.objects.insert(obj).second)
+    obj->refInc(RefType::INTERNAL);
+
+  // The sequence number is taken while holding the log's lock, so every write
+  // numbered below what takeWrites() reads is in its log by the time that log
+  // is visited
+  auto &w = log.writes.emplace_back();
+  w.sequence = m_nextSequence++;
+  w.obj = obj;
+  w.op = op;
+  w.name = name;
+  w.value = std::move(value);
+}
+
+StagedParameterLog::ThreadLog &StagedParameterLog::threadLog()
+{
+  thread_local ThreadLogCache cache;
+  auto &logs = cache.logs;
+
+  for (auto &l : logs) {
+    if (l.first == m_id)
+      return *l.second;
+  }
+
+  // Forget logs which were destroyed since this thread last wrote to them
+  logs.erase(std::remove_if(logs.begin(),
+                 logs.end(),
+                 [](auto &l) { return l.second->logDestroyed.load(); }),
+      logs.end());
+
+  auto log = std::make_shared<ThreadLog>();
+  {
+    std::lock_guard<std::mutex> guard(m_threadLogsMutex);
+    m_threadLogs.push_back(log);
+  }
+  logs.emplace_back(m_id, log);
+  return *log;
+}
+
+void StagedParameterLog::takeWrites(uint64_t end)
+{
+  size_t numLogsTaken = 0;
+
+  {
+    std::lock_guard<std::mutex> guard(m_threadLogsMutex);
+    for (auto &log : m_threadLogs) {
+      std::lock_guard<std::mutex> logGuard(log->mutex);
+      auto &writes = log->writes;
+
+      // Writes are in sequence order within a log
+      auto last = std::find_if(writes.begin(), writes.end(), [&](auto &w) {
+        return w.sequence >= end;
+      });
+      if (last == writes.begin())
+        continue;
+
+      m_taken.insert(m_taken.end(),
+          std::make_move_iterator(writes.begin()),
+          std::make_move_iterator(last));
+      writes.erase(writes.begin(), last);
+      numLogsTaken++;
+
+      // Hand over the references of objects without writes left in the log
+      auto &objects = log->objects;
+      if (writes.empty()) {
+        m_takenObjects.insert(
+            m_takenObjects.end(), objects.begin(), objects.end());
+        objects.clear();
+      } else {
+        std::unordered_set<BaseObject *> remaining;
+        for (auto &w : writes)
+          remaining.insert(w.obj);
+        for (auto *obj : objects) {
+          if (remaining.count(obj) == 0)
+            m_takenObjects.push_back(obj);
+        }
+        objects = std::move(remaining);
+      }
+    }
+
+    // Drop the logs of exited threads, as nothing writes to them anymore
+    auto isAbandoned = [](const std::shared_ptr<ThreadLog> &log) {
+      return log->threadExited && log->writes.empty();
+    };
+    m_threadLogs.erase(std::remove_if(m_threadLogs.begin(),
+                           m_threadLogs.end(),
+                           isAbandoned),
+        m_threadLogs.end());
+  }
+
+  if (numLogsTaken > 1) {
+    std::sort(m_taken.begin(), m_taken.end(), [](auto &a, auto &b) {
+      return a.sequence < b.sequence;
+    });
+  }
+}
+
+void StagedParameterLog::releaseTaken()
+{
+  // Release values before objects, as a value may be the last thing keeping
+  // another staged object alive
+  for (auto &w : m_taken)
+    w.value.reset();
+  m_taken.clear();
+  for (auto *obj : m_takenObjects)
+    obj->refDec(RefType::INTERNAL);
+  m_takenObjects.clear();
+}
+
+} // namespace helium
@@ -0,0 +1,107 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "AnariAny.h"
+#include "StringAtom.h"
+// std
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace helium {
+
+struct BaseObject;
+
+// Parameter writes made by application threads which are applied to their
+// objects later, all at once. Each writing thread appends to its own log, so
+// writers never wait on each other or on the objects they write to: the only
+// lock a writer takes is its own log's, which is otherwise only taken while
+// the logs are being applied.
+//
+// Every write is given a sequence number when it is staged. apply() takes
+// every write staged before it was called and applies them in that order,
+// leaving later writes for the next call.
+struct StagedParameterLog
+{
+  StagedParameterLog();
+  ~StagedParameterLog();
+
+  // Stage BaseObject::setParam(), BaseObject::removeParam(), and
+  // BaseObject::removeAllParams() calls. Objects are kept alive until their
+  // writes are applied or discarded, with one internal reference per object
+  // and writing thread regardless of how many writes are staged.
+  void setParam(
+      BaseObject *obj, StringAtom name, ANARIDataType type, const void *mem);
+  void removeParam(BaseObject *obj, StringAtom name);
+  void removeAllParams(BaseObject *obj);
+
+  // Apply staged writes, marking each object whose parameters actually
+  // changed. This must not be called concurrently with itself. Logs of
+  // threads which have exited are dropped once they are empty.
+  void apply();
+
+  // Discard staged writes without applying them
+  void clear();
+
+  // Return if there are no staged writes
+  bool empty() const;
+
+ private:
+  enum class Op
+  {
+    SET,
+    REMOVE,
+    REMOVE_ALL
+  };
+
+  struct Write
+  {
+    uint64_t sequence{0};
+    BaseObject *obj{nullptr};
+    Op op{Op::SET};
+    StringAtom name;
+    AnariAny value;
+  };
+
+  struct ThreadLog
+  {
+    std::mutex mutex;
+    std::vector<Write> writes;
+    // The objects of 'writes', each holding one internal reference
+    std::unordered_set<BaseObject *> objects;
+    // Let each side know when the other no longer uses this log: a thread
+    // which exited won't write to it, and a destroyed log won't read it
+    std::atomic<bool> threadExited{false};
+    std::atomic<bool> logDestroyed{false};
+  };
+
+  struct ThreadLogCache;
+
+  void stage(BaseObject *obj, Op op, StringAtom name, AnariAny &&value);
+  ThreadLog &threadLog();
+  void takeWrites(uint64_t end);
+  void releaseTaken();
+
+  // Identifies this log in the per-thread cache of ThreadLog pointers, as
+  // addresses may be reused once a log is destroyed
+  const uint64_t m_id;
+
+  std::atomic<uint64_t> m_nextSequence{0};
+  std::atomic<uint64_t> m_appliedSequence{0};
+
+  // Shared with the cache of each writing thread, see threadLog()
+  std::mutex m_threadLogsMutex;
+  std::vector<std::shared_ptr<ThreadLog>> m_threadLogs;
+
+  // Writes taken from the thread logs by apply(), and the objects whose
+  // references were handed over with them, kept to reuse storage
+  std::vector<Write> m_taken;
+  std::vector<BaseObject *> m_takenObjects;
+};
+
+} // namespace helium
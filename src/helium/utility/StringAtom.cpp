@@ -0,0 +1,109 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "StringAtom.h"
+// std
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace helium {
+
+namespace {
+
+struct StringAtomTable
+{
+  std::shared_mutex mutex;
+  // NOTE: deque never moves its elements, so entries (and the string_view keys
+  //       pointing into them) stay valid as the table grows
+  std::deque<detail::StringAtomEntry> entries;
+  std::unordered_map<std::string_view, const detail::StringAtomEntry *> index;
+};
+
+StringAtomTable &atomTable()
+{
+  static StringAtomTable table;
+  return table;
+}
+
+// Atoms each thread has already looked up, so repeated lookups of the same
+// names (e.g. by objects committed in parallel) don't take the table lock.
+// Entries are never removed from the table, so the cached keys stay valid.
+using AtomCache =
+    std::unordered_map<std::string_view, const detail::StringAtomEntry *>;
+
+constexpr size_t MAX_CACHED_ATOMS = 1024;
+
+AtomCache &threadCache()
+{
+  thread_local AtomCache cache;
+  return cache;
+}
+
+const detail::StringAtomEntry *findCached(std::string_view s)
+{
+  auto &cache = threadCache();
+  auto it = cache.find(s);
+  return it != cache.end() ? it->second : nullptr;
+}
+
+void addCached(const detail::StringAtomEntry *e)
+{
+  auto &cache = threadCache();
+  if (cache.size() >= MAX_CACHED_ATOMS)
+    cache.clear();
+  cache.emplace(std::string_view(e->str), e);
+}
+
+} // namespace
+
+StringAtom::StringAtom(std::string_view s)
+{
+  if (auto atom = find(s); atom.valid()) {
+    m_entry = atom.m_entry;
+    return;
+  }
+
+  auto &table = atomTable();
+  std::unique_lock<std::shared_mutex> lock(table.mutex);
+  if (auto it = table.index.find(s); it != table.index.end())
+    m_entry = it->second;
+  else {
+    auto &e = table.entries.emplace_back();
+    e.str = std::string(s);
+    e.id = uint32_t(table.entries.size() - 1);
+    table.index.emplace(std::string_view(e.str), &e);
+    m_entry = &e;
+  }
+
+  addCached(m_entry);
+}
+
+StringAtom StringAtom::find(std::string_view s)
+{
+  if (auto *e = findCached(s); e)
+    return StringAtom(e);
+
+  const detail::StringAtomEntry *e = nullptr;
+  {
+    auto &table = atomTable();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+    if (auto it = table.index.find(s); it != table.index.end())
+      e = it->second;
+  }
+
+  // Names which were never interned are not cached, as another thread may
+  // intern them later
+  if (e)
+    addCached(e);
+  return StringAtom(e);
+}
+
+const std::string &StringAtom::str() const
+{
+  static const std::string empty;
+  return m_entry ? m_entry->str : empty;
+}
+
+} // namespace helium
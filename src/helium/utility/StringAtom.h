@@ -0,0 +1,93 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+// std
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace helium {
+
+namespace detail {
+struct StringAtomEntry;
+} // namespace detail
+
+// Handle to a string interned in a process-wide table: equal strings always
+// map to the same atom, so comparing or hashing atoms never touches the
+// characters. Devices can construct atoms for parameter names once (e.g. as
+// function-local statics) and pass them to ParameterizedObject lookups.
+//
+// NOTE: atoms are never removed from the table, so it holds every distinct
+//       name interned during the life of the process. Only setting a
+//       parameter interns its name; looking up a name that was never set
+//       leaves the table alone.
+struct StringAtom
+{
+  StringAtom() = default;
+
+  // Intern 's', adding it to the table if it is not there yet
+  explicit StringAtom(std::string_view s);
+
+  // Lookup 's' without interning it, returning an invalid atom if 's' has
+  // never been interned
+  static StringAtom find(std::string_view s);
+
+  bool valid() const;
+  uint32_t id() const;
+  const std::string &str() const;
+
+  // Atoms read as their string where one is expected, e.g. for code which
+  // took parameter names from ParameterizedObject::params_begin() as strings
+  operator const std::string &() const;
+
+  bool operator==(const StringAtom &rhs) const;
+  bool operator!=(const StringAtom &rhs) const;
+
+ private:
+  StringAtom(const detail::StringAtomEntry *e);
+
+  const detail::StringAtomEntry *m_entry{nullptr};
+};
+
+// Inlined definitions ////////////////////////////////////////////////////////
+
+namespace detail {
+
+struct StringAtomEntry
+{
+  std::string str;
+  uint32_t id{0};
+};
+
+} // namespace detail
+
+inline StringAtom::StringAtom(const detail::StringAtomEntry *e) : m_entry(e) {}
+
+inline bool StringAtom::valid() const
+{
+  return m_entry != nullptr;
+}
+
+inline uint32_t StringAtom::id() const
+{
+  return m_entry ? m_entry->id : ~0u;
+}
+
+inline StringAtom::operator const std::string &() const
+{
+  return str();
+}
+
+inline bool StringAtom::operator==(const StringAtom &rhs) const
+{
+  return m_entry == rhs.m_entry;
+}
+
+inline bool StringAtom::operator!=(const StringAtom &rhs) const
+{
+  return !(*this == rhs);
+}
+
+} // namespace helium
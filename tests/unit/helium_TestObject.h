@@ -0,0 +1,71 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "helium/BaseGlobalDeviceState.h"
+#include "helium/BaseObject.h"
+#include "helium/utility/ChangeObserverPtr.h"
+// std
+#include <atomic>
+#include <vector>
+
+namespace unit_test {
+
+// Minimal object shared by the helium unit tests. Committing reads the object
+// parameter "dependency", which is observed with the given mode, and the
+// uint32 parameter "id". Finalizing counts how often it happened and records
+// the 'value' of the dependency at that point. Dirty flags raised on the
+// dependency are recorded and raised on this object as well.
+struct TestObject : public helium::BaseObject
+{
+  TestObject(ANARIDataType type,
+      helium::BaseGlobalDeviceState *s,
+      helium::ObserverMode mode = helium::ObserverMode::FINALIZE)
+      : helium::BaseObject(type, s), m_dependency(this, mode)
+  {}
+
+  bool isValid() const override
+  {
+    return true;
+  }
+
+  bool getProperty(const std::string_view &,
+      ANARIDataType,
+      void *,
+      uint64_t,
+      uint32_t) override
+  {
+    return false;
+  }
+
+  void commitParameters() override
+  {
+    m_dependency = getParamObject<helium::BaseObject>("dependency");
+    id = getParam<uint32_t>("id", 0u);
+  }
+
+  void finalize() override
+  {
+    auto *d = (const TestObject *)m_dependency.get();
+    seenDependencyValue = d ? d->value.load() : 0;
+    finalizeCount++;
+  }
+
+  uint32_t id{0};
+  std::atomic<int> value{0};
+  std::atomic<int> seenDependencyValue{0};
+  std::atomic<int> finalizeCount{0};
+  std::vector<helium::BaseObject *> dirtyDependencies;
+
+ private:
+  void on_DependencyDirty(helium::BaseObject *d, uint32_t flags) override
+  {
+    dirtyDependencies.push_back(d);
+    markDirty(flags);
+  }
+
+  helium::ChangeObserverPtr<helium::BaseObject> m_dependency;
+};
+
+} // namespace unit_test
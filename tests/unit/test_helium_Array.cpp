@@ -0,0 +1,202 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "catch.hpp"
+
+#include "helium/BaseGlobalDeviceState.h"
+#include "helium/array/Array1D.h"
+// std
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace {
+
+SCENARIO("helium::Array1D privatization", "[helium_Array]")
+{
+  GIVEN("A shared array with a region, still referenced internally")
+  {
+    helium::BaseGlobalDeviceState state(nullptr);
+
+    std::vector<float> appMemory(100);
+    std::iota(appMemory.begin(), appMemory.end(), 0.f);
+
+    helium::Array1DMemoryDescriptor md;
+    md.appMemory = appMemory.data();
+    md.elementType = ANARI_FLOAT32;
+    md.numItems = appMemory.size();
+
+    auto *array = new helium::Array1D(&state, md);
+    array->setParam("begin", size_t(10));
+    array->setParam("end", size_t(20));
+    array->commitParameters();
+    array->refInc(helium::RefType::INTERNAL);
+
+    WHEN("The application releases it")
+    {
+      array->refDec(helium::RefType::PUBLIC);
+
+      THEN("The region in use is copied out of application memory")
+      {
+        REQUIRE(array->wasPrivatized());
+        REQUIRE(array->data() != appMemory.data());
+        REQUIRE(array->size() == 10);
+        for (size_t i = 0; i < array->size(); i++)
+          REQUIRE(*array->valueAt<float>(i) == float(i + 10));
+      }
+
+      THEN("Elements outside of the region are zeroed")
+      {
+        const auto *all = (const float *)array->data();
+        REQUIRE(all[0] == 0.f);
+        REQUIRE(all[9] == 0.f);
+        REQUIRE(all[20] == 0.f);
+        REQUIRE(all[99] == 0.f);
+      }
+
+      AND_WHEN("The region is narrowed")
+      {
+        array->setParam("begin", size_t(12));
+        array->commitParameters();
+
+        THEN("The new region is used")
+        {
+          REQUIRE(array->size() == 8);
+          REQUIRE(*array->valueAt<float>(0) == 12.f);
+        }
+      }
+
+      AND_WHEN("The region is moved past the copied elements")
+      {
+        array->setParam("end", size_t(30));
+        array->commitParameters();
+
+        THEN("The region is left as it was")
+        {
+          REQUIRE(array->size() == 10);
+          REQUIRE(*array->valueAt<float>(0) == 10.f);
+        }
+      }
+    }
+
+    WHEN("The application releases it with privatization disabled")
+    {
+      state.sharedArrayPrivatization =
+          helium::SharedArrayPrivatization::NEVER;
+      array->refDec(helium::RefType::PUBLIC);
+
+      THEN("It keeps reading application memory")
+      {
+        REQUIRE(!array->wasPrivatized());
+        REQUIRE(array->data() == appMemory.data());
+      }
+    }
+
+    if (array->useCount(helium::RefType::PUBLIC) > 0)
+      array->refDec(helium::RefType::PUBLIC);
+    array->refDec(helium::RefType::INTERNAL);
+  }
+}
+
+SCENARIO("helium::Array1D region updates", "[helium_Array]")
+{
+  GIVEN("A committed managed array")
+  {
+    helium::BaseGlobalDeviceState state(nullptr);
+
+    helium::Array1DMemoryDescriptor md;
+    md.elementType = ANARI_FLOAT32;
+    md.numItems = 100;
+
+    auto *array = new helium::Array1D(&state, md);
+    array->commitParameters();
+    array->finalize();
+
+    const auto synced = helium::newTimeStamp();
+    using Range = std::pair<size_t, size_t>;
+
+    THEN("Nothing is modified since it was last synced")
+    {
+      REQUIRE(array->modifiedRangeSince(synced) == Range(0, 0));
+    }
+
+    WHEN("It is unmapped")
+    {
+      array->map();
+      array->unmap();
+
+      THEN("The whole array is modified")
+      {
+        REQUIRE(array->modifiedRangeSince(synced) == Range(0, 100));
+      }
+    }
+
+    WHEN("It is unmapped and committed with a modified region")
+    {
+      array->map();
+      array->unmap();
+      const uint64_t modified[2] = {40, 50};
+      array->setParam("modifiedRegion", ANARI_UINT64_REGION1, modified);
+      array->commitParameters();
+      array->finalize();
+
+      THEN("Only that region is modified since the last sync")
+      {
+        REQUIRE(array->modifiedRangeSince(synced) == Range(40, 50));
+        REQUIRE(array->modifiedRangeSince(0) == Range(0, 100));
+      }
+
+      THEN("The modified region is only used by that commit")
+      {
+        REQUIRE(!array->hasParam("modifiedRegion"));
+      }
+
+      AND_WHEN("The active region is set so it overlaps the modified region")
+      {
+        const auto resynced = helium::newTimeStamp();
+        const uint64_t region[2] = {45, 80};
+        array->setParam("region", ANARI_UINT64_REGION1, region);
+        array->commitParameters();
+        array->finalize();
+
+        THEN("The active region is used")
+        {
+          REQUIRE(array->size() == 35);
+        }
+
+        THEN("Changing the active region modifies the whole array")
+        {
+          REQUIRE(array->modifiedRangeSince(resynced) == Range(0, 35));
+        }
+
+        THEN("Modified ranges are relative to the active region")
+        {
+          REQUIRE(array->modifiedRangeSince(synced) == Range(0, 35));
+        }
+      }
+    }
+
+    WHEN("A region is marked modified without unmapping")
+    {
+      const uint64_t region[2] = {10, 30};
+      array->setParam("region", ANARI_UINT64_REGION1, region);
+      array->commitParameters();
+      array->finalize();
+      const auto resynced = helium::newTimeStamp();
+
+      const uint64_t modified[2] = {0, 15};
+      array->setParam("modifiedRegion", ANARI_UINT64_REGION1, modified);
+      array->commitParameters();
+      array->finalize();
+
+      THEN("The modified range is clipped to the active region")
+      {
+        REQUIRE(array->modifiedRangeSince(resynced) == Range(0, 5));
+      }
+    }
+
+    array->refDec(helium::RefType::PUBLIC);
+  }
+}
+
+} // namespace
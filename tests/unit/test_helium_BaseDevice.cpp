@@ -0,0 +1,283 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "catch.hpp"
+#include "helium/BaseDevice.h"
+#include "helium_TestObject.h"
+// anari
+#include "anari/ext/anari_batch.h"
+#include "anari/ext/anari_ext_interface.h"
+// std
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using unit_test::TestObject;
+
+// Device creating TestObjects for geometries and surfaces only, which either
+// implements anari_batch.h natively or leaves it to the frontend's fallback
+struct TestDevice : public helium::BaseDevice
+{
+  TestDevice(bool native)
+      : helium::BaseDevice(nullptr, nullptr), m_native(native)
+  {
+    m_state = std::make_unique<helium::BaseGlobalDeviceState>(this_device());
+  }
+
+  ~TestDevice() override
+  {
+    m_state->commitBuffer.clear();
+  }
+
+  helium::BaseGlobalDeviceState &state()
+  {
+    return *m_state;
+  }
+
+  void (*getProcAddress(const char *name))(void) override
+  {
+    return m_native ? helium::BaseDevice::getProcAddress(name) : nullptr;
+  }
+
+  ANARIArray1D newArray1D(const void *,
+      ANARIMemoryDeleter,
+      const void *,
+      ANARIDataType,
+      uint64_t) override
+  {
+    return nullptr;
+  }
+
+  ANARIArray2D newArray2D(const void *,
+      ANARIMemoryDeleter,
+      const void *,
+      ANARIDataType,
+      uint64_t,
+      uint64_t) override
+  {
+    return nullptr;
+  }
+
+  ANARIArray3D newArray3D(const void *,
+      ANARIMemoryDeleter,
+      const void *,
+      ANARIDataType,
+      uint64_t,
+      uint64_t,
+      uint64_t) override
+  {
+    return nullptr;
+  }
+
+  ANARIGeometry newGeometry(const char *) override
+  {
+    return (ANARIGeometry) new TestObject(ANARI_GEOMETRY, m_state.get());
+  }
+
+  ANARISurface newSurface() override
+  {
+    return (ANARISurface) new TestObject(ANARI_SURFACE, m_state.get());
+  }
+
+  ANARIMaterial newMaterial(const char *) override
+  {
+    return nullptr;
+  }
+  ANARISampler newSampler(const char *) override
+  {
+    return nullptr;
+  }
+  ANARISpatialField newSpatialField(const char *) override
+  {
+    return nullptr;
+  }
+  ANARIVolume newVolume(const char *) override
+  {
+    return nullptr;
+  }
+  ANARILight newLight(const char *) override
+  {
+    return nullptr;
+  }
+  ANARIGroup newGroup() override
+  {
+    return nullptr;
+  }
+  ANARIInstance newInstance(const char *) override
+  {
+    return nullptr;
+  }
+  ANARIWorld newWorld() override
+  {
+    return nullptr;
+  }
+  ANARICamera newCamera(const char *) override
+  {
+    return nullptr;
+  }
+  ANARIRenderer newRenderer(const char *) override
+  {
+    return nullptr;
+  }
+  ANARIFrame newFrame() override
+  {
+    return nullptr;
+  }
+
+  const char **getObjectSubtypes(ANARIDataType) override
+  {
+    return nullptr;
+  }
+
+  const void *getObjectInfo(
+      ANARIDataType, const char *, const char *, ANARIDataType) override
+  {
+    return nullptr;
+  }
+
+  const void *getParameterInfo(ANARIDataType,
+      const char *,
+      const char *,
+      ANARIDataType,
+      const char *,
+      ANARIDataType) override
+  {
+    return nullptr;
+  }
+
+ private:
+  bool m_native{true};
+};
+
+SCENARIO("helium::BaseDevice batched object calls", "[helium_BaseDevice]")
+{
+  for (bool native : {true, false}) {
+    GIVEN(std::string(native ? "A device implementing anari_batch.h natively"
+                             : "A device relying on the frontend's fallback"))
+    {
+      TestDevice device(native);
+      auto d = device.this_device();
+
+      REQUIRE((anariDeviceGetProcAddress(d, "anariNewObjects") != nullptr)
+          == native);
+
+      constexpr uint64_t NUM_OBJECTS = 100;
+      std::vector<ANARIObject> objects(NUM_OBJECTS, nullptr);
+
+      anariNewObjects(d, ANARI_GEOMETRY, "test", NUM_OBJECTS, objects.data());
+
+      auto object = [&](uint64_t i) -> TestObject & {
+        return *(TestObject *)objects[i];
+      };
+
+      THEN("Every object is created with the requested type")
+      {
+        for (uint64_t i = 0; i < NUM_OBJECTS; i++) {
+          REQUIRE(objects[i] != nullptr);
+          REQUIRE(object(i).type() == ANARI_GEOMETRY);
+        }
+      }
+
+      WHEN("A parameter is set from a strided array and committed")
+      {
+        struct Element
+        {
+          uint32_t id;
+          float unused;
+        };
+        std::vector<Element> elements(NUM_OBJECTS);
+        for (uint64_t i = 0; i < NUM_OBJECTS; i++)
+          elements[i].id = uint32_t(i) + 1;
+
+        anariSetParameterBatch(d,
+            objects.data(),
+            NUM_OBJECTS,
+            "id",
+            ANARI_UINT32,
+            &elements[0].id,
+            sizeof(Element));
+        anariCommitParametersBatch(d, objects.data(), NUM_OBJECTS);
+        device.state().commitBuffer.flush();
+
+        THEN("Each object sees its own value")
+        {
+          for (uint64_t i = 0; i < NUM_OBJECTS; i++) {
+            REQUIRE(object(i).id == i + 1);
+            REQUIRE(object(i).finalizeCount == 1);
+          }
+        }
+      }
+
+      WHEN("A parameter is set with a stride of 0")
+      {
+        const uint32_t id = 42;
+        anariSetParameterBatch(
+            d, objects.data(), NUM_OBJECTS, "id", ANARI_UINT32, &id, 0);
+        anariCommitParametersBatch(d, objects.data(), NUM_OBJECTS);
+        device.state().commitBuffer.flush();
+
+        THEN("Every object gets the same value")
+        {
+          for (uint64_t i = 0; i < NUM_OBJECTS; i++)
+            REQUIRE(object(i).id == id);
+        }
+      }
+
+      WHEN("A string parameter is set from an array of strings")
+      {
+        std::vector<std::string> names(NUM_OBJECTS);
+        std::vector<const char *> namePtrs(NUM_OBJECTS);
+        for (uint64_t i = 0; i < NUM_OBJECTS; i++) {
+          names[i] = "object" + std::to_string(i);
+          namePtrs[i] = names[i].c_str();
+        }
+
+        anariSetParameterBatch(d,
+            objects.data(),
+            NUM_OBJECTS,
+            "name",
+            ANARI_STRING,
+            namePtrs.data(),
+            sizeof(const char *));
+
+        THEN("Each object gets its own string")
+        {
+          for (uint64_t i = 0; i < NUM_OBJECTS; i++)
+            REQUIRE(object(i).getParamString("name", "") == names[i]);
+        }
+      }
+
+      WHEN("A single string is set with a stride of 0")
+      {
+        const char *name = "shared";
+        anariSetParameterBatch(
+            d, objects.data(), NUM_OBJECTS, "name", ANARI_STRING, &name, 0);
+
+        THEN("Every object gets the same string")
+        {
+          for (uint64_t i = 0; i < NUM_OBJECTS; i++)
+            REQUIRE(object(i).getParamString("name", "") == "shared");
+        }
+      }
+
+      WHEN("Objects of a type the device does not create are requested")
+      {
+        std::vector<ANARIObject> arrays(4, (ANARIObject)&device);
+        anariNewObjects(d, ANARI_ARRAY1D, nullptr, 4, arrays.data());
+
+        THEN("Null handles are returned")
+        {
+          for (auto a : arrays)
+            REQUIRE(a == nullptr);
+        }
+      }
+
+      for (auto o : objects)
+        anariRelease(d, o);
+    }
+  }
+}
+
+} // namespace
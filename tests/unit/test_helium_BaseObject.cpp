@@ -0,0 +1,99 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "catch.hpp"
+#include "helium_TestObject.h"
+// std
+#include <vector>
+
+namespace {
+
+constexpr uint32_t DIRTY_DATA = (1 << 0);
+constexpr uint32_t DIRTY_STRUCTURE = (1 << 1);
+
+using unit_test::TestObject;
+
+SCENARIO("helium::BaseObject dirty flag propagation", "[helium_BaseObject]")
+{
+  GIVEN("Two geometry -> surface -> group chains")
+  {
+    helium::BaseGlobalDeviceState state(nullptr);
+
+    std::vector<TestObject *> objects;
+    auto chain = [&]() {
+      // Each object observes its dependency for dirty flags only
+      constexpr auto mode = helium::ObserverMode::DIRTY_FLAGS;
+      auto *g = new TestObject(ANARI_GEOMETRY, &state, mode);
+      auto *s = new TestObject(ANARI_SURFACE, &state, mode);
+      auto *grp = new TestObject(ANARI_GROUP, &state, mode);
+      s->setParam("dependency", ANARI_OBJECT, &g);
+      grp->setParam("dependency", ANARI_OBJECT, &s);
+      for (auto *o : {g, s, grp}) {
+        o->commitParameters();
+        objects.push_back(o);
+      }
+      return std::vector<TestObject *>{g, s, grp};
+    };
+
+    auto a = chain();
+    auto b = chain();
+
+    WHEN("Flags are raised on one geometry")
+    {
+      a[0]->markDirty(DIRTY_DATA);
+
+      THEN("They reach every object observing it, directly or not")
+      {
+        REQUIRE(a[0]->dirtyFlags() == DIRTY_DATA);
+        REQUIRE(a[1]->dirtyFlags() == DIRTY_DATA);
+        REQUIRE(a[2]->dirtyFlags() == DIRTY_DATA);
+        REQUIRE(a[2]->dirtyDependencies
+            == std::vector<helium::BaseObject *>{a[1]});
+      }
+
+      THEN("Objects not depending on it are left alone")
+      {
+        for (auto *o : b) {
+          REQUIRE(o->dirtyFlags() == 0);
+          REQUIRE(o->dirtyDependencies.empty());
+        }
+      }
+
+      AND_WHEN("Flags are cleared on the group")
+      {
+        const auto cleared =
+            a[2]->clearDirtyFlags(DIRTY_DATA | DIRTY_STRUCTURE);
+
+        THEN("Only the flags which were set are returned")
+        {
+          REQUIRE(cleared == DIRTY_DATA);
+          REQUIRE(a[2]->dirtyFlags() == 0);
+        }
+
+        THEN("Raising them again reaches the group again")
+        {
+          a[0]->markDirty(DIRTY_DATA);
+          REQUIRE(a[2]->dirtyFlags() == DIRTY_DATA);
+        }
+      }
+    }
+
+    WHEN("The geometry notifies its change observers")
+    {
+      a[0]->notifyChangeObservers();
+      state.commitBuffer.flush();
+
+      THEN("Observers of dirty flags only are not finalized")
+      {
+        REQUIRE(a[1]->finalizeCount == 0);
+      }
+    }
+
+    for (auto it = objects.rbegin(); it != objects.rend(); ++it)
+      (*it)->removeAllParams();
+    for (auto *o : objects)
+      o->refDec(helium::RefType::PUBLIC);
+  }
+}
+
+} // namespace
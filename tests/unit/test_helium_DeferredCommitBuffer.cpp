@@ -0,0 +1,279 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "catch.hpp"
+#include "helium_TestObject.h"
+// std
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using unit_test::TestObject;
+
+SCENARIO("helium::DeferredCommitBuffer finalization",
+    "[helium_DeferredCommitBuffer]")
+{
+  for (uint32_t numThreads : {1u, 4u}) {
+    GIVEN("Geometries observed by surfaces using "
+        + std::to_string(numThreads) + " finalization thread(s)")
+    {
+      helium::BaseGlobalDeviceState state(nullptr);
+      state.commitBuffer.setNumFinalizationThreads(numThreads);
+
+      constexpr int NUM_OBJECTS = 500;
+
+      std::vector<TestObject *> geometries;
+      std::vector<TestObject *> surfaces;
+      for (int i = 0; i < NUM_OBJECTS; i++) {
+        auto *g = new TestObject(ANARI_GEOMETRY, &state);
+        auto *s = new TestObject(ANARI_SURFACE, &state);
+        s->setParam("dependency", ANARI_OBJECT, &g);
+        geometries.push_back(g);
+        surfaces.push_back(s);
+      }
+
+      // Queue surfaces first so priority ordering has to reorder them
+      for (auto &s : surfaces) {
+        s->markParameterChanged();
+        state.commitBuffer.addObjectToCommit(s);
+      }
+      for (auto &g : geometries) {
+        g->value = 1;
+        g->markParameterChanged();
+        state.commitBuffer.addObjectToCommit(g);
+      }
+
+      state.commitBuffer.flush();
+
+      THEN("Every object is finalized after what it depends on")
+      {
+        for (int i = 0; i < NUM_OBJECTS; i++) {
+          REQUIRE(geometries[i]->finalizeCount == 1);
+          REQUIRE(surfaces[i]->finalizeCount >= 1);
+          REQUIRE(surfaces[i]->seenDependencyValue == 1);
+        }
+      }
+
+      WHEN("Only the geometries change")
+      {
+        for (auto &g : geometries) {
+          g->value = 2;
+          g->markUpdated();
+          state.commitBuffer.addObjectToFinalize(g);
+        }
+
+        state.commitBuffer.flush();
+
+        THEN("Observing surfaces are finalized again with the new state")
+        {
+          for (int i = 0; i < NUM_OBJECTS; i++)
+            REQUIRE(surfaces[i]->seenDependencyValue == 2);
+        }
+      }
+
+      for (auto *s : surfaces)
+        s->refDec(helium::RefType::PUBLIC);
+      for (auto *g : geometries)
+        g->refDec(helium::RefType::PUBLIC);
+    }
+  }
+}
+
+SCENARIO("helium::commitPriority() puts arrays in a level of their own",
+    "[helium_DeferredCommitBuffer]")
+{
+  // Objects reading arrays in finalize() must never share a level with them
+  for (auto type : {ANARI_ARRAY, ANARI_ARRAY1D, ANARI_ARRAY2D, ANARI_ARRAY3D}) {
+    const int arrayPriority = helium::commitPriority(type);
+    REQUIRE(arrayPriority < helium::commitPriority(ANARI_GEOMETRY));
+    REQUIRE(arrayPriority < helium::commitPriority(ANARI_SAMPLER));
+    REQUIRE(arrayPriority < helium::commitPriority(ANARI_SPATIAL_FIELD));
+  }
+}
+
+SCENARIO("helium::DeferredCommitBuffer queues objects at most once",
+    "[helium_DeferredCommitBuffer]")
+{
+  GIVEN("An object added to the buffer many times")
+  {
+    helium::BaseGlobalDeviceState state(nullptr);
+    auto *obj = new TestObject(ANARI_GEOMETRY, &state);
+
+    obj->markParameterChanged();
+    for (int i = 0; i < 10; i++) {
+      state.commitBuffer.addObjectToCommit(obj);
+      state.commitBuffer.addObjectToFinalize(obj);
+    }
+
+    THEN("The buffer only holds a single reference to it")
+    {
+      REQUIRE(obj->useCount(helium::RefType::INTERNAL) == 1);
+    }
+
+    THEN("It is finalized once and released on flush")
+    {
+      state.commitBuffer.flush();
+      REQUIRE(obj->finalizeCount == 1);
+      REQUIRE(obj->useCount(helium::RefType::INTERNAL) == 0);
+
+      AND_WHEN("It is queued again after the flush as part of a batch")
+      {
+        obj->markParameterChanged();
+        helium::BaseObject *batch[] = {obj, obj, obj};
+        state.commitBuffer.addObjectsToCommit(batch, 3);
+        state.commitBuffer.flush();
+
+        THEN("It is finalized again")
+        {
+          REQUIRE(obj->finalizeCount == 2);
+        }
+      }
+    }
+
+    state.commitBuffer.clear();
+    obj->refDec(helium::RefType::PUBLIC);
+  }
+}
+
+SCENARIO("helium::DeferredCommitBuffer parameter staging",
+    "[helium_DeferredCommitBuffer]")
+{
+  GIVEN("A buffer staging parameter writes from several threads")
+  {
+    helium::BaseGlobalDeviceState state(nullptr);
+    state.commitBuffer.setParameterStaging(true);
+    auto &log = state.commitBuffer.stagedParameters();
+
+    constexpr int NUM_THREADS = 4;
+    constexpr int NUM_WRITES = 1000;
+
+    std::vector<TestObject *> objects;
+    for (int i = 0; i < NUM_THREADS; i++)
+      objects.push_back(new TestObject(ANARI_GEOMETRY, &state));
+
+    const helium::StringAtom valueAtom("value");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; t++) {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < NUM_WRITES; i++)
+          log.setParam(objects[t], valueAtom, ANARI_INT32, &i);
+        state.commitBuffer.addObjectToCommit(objects[t]);
+      });
+    }
+    for (auto &t : threads)
+      t.join();
+
+    THEN("Objects are untouched until the buffer is flushed")
+    {
+      REQUIRE(!log.empty());
+      for (auto *o : objects)
+        REQUIRE(!o->hasParam("value"));
+    }
+
+    THEN("Staged writes hold one reference per object, not one per write")
+    {
+      // The other reference is held by the commit buffer
+      for (auto *o : objects)
+        REQUIRE(o->useCount(helium::RefType::INTERNAL) == 2);
+    }
+
+    THEN("Flushing applies the last write to each object before committing")
+    {
+      state.commitBuffer.flush();
+      REQUIRE(log.empty());
+      for (auto *o : objects) {
+        REQUIRE(o->getParam<int>("value", -1) == NUM_WRITES - 1);
+        REQUIRE(o->lastCommitted() > o->lastParameterChanged());
+      }
+    }
+
+    WHEN("Writes remove parameters again")
+    {
+      log.removeParam(objects[0], valueAtom);
+      log.setParam(objects[1], valueAtom, ANARI_INT32, &NUM_WRITES);
+      log.removeAllParams(objects[1]);
+      state.commitBuffer.flush();
+
+      THEN("The parameters are gone after the flush")
+      {
+        REQUIRE(!objects[0]->hasParam("value"));
+        REQUIRE(!objects[1]->hasParam("value"));
+        REQUIRE(objects[2]->hasParam("value"));
+      }
+    }
+
+    WHEN("Writes are discarded")
+    {
+      log.clear();
+      state.commitBuffer.flush();
+
+      THEN("Nothing is applied")
+      {
+        REQUIRE(log.empty());
+        for (auto *o : objects)
+          REQUIRE(!o->hasParam("value"));
+      }
+    }
+
+    log.clear();
+    state.commitBuffer.clear();
+    for (auto *o : objects) {
+      REQUIRE(o->useCount(helium::RefType::INTERNAL) == 0);
+      o->refDec(helium::RefType::PUBLIC);
+    }
+  }
+}
+
+// Not run by default, use "[helium_DeferredCommitBuffer_benchmark]" to run it
+SCENARIO("helium::DeferredCommitBuffer animating 100k instance transforms",
+    "[.][helium_DeferredCommitBuffer_benchmark]")
+{
+  using clock = std::chrono::steady_clock;
+  constexpr int NUM_INSTANCES = 100000;
+  constexpr int NUM_FRAMES = 20;
+  // Applications commonly commit each instance more than once per frame
+  constexpr int COMMITS_PER_FRAME = 4;
+
+  helium::BaseGlobalDeviceState state(nullptr);
+
+  auto *world = new TestObject(ANARI_WORLD, &state);
+  std::vector<TestObject *> instances;
+  for (int i = 0; i < NUM_INSTANCES; i++)
+    instances.push_back(new TestObject(ANARI_INSTANCE, &state));
+
+  double enqueueMs = 0.0;
+  double flushMs = 0.0;
+
+  for (int f = 0; f < NUM_FRAMES; f++) {
+    auto start = clock::now();
+    for (int c = 0; c < COMMITS_PER_FRAME; c++) {
+      for (auto *inst : instances) {
+        inst->markParameterChanged();
+        state.commitBuffer.addObjectToCommit(inst);
+      }
+    }
+    world->markUpdated();
+    state.commitBuffer.addObjectToFinalize(world);
+    auto mid = clock::now();
+    state.commitBuffer.flush();
+    auto end = clock::now();
+
+    enqueueMs += std::chrono::duration<double, std::milli>(mid - start).count();
+    flushMs += std::chrono::duration<double, std::milli>(end - mid).count();
+  }
+
+  WARN("enqueue: " << enqueueMs / NUM_FRAMES << "ms/frame");
+  WARN("flush: " << flushMs / NUM_FRAMES << "ms/frame");
+
+  for (auto *inst : instances) {
+    REQUIRE(inst->finalizeCount == NUM_FRAMES);
+    inst->refDec(helium::RefType::PUBLIC);
+  }
+  world->refDec(helium::RefType::PUBLIC);
+}
+
+} // namespace
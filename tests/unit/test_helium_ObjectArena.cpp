@@ -0,0 +1,151 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "catch.hpp"
+#include "helium_TestObject.h"
+// std
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using unit_test::TestObject;
+
+struct LargerTestObject : public TestObject
+{
+  using TestObject::TestObject;
+  float data[64] = {};
+};
+
+struct alignas(128) AlignedTestObject : public TestObject
+{
+  using TestObject::TestObject;
+};
+
+SCENARIO("helium::ObjectArena allocation", "[helium_ObjectArena]")
+{
+  GIVEN("An arena")
+  {
+    helium::ObjectArena arena;
+
+    THEN("Freed blocks are reused by allocations of the same size")
+    {
+      void *a = arena.allocate(100);
+      void *b = arena.allocate(100);
+      REQUIRE(a != b);
+      REQUIRE(arena.numAllocations() == 2);
+
+      arena.deallocate(a, 100);
+      REQUIRE(arena.numAllocations() == 1);
+      REQUIRE(arena.allocate(100) == a);
+
+      const auto reserved = arena.bytesReserved();
+      void *c = arena.allocate(1000);
+      REQUIRE(arena.bytesReserved() > reserved);
+      REQUIRE(((uintptr_t)c % alignof(std::max_align_t)) == 0);
+    }
+  }
+}
+
+SCENARIO("helium::BaseObject allocation through the device state",
+    "[helium_ObjectArena]")
+{
+  GIVEN("A device state with an object arena")
+  {
+    helium::BaseGlobalDeviceState state(nullptr);
+    state.objectArena = std::make_unique<helium::ObjectArena>();
+    auto &arena = *state.objectArena;
+
+    WHEN("Objects of different types are created with 'new (state)'")
+    {
+      auto *a = new (&state) TestObject(ANARI_SURFACE, &state);
+      auto *b = new (&state) LargerTestObject(ANARI_SURFACE, &state);
+
+      THEN("Their memory comes from the arena")
+      {
+        REQUIRE(arena.numAllocations() == 2);
+        REQUIRE(arena.bytesReserved() > 0);
+      }
+
+      THEN("Releasing the objects returns their memory to the arena")
+      {
+        a->refDec(helium::RefType::PUBLIC);
+        b->refDec(helium::RefType::PUBLIC);
+        REQUIRE(arena.numAllocations() == 0);
+      }
+    }
+
+    WHEN("Over-aligned objects are created")
+    {
+      auto *a = new (&state) AlignedTestObject(ANARI_SURFACE, &state);
+      auto *b = new AlignedTestObject(ANARI_SURFACE, &state);
+
+      THEN("They are aligned as required, from the arena or not")
+      {
+        REQUIRE(((uintptr_t)a % alignof(AlignedTestObject)) == 0);
+        REQUIRE(((uintptr_t)b % alignof(AlignedTestObject)) == 0);
+        REQUIRE(arena.numAllocations() == 1);
+      }
+
+      a->refDec(helium::RefType::PUBLIC);
+      b->refDec(helium::RefType::PUBLIC);
+      REQUIRE(arena.numAllocations() == 0);
+    }
+
+    WHEN("An object is created with plain 'new'")
+    {
+      auto *a = new TestObject(ANARI_SURFACE, &state);
+
+      THEN("Its memory does not come from the arena")
+      {
+        REQUIRE(arena.numAllocations() == 0);
+        a->refDec(helium::RefType::PUBLIC);
+      }
+    }
+  }
+}
+
+// Not run by default, use "[helium_ObjectArena_benchmark]" to run it
+SCENARIO("helium::ObjectArena create/commit/release of 1M objects",
+    "[.][helium_ObjectArena_benchmark]")
+{
+  using clock = std::chrono::steady_clock;
+  constexpr uint32_t NUM_OBJECTS = 1000000;
+  constexpr int NUM_CYCLES = 3;
+
+  auto run = [&](bool useArena) {
+    helium::BaseGlobalDeviceState state(nullptr);
+    if (useArena)
+      state.objectArena = std::make_unique<helium::ObjectArena>();
+
+    std::vector<TestObject *> objects(NUM_OBJECTS);
+
+    for (int c = 0; c < NUM_CYCLES; c++) {
+      auto start = clock::now();
+
+      for (uint32_t i = 0; i < NUM_OBJECTS; i++) {
+        auto *o = new (&state) TestObject(ANARI_SURFACE, &state);
+        o->setParam("id", i);
+        o->markParameterChanged();
+        state.commitBuffer.addObjectToCommit(o);
+        objects[i] = o;
+      }
+
+      state.commitBuffer.flush();
+
+      for (auto *o : objects)
+        o->refDec(helium::RefType::PUBLIC);
+
+      auto ms = std::chrono::duration<double, std::milli>(clock::now() - start)
+                    .count();
+      WARN((useArena ? "arena" : "heap") << " cycle " << c << ": " << ms
+                                         << "ms");
+    }
+  };
+
+  run(false);
+  run(true);
+}
+
+} // namespace
@@ -32,6 +32,10 @@
 #include "catch.hpp"
 
 #include "helium/utility/ParameterizedObject.h"
+// std
+#include <chrono>
+#include <string>
+#include <vector>
 
 namespace {
 
@@ -119,6 +123,108 @@ SCENARIO(
       }
     }
   }
+
+  GIVEN("A ParameterizedObject with parameters set through atoms")
+  {
+    helium::ParameterizedObject obj;
+
+    const helium::StringAtom name("test_atom");
+
+    THEN("Atoms should be interned by value")
+    {
+      REQUIRE(name.valid());
+      REQUIRE(name.str() == "test_atom");
+      const std::string &asString = name;
+      REQUIRE(asString == "test_atom");
+      REQUIRE(helium::StringAtom("test_atom") == name);
+      REQUIRE(helium::StringAtom::find("test_atom") == name);
+      REQUIRE(!helium::StringAtom::find("test_atom_never_interned").valid());
+    }
+
+    obj.setParam(name, 7);
+
+    THEN("The parameter should be visible through both atoms and strings")
+    {
+      REQUIRE(obj.hasParam(name, ANARI_INT32));
+      REQUIRE(obj.hasParam("test_atom", ANARI_INT32));
+      REQUIRE(obj.getParam<int>(name, 4) == 7);
+      REQUIRE(obj.getParam<int>(std::string("test_atom"), 4) == 7);
+    }
+
+    WHEN("Many more parameters are added and some are removed")
+    {
+      for (int i = 0; i < 100; i++)
+        obj.setParam("param_" + std::to_string(i), i);
+      for (int i = 0; i < 100; i += 2)
+        obj.removeParam("param_" + std::to_string(i));
+
+      THEN("All remaining parameters should still be found")
+      {
+        REQUIRE(obj.getParam<int>(name, 4) == 7);
+        for (int i = 0; i < 100; i++) {
+          const auto n = "param_" + std::to_string(i);
+          REQUIRE(obj.hasParam(n) == (i % 2 == 1));
+          REQUIRE(obj.getParam<int>(n, -1) == (i % 2 == 1 ? i : -1));
+        }
+      }
+    }
+  }
+}
+
+// Not run by default, use "[helium_ParameterizedObject_benchmark]" to run it
+SCENARIO("helium::ParameterizedObject set + commit of 1M surfaces",
+    "[.][helium_ParameterizedObject_benchmark]")
+{
+  using clock = std::chrono::steady_clock;
+  constexpr size_t NUM_SURFACES = 1000000;
+
+  auto msSince = [](clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(clock::now() - start)
+        .count();
+  };
+
+  std::vector<helium::ParameterizedObject> surfaces(NUM_SURFACES);
+
+  const float color[4] = {1.f, 0.5f, 0.25f, 1.f};
+
+  auto start = clock::now();
+  for (size_t i = 0; i < NUM_SURFACES; i++) {
+    auto &s = surfaces[i];
+    s.setParam("id", uint32_t(i));
+    s.setParam("color", ANARI_FLOAT32_VEC4, color);
+    s.setParam("opacity", 1.f);
+    s.setParam("alphaMode", std::string("opaque"));
+  }
+  WARN("set: " << msSince(start) << "ms");
+
+  float sum = 0.f;
+
+  start = clock::now();
+  for (auto &s : surfaces) {
+    float c[4] = {};
+    s.getParam("color", ANARI_FLOAT32_VEC4, c);
+    sum += c[0] + s.getParam<float>("opacity", 0.f)
+        + float(s.getParam<uint32_t>("id", 0u) & 1)
+        + float(s.hasParam("alphaMode"));
+  }
+  WARN("commit (string_view names): " << msSince(start) << "ms");
+
+  const helium::StringAtom idAtom("id");
+  const helium::StringAtom colorAtom("color");
+  const helium::StringAtom opacityAtom("opacity");
+  const helium::StringAtom alphaModeAtom("alphaMode");
+
+  start = clock::now();
+  for (auto &s : surfaces) {
+    float c[4] = {};
+    s.getParam(colorAtom, ANARI_FLOAT32_VEC4, c);
+    sum += c[0] + s.getParam<float>(opacityAtom, 0.f)
+        + float(s.getParam<uint32_t>(idAtom, 0u) & 1)
+        + float(s.hasParam(alphaModeAtom));
+  }
+  WARN("commit (atoms): " << msSince(start) << "ms");
+
+  REQUIRE(sum > 0.f);
 }
 
 } // namespace
@@ -34,6 +34,13 @@
 #include "helium/BaseObject.h"
 #include "helium/utility/AnariAny.h"
 #include "helium/utility/IntrusivePtr.h"
+#include "helium/utility/ParameterizedObject.h"
+// std
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
 
 struct TestObject : public helium::RefCounted
 {
@@ -70,8 +77,10 @@ namespace {
 using helium::AnariAny;
 using helium::BaseObject;
 using helium::IntrusivePtr;
+using helium::ParameterizedObject;
 using helium::RefCounted;
 using helium::RefType;
+using helium::StringAtom;
 
 SCENARIO("helium::RefCounted interface", "[helium_RefCounted]")
 {
@@ -290,4 +299,154 @@ SCENARIO("helium::RefCounted interface", "[helium_RefCounted]")
   }
 }
 
+SCENARIO("helium::RefCounted references which are moved or borrowed",
+    "[helium_RefCounted]")
+{
+  GIVEN("A RefCounted object referenced by an IntrusivePtr")
+  {
+    bool destroyed = false;
+    auto *obj = new TestObject(destroyed);
+    IntrusivePtr<TestObject> ptr = obj;
+
+    WHEN("The IntrusivePtr is moved into another one")
+    {
+      IntrusivePtr<RefCounted> moved = std::move(ptr);
+
+      THEN("The reference is transferred without changing the ref count")
+      {
+        REQUIRE(!ptr);
+        REQUIRE(moved.get() == obj);
+        REQUIRE(obj->useCount(RefType::INTERNAL) == 1);
+      }
+    }
+
+    WHEN("The IntrusivePtr is move assigned to itself")
+    {
+      auto &self = ptr;
+      ptr = std::move(self);
+
+      THEN("The reference is kept")
+      {
+        REQUIRE(ptr.get() == obj);
+        REQUIRE(obj->useCount(RefType::INTERNAL) == 1);
+      }
+    }
+
+    ptr = nullptr;
+    obj->refDec(RefType::PUBLIC);
+    REQUIRE(destroyed);
+  }
+
+  GIVEN("A RefCounted object set as a parameter")
+  {
+    bool destroyed = false;
+    auto *obj = new TestObject(destroyed);
+
+    ParameterizedObject src;
+    src.setParam("obj", ANARI_OBJECT, &obj);
+    REQUIRE(obj->useCount(RefType::INTERNAL) == 1);
+
+    WHEN("The parameter is borrowed")
+    {
+      const auto &value = src.borrowParamDirect("obj");
+
+      THEN("The ref count is unchanged")
+      {
+        REQUIRE(value.getObject<TestObject>() == obj);
+        REQUIRE(obj->useCount(RefType::INTERNAL) == 1);
+      }
+    }
+
+    WHEN("A missing parameter is borrowed")
+    {
+      THEN("An empty value is returned")
+      {
+        REQUIRE(!src.borrowParamDirect("missing").valid());
+      }
+    }
+
+    WHEN("The parameter value is moved to another object")
+    {
+      ParameterizedObject dst;
+      AnariAny value = src.getParamDirect("obj");
+      REQUIRE(obj->useCount(RefType::INTERNAL) == 2);
+
+      REQUIRE(dst.setParamDirect("obj", std::move(value)));
+
+      THEN("Only the copy out of the source took a reference")
+      {
+        REQUIRE(!value.valid());
+        REQUIRE(obj->useCount(RefType::INTERNAL) == 2);
+        REQUIRE(dst.getParamObject<TestObject>("obj") == obj);
+      }
+
+      THEN("Setting the same borrowed value again changes nothing")
+      {
+        REQUIRE(!dst.setParamDirect("obj", src.borrowParamDirect("obj")));
+        REQUIRE(obj->useCount(RefType::INTERNAL) == 2);
+      }
+    }
+
+    src.removeAllParams();
+    obj->refDec(RefType::PUBLIC);
+    REQUIRE(destroyed);
+  }
+}
+
+// Not run by default, use "[helium_RefCounted_benchmark]" to run it
+SCENARIO("helium::RefCounted contention from threads sharing an object",
+    "[.][helium_RefCounted_benchmark]")
+{
+  using clock = std::chrono::steady_clock;
+  constexpr int NUM_ITERATIONS = 2000000;
+  const int numThreads =
+      std::clamp(int(std::thread::hardware_concurrency()), 2, 8);
+
+  bool destroyed = false;
+  auto *obj = new TestObject(destroyed);
+
+  // Each thread forwards a parameter holding the shared object from one of
+  // its own objects to another, the way World::finalize() forwards its
+  // surfaces to the zero instance group
+  auto run = [&](const char *name, auto &&forward) {
+    std::vector<std::thread> threads;
+    auto start = clock::now();
+
+    for (int t = 0; t < numThreads; t++) {
+      threads.emplace_back([&]() {
+        const StringAtom param("obj");
+        ParameterizedObject src;
+        ParameterizedObject dst;
+        src.setParam(param, ANARI_OBJECT, &obj);
+        dst.setParam(param, ANARI_OBJECT, &obj);
+        for (int i = 0; i < NUM_ITERATIONS; i++)
+          forward(src, dst, param);
+      });
+    }
+
+    for (auto &t : threads)
+      t.join();
+
+    auto ms =
+        std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    WARN(name << " (" << numThreads << " threads): " << ms << "ms");
+  };
+
+  run("copied", [](auto &src, auto &dst, StringAtom param) {
+    AnariAny value = src.getParamDirect(param);
+    dst.setParamDirect(param, value);
+  });
+
+  run("moved", [](auto &src, auto &dst, StringAtom param) {
+    dst.setParamDirect(param, src.getParamDirect(param));
+  });
+
+  run("borrowed", [](auto &src, auto &dst, StringAtom param) {
+    dst.setParamDirect(param, src.borrowParamDirect(param));
+  });
+
+  REQUIRE(obj->useCount(RefType::INTERNAL) == 0);
+  obj->refDec(RefType::PUBLIC);
+}
+
 } // namespace
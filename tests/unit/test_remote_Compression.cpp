@@ -0,0 +1,135 @@
+// Copyright 2021-2025 The Khronos Group
+// SPDX-License-Identifier: Apache-2.0
+
+#include "catch.hpp"
+
+#include "Compression.h"
+// std
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Depth image with smooth surfaces, background at infinity, some noise, and
+// values which are special for the codec (NaN, -0, denormals, negatives)
+std::vector<float> makeDepthImage(uint32_t width, uint32_t height)
+{
+  std::mt19937 rng(width * 31 + height);
+  std::uniform_real_distribution<float> noise(-1.f, 1.f);
+
+  std::vector<float> depth(size_t(width) * height);
+  for (uint32_t y = 0; y < height; y++) {
+    for (uint32_t x = 0; x < width; x++) {
+      float &d = depth[size_t(y) * width + x];
+      if ((x / 7 + y / 5) % 4 == 0)
+        d = std::numeric_limits<float>::infinity();
+      else if ((x + y) % 11 == 0)
+        d = 100.f * std::abs(noise(rng));
+      else
+        d = 2.f + 0.01f * x + 0.02f * y;
+    }
+  }
+
+  const float special[] = {std::numeric_limits<float>::quiet_NaN(),
+      -std::numeric_limits<float>::infinity(),
+      -0.f,
+      std::numeric_limits<float>::denorm_min(),
+      -3.5f,
+      std::numeric_limits<float>::max()};
+  for (size_t i = 0; i < std::size(special) && i < depth.size(); i++)
+    depth[(i * 13) % depth.size()] = special[i];
+
+  return depth;
+}
+
+bool roundTrip(const std::vector<float> &in,
+    std::vector<float> &out,
+    remote::FloatDepthOptions options)
+{
+  std::vector<uint8_t> compressed(
+      remote::getMaxCompressedBufferSizeFloatDepth(options));
+  size_t compressedSize = 0;
+  if (!remote::compressFloatDepth(
+          in.data(), compressed.data(), compressedSize, options))
+    return false;
+  REQUIRE(compressedSize <= compressed.size());
+
+  out.assign(in.size(), 0.f);
+  return remote::uncompressFloatDepth(
+      compressed.data(), out.data(), compressedSize, options);
+}
+
+uint32_t bitsOf(float f)
+{
+  uint32_t b;
+  std::memcpy(&b, &f, sizeof(b));
+  return b;
+}
+
+SCENARIO("remote float depth codec round trip", "[remote_Compression]")
+{
+  const std::pair<uint32_t, uint32_t> sizes[] = {
+      {1, 1}, {1, 100}, {100, 1}, {2, 3}, {64, 64}, {123, 45}};
+
+  for (auto [width, height] : sizes) {
+    GIVEN("A " + std::to_string(width) + "x" + std::to_string(height)
+        + " depth image")
+    {
+      const auto depth = makeDepthImage(width, height);
+      std::vector<float> result;
+
+      remote::FloatDepthOptions options;
+      options.width = width;
+      options.height = height;
+
+      THEN("It is restored bit by bit without quantization")
+      {
+        REQUIRE(roundTrip(depth, result, options));
+        for (size_t i = 0; i < depth.size(); i++)
+          REQUIRE(bitsOf(result[i]) == bitsOf(depth[i]));
+      }
+
+      for (uint32_t precisionBits : {0u, 8u, 16u, 22u}) {
+        THEN("Finite values stay within 2^-" + std::to_string(precisionBits)
+            + " relative error, inf and NaN are kept")
+        {
+          options.precisionBits = precisionBits;
+          REQUIRE(roundTrip(depth, result, options));
+
+          const double bound = std::ldexp(1.0, -int(precisionBits));
+          for (size_t i = 0; i < depth.size(); i++) {
+            const float d = depth[i];
+            if (std::isnan(d))
+              REQUIRE(bitsOf(result[i]) == bitsOf(d));
+            else if (std::isinf(d))
+              REQUIRE(result[i] == d);
+            else if (std::isnormal(d)) {
+              REQUIRE(std::isfinite(result[i]));
+              REQUIRE(std::abs(double(result[i]) - d) <= std::abs(d) * bound);
+            }
+          }
+        }
+      }
+
+      THEN("Truncated input is rejected")
+      {
+        std::vector<uint8_t> compressed(
+            remote::getMaxCompressedBufferSizeFloatDepth(options));
+        size_t compressedSize = 0;
+        REQUIRE(remote::compressFloatDepth(
+            depth.data(), compressed.data(), compressedSize, options));
+        result.resize(depth.size());
+        REQUIRE(!remote::uncompressFloatDepth(
+            compressed.data(), result.data(), compressedSize - 1, options));
+      }
+    }
+  }
+}
+
+} // namespace